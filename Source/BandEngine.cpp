@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    BandEngine.cpp
+    Implements the N-band engine.
+
+  ==============================================================================
+*/
+
+#include "BandEngine.h"
+
+//==============================================================================
+template <typename SampleType>
+int designBandSections(const BandSettings& settings, double sampleRate, BiquadSection<SampleType>* sections)
+{
+    using T = SampleType;
+
+    if (! settings.enabled)
+        return 0;
+
+    // Keep every band below Nyquist, as the parameter ranges do at 44.1 kHz
+    const auto frequency = static_cast<T>(juce::jlimit(2.0, 0.49 * sampleRate, static_cast<double>(settings.frequency)));
+    const auto quality = static_cast<T>(settings.quality);
+    const auto gain = static_cast<T>(settings.gainInDecibels);
+    const auto order = juce::jlimit(1, 2 * maxSectionsPerEngineBand, settings.order);
+
+    switch (settings.type)
+    {
+        case BandType::lowShelf:  sections[0] = designLowShelfSection(sampleRate, frequency, quality, gain);  return 1;
+        case BandType::highShelf: sections[0] = designHighShelfSection(sampleRate, frequency, quality, gain); return 1;
+        case BandType::notch:     sections[0] = designNotchSection(sampleRate, frequency, quality);          return 1;
+        case BandType::lowCut:    return designButterworthHighPass(sampleRate, frequency, order, sections);
+        case BandType::highCut:   return designButterworthLowPass(sampleRate, frequency, order, sections);
+        case BandType::peak:
+        default:                  sections[0] = designPeakSection(sampleRate, frequency, quality, gain);      return 1;
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void BandEngine<SampleType>::prepare(double newSampleRate, int numChannels, int maxBlockSize, KernelIsa isa,
+                                     KernelIsa blockedIsa)
+{
+    sampleRate = newSampleRate;
+    cascade.prepare(numChannels, maxBlockSize, maxBands * maxSectionsPerBand, isa, blockedIsa);
+
+    for (int index = 0; index < maxBands; ++index)
+        applyBand(index);
+}
+
+template <typename SampleType>
+void BandEngine<SampleType>::reset()
+{
+    cascade.reset();
+}
+
+template <typename SampleType>
+void BandEngine<SampleType>::setSampleRate(double newSampleRate)
+{
+    if (newSampleRate == sampleRate)
+        return;
+
+    sampleRate = newSampleRate;
+
+    for (int index = 0; index < maxBands; ++index)
+        if (bands[static_cast<size_t>(index)].enabled)
+            applyBand(index);
+}
+
+//==============================================================================
+template <typename SampleType>
+void BandEngine<SampleType>::setBand(int index, const BandSettings& settings)
+{
+    jassert(juce::isPositiveAndBelow(index, maxBands));
+
+    auto& band = bands[static_cast<size_t>(index)];
+
+    if (settings == band)
+        return;
+
+    numEnabledBands += (settings.enabled ? 1 : 0) - (band.enabled ? 1 : 0);
+    band = settings;
+
+    // Designed once prepared, at the sample rate given there
+    if (sampleRate > 0.0)
+        applyBand(index);
+}
+
+template <typename SampleType>
+void BandEngine<SampleType>::applyBand(int index)
+{
+    const auto firstSlot = index * maxSectionsPerBand;
+
+    std::array<BiquadSection<SampleType>, maxSectionsPerBand> sections;
+    const auto numSections = designBandSections(bands[static_cast<size_t>(index)], sampleRate, sections.data());
+
+    for (int i = 0; i < maxSectionsPerBand; ++i)
+    {
+        if (i < numSections)
+            cascade.setSlot(firstSlot + i, sections[static_cast<size_t>(i)]);
+
+        cascade.setSlotActive(firstSlot + i, i < numSections);
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void BandEngine<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    cascade.process(block);
+}
+
+//==============================================================================
+template int designBandSections<float>(const BandSettings&, double, BiquadSection<float>*);
+template int designBandSections<double>(const BandSettings&, double, BiquadSection<double>*);
+
+template class BandEngine<float>;
+template class BandEngine<double>;
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    BandEngine.h
+    Runtime-configurable parametric EQ of up to maxBands bands, each a
+    peak, shelf, notch or Butterworth cut. Every band owns a fixed range of
+    maxSectionsPerBand slots in a BiquadCascade, so the coefficients and
+    per-channel state of all bands live in its cache-line aligned
+    structure-of-arrays storage. Only the sections of enabled bands are
+    processed, so the cost grows linearly with the active band count.
+    Instantiated for float and double.
+
+    The processor runs one after the three main bands, driven by the
+    "Band N" parameters.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+#include "CoefficientDesign.h"
+
+//==============================================================================
+enum class BandType
+{
+    peak,
+    lowShelf,
+    highShelf,
+    notch,
+    lowCut,
+    highCut
+};
+
+// Gain is ignored by notches and cuts, quality by cuts, order by all but
+// the cuts
+struct BandSettings
+{
+    BandType type{ BandType::peak };
+    float frequency{ 1000.f }, gainInDecibels{ 0.f }, quality{ 1.f };
+    int order{ 2 };
+    bool enabled{ false };
+
+    bool operator==(const BandSettings& other) const
+    {
+        return type == other.type && frequency == other.frequency && gainInDecibels == other.gainInDecibels
+            && quality == other.quality && order == other.order && enabled == other.enabled;
+    }
+
+    bool operator!=(const BandSettings& other) const { return ! operator==(other); }
+};
+
+//==============================================================================
+// The band layout every engine shares
+constexpr int maxEngineBands = 24;
+constexpr int maxSectionsPerEngineBand = 4;
+
+using BandSettingsArray = std::array<BandSettings, maxEngineBands>;
+
+// Designs an enabled band's sections, at most maxSectionsPerEngineBand of
+// them, and returns how many it wrote. Disabled bands write none.
+// Allocation free.
+template <typename SampleType>
+int designBandSections(const BandSettings& settings, double sampleRate, BiquadSection<SampleType>* sections);
+
+//==============================================================================
+template <typename SampleType>
+class BandEngine
+{
+public:
+    //==============================================================================
+    static constexpr int maxBands = maxEngineBands;
+    static constexpr int maxSectionsPerBand = maxSectionsPerEngineBand;
+    static constexpr int maxCutOrder = 2 * maxSectionsPerBand;
+
+    // Allocates the cascade and designs every band set so far. Must not be
+    // called on the audio thread.
+    void prepare(double sampleRate, int numChannels, int maxBlockSize, KernelIsa isa,
+                 KernelIsa blockedIsa = KernelIsa::scalar);
+    void reset();
+
+    // Redesigns every enabled band for the new rate. Allocation free.
+    void setSampleRate(double newSampleRate);
+
+    // As BiquadCascade::setTimeBlocked
+    void setTimeBlocked(bool shouldBeTimeBlocked) { cascade.setTimeBlocked(shouldBeTimeBlocked); }
+
+    //==============================================================================
+    // Redesigns the band if its settings changed. Allocation free, so safe
+    // to call at control rate on the audio thread.
+    void setBand(int index, const BandSettings& settings);
+    const BandSettings& getBand(int index) const { return bands[static_cast<size_t>(index)]; }
+
+    int getNumEnabledBands() const noexcept { return numEnabledBands; }
+
+    //==============================================================================
+    // Processes the first numChannels channels of the block in place
+    void process(const juce::dsp::AudioBlock<SampleType>& block);
+
+private:
+    //==============================================================================
+    void applyBand(int index);
+
+    BiquadCascade<SampleType> cascade;
+    BandSettingsArray bands;
+
+    double sampleRate = 0.0;
+    int numEnabledBands = 0;
+
+    JUCE_LEAK_DETECTOR(BandEngine)
+};
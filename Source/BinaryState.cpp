@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    BinaryState.cpp
+    Implements the binary state format.
+
+  ==============================================================================
+*/
+
+#include "BinaryState.h"
+
+namespace
+{
+    constexpr juce::uint32 stateMagic = 'O' | ('L' << 8) | ('E' << 16) | ('Q' << 24);
+
+    void writeUint32(juce::uint8* destination, juce::uint32 value)
+    {
+        value = juce::ByteOrder::swapIfBigEndian(value);
+        std::memcpy(destination, &value, sizeof(value));
+    }
+
+    void writeUint16(juce::uint8* destination, juce::uint16 value)
+    {
+        value = juce::ByteOrder::swapIfBigEndian(value);
+        std::memcpy(destination, &value, sizeof(value));
+    }
+}
+
+//==============================================================================
+juce::uint32 hashBytes(const void* data, size_t numBytes)
+{
+    auto h = 0x811c9dc5u;
+
+    for (size_t i = 0; i < numBytes; ++i)
+        h = (h ^ static_cast<const juce::uint8*>(data)[i]) * 0x01000193u;
+
+    return h;
+}
+
+//==============================================================================
+BinaryStateLayout::BinaryStateLayout(juce::AudioProcessor& processor)
+{
+    for (auto* parameter : processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            const auto id = ranged->getParameterID().toStdString();
+            const auto hash = hashBytes(id.data(), id.size());
+
+            // Two IDs with the same hash could not be told apart
+            jassert(std::find(hashes.begin(), hashes.end(), hash) == hashes.end());
+
+            parameters.push_back(ranged);
+            hashes.push_back(hash);
+        }
+    }
+
+    jassert(parameters.size() <= std::numeric_limits<juce::uint16>::max());
+}
+
+void BinaryStateLayout::write(juce::MemoryBlock& destData) const
+{
+    const auto numEntries = parameters.size();
+
+    destData.setSize(headerSize + numEntries * entrySize);
+    auto* bytes = static_cast<juce::uint8*>(destData.getData());
+    auto* entries = bytes + headerSize;
+
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        const auto* parameter = parameters[i];
+        const auto value = parameter->convertFrom0to1(parameter->getValue());
+
+        juce::uint32 valueBits;
+        std::memcpy(&valueBits, &value, sizeof(valueBits));
+
+        writeUint32(entries + i * entrySize, hashes[i]);
+        writeUint32(entries + i * entrySize + 4, valueBits);
+    }
+
+    writeUint32(bytes, stateMagic);
+    writeUint16(bytes + 4, static_cast<juce::uint16>(formatVersion));
+    writeUint16(bytes + 6, static_cast<juce::uint16>(numEntries));
+    writeUint32(bytes + 8, hashBytes(entries, numEntries * entrySize));
+}
+
+bool BinaryStateLayout::read(const void* data, int sizeInBytes) const
+{
+    if (! isBinaryState(data, sizeInBytes))
+        return false;
+
+    const auto* bytes = static_cast<const juce::uint8*>(data);
+    const auto* entries = bytes + headerSize;
+    const auto version = juce::ByteOrder::littleEndianShort(bytes + 4);
+    const auto numEntries = static_cast<int>(juce::ByteOrder::littleEndianShort(bytes + 6));
+
+    if (version == 0 || version > formatVersion || sizeInBytes != headerSize + numEntries * entrySize)
+        return false;
+
+    if (hashBytes(entries, static_cast<size_t>(numEntries * entrySize)) != juce::ByteOrder::littleEndianInt(bytes + 8))
+        return false;
+
+    // Only values that actually change are set, so a restore of the same
+    // state does not flood the host with parameter changes
+    auto setValue = [](juce::RangedAudioParameter& parameter, float normalisedValue)
+    {
+        if (parameter.getValue() != normalisedValue)
+            parameter.setValueNotifyingHost(normalisedValue);
+    };
+
+    std::vector<bool> restored(parameters.size(), false);
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        const auto index = findParameter(juce::ByteOrder::littleEndianInt(entries + i * entrySize), i);
+
+        if (index < 0)
+            continue;
+
+        const auto valueBits = juce::ByteOrder::littleEndianInt(entries + i * entrySize + 4);
+        float value;
+        std::memcpy(&value, &valueBits, sizeof(value));
+
+        auto& parameter = *parameters[static_cast<size_t>(index)];
+        setValue(parameter, parameter.convertTo0to1(value));
+        restored[static_cast<size_t>(index)] = true;
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+        if (! restored[i])
+            setValue(*parameters[i], parameters[i]->getDefaultValue());
+
+    return true;
+}
+
+bool BinaryStateLayout::isBinaryState(const void* data, int sizeInBytes)
+{
+    return data != nullptr && sizeInBytes >= headerSize && juce::ByteOrder::littleEndianInt(data) == stateMagic;
+}
+
+int BinaryStateLayout::findParameter(juce::uint32 hash, int expectedIndex) const
+{
+    const auto numParameters = static_cast<int>(hashes.size());
+
+    if (expectedIndex < numParameters && hashes[static_cast<size_t>(expectedIndex)] == hash)
+        return expectedIndex;
+
+    for (int i = 0; i < numParameters; ++i)
+        if (hashes[static_cast<size_t>(i)] == hash)
+            return i;
+
+    return -1;
+}
@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    BinaryState.h
+    Compact binary plugin state. Parsing the parameter ValueTree back costs
+    string compares and tree allocations for every parameter, which adds up
+    when a session restores hundreds of instances. The binary state is a
+    fixed 12 byte header followed by one 8 byte entry per parameter:
+
+        uint32  magic ("OLEQ")
+        uint16  format version
+        uint16  number of entries
+        uint32  checksum of the entries (FNV-1a)
+        entries: uint32 hash of the parameter ID, float32 plain value
+
+    Everything is little endian. Entries are written in parameter order, so
+    a restore by the same build matches each one on the first compare, and
+    the ID hashes let builds that add or drop parameters still read it.
+    Parameters without an entry go back to their defaults, as they do when
+    replacing a ValueTree state.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// FNV-1a, used for the checksums and parameter ID hashes
+juce::uint32 hashBytes(const void* data, size_t numBytes);
+
+//==============================================================================
+class BinaryStateLayout
+{
+public:
+    //==============================================================================
+    static constexpr int formatVersion = 1;
+
+    // Collects the processor's parameters, which must all have been added
+    explicit BinaryStateLayout(juce::AudioProcessor& processor);
+
+    void write(juce::MemoryBlock& destData) const;
+
+    // Returns false without touching the parameters if the data is not a
+    // binary state of a known version or fails its checksum. Not for the
+    // audio thread.
+    bool read(const void* data, int sizeInBytes) const;
+
+    // True for anything that starts like a binary state, so that a damaged
+    // one is rejected rather than parsed as a ValueTree
+    static bool isBinaryState(const void* data, int sizeInBytes);
+
+private:
+    //==============================================================================
+    static constexpr int headerSize = 12;
+    static constexpr int entrySize = 8;
+
+    int findParameter(juce::uint32 hash, int expectedIndex) const;
+
+    std::vector<juce::RangedAudioParameter*> parameters;
+    std::vector<juce::uint32> hashes;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BinaryStateLayout)
+};
@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.cpp
+    Implements the lane-interleaved biquad cascade.
+
+  ==============================================================================
+*/
+
+#include "BiquadCascade.h"
+
+//==============================================================================
+template <typename SampleType>
+void BiquadCascade<SampleType>::prepare(int newNumChannels, int newMaxBlockSize, int newNumSlots, KernelIsa isa,
+                                        KernelIsa blockedIsa)
+{
+    kernels = &getFilterKernels<SampleType>(isa);
+    blockedKernels = &getFilterKernels<SampleType>(blockedIsa);
+
+    numChannels  = newNumChannels;
+    maxBlockSize = newMaxBlockSize;
+    numSlots     = newNumSlots;
+
+    // Pad to a whole number of vectors, padding lanes run identity sections
+    // on silence so they never need masking
+    const auto width = kernels->laneWidth;
+    numLanes = ((numChannels + width - 1) / width) * width;
+
+    coefficients = allocateAligned(coefficientStorage, static_cast<size_t>(numSlots * 5 * numLanes));
+    state = allocateAligned(stateStorage, static_cast<size_t>(numSlots * 2 * numLanes));
+    interleaved = allocateAligned(interleavedStorage, static_cast<size_t>(maxBlockSize * numLanes));
+
+    blockMatrixSize = getBlockMatrixSize(blockedKernels->laneWidth);
+    blockMatrices = allocateAligned(blockMatrixStorage, static_cast<size_t>(numChannels * numSlots * blockMatrixSize));
+
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        juce::FloatVectorOperations::fill(coefficients + slot * 5 * numLanes, SampleType(1), numLanes);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            designBlockMatrices(slot, channel);
+    }
+
+    active.assign(static_cast<size_t>(numSlots), false);
+    activeSlots.assign(static_cast<size_t>(numSlots), 0);
+    numActiveSlots = 0;
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::reset()
+{
+    juce::FloatVectorOperations::clear(state, numSlots * 2 * numLanes);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::copyFrom(const BiquadCascade& other)
+{
+    jassert(other.numChannels == numChannels && other.numLanes == numLanes && other.numSlots == numSlots);
+    jassert(other.blockMatrixSize == blockMatrixSize);
+
+    juce::FloatVectorOperations::copy(coefficients, other.coefficients, numSlots * 5 * numLanes);
+    juce::FloatVectorOperations::copy(state, other.state, numSlots * 2 * numLanes);
+
+    // The matrices are only current while time blocked
+    timeBlocked = other.timeBlocked;
+
+    if (timeBlocked)
+        juce::FloatVectorOperations::copy(blockMatrices, other.blockMatrices, numChannels * numSlots * blockMatrixSize);
+
+    std::copy(other.active.begin(), other.active.end(), active.begin());
+    std::copy(other.activeSlots.begin(), other.activeSlots.end(), activeSlots.begin());
+    numActiveSlots = other.numActiveSlots;
+}
+
+template <typename SampleType>
+SampleType* BiquadCascade<SampleType>::allocateAligned(juce::HeapBlock<SampleType>& storage, size_t numElements)
+{
+    // Over-allocate by a cache line and start at the first boundary in it
+    constexpr auto padding = cacheLineSize / sizeof(SampleType);
+    storage.calloc(numElements + padding);
+
+    const auto address = reinterpret_cast<std::uintptr_t>(storage.get());
+    const auto offset = (cacheLineSize - address % cacheLineSize) % cacheLineSize;
+    return storage + offset / sizeof(SampleType);
+}
+
+//==============================================================================
+template <typename SampleType>
+void BiquadCascade<SampleType>::setSlot(int slot, const BiquadSection<SampleType>& section)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        setSlot(slot, channel, section);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setSlot(int slot, int channel, const BiquadSection<SampleType>& section)
+{
+    jassert(juce::isPositiveAndBelow(slot, numSlots));
+    jassert(juce::isPositiveAndBelow(channel, numChannels));
+
+    auto* c = coefficients + slot * 5 * numLanes + channel;
+
+    c[0]            = section.b0;
+    c[numLanes]     = section.b1;
+    c[2 * numLanes] = section.b2;
+    c[3 * numLanes] = section.a1;
+    c[4 * numLanes] = section.a2;
+
+    if (timeBlocked)
+        designBlockMatrices(slot, channel);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::designBlockMatrices(int slot, int channel)
+{
+    const auto* c = coefficients + slot * 5 * numLanes + channel;
+    const BiquadSection<SampleType> section{ c[0], c[numLanes], c[2 * numLanes], c[3 * numLanes], c[4 * numLanes] };
+
+    ::designBlockMatrices(section, blockedKernels->laneWidth,
+                          blockMatrices + (channel * numSlots + slot) * blockMatrixSize);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setTimeBlocked(bool shouldBeTimeBlocked)
+{
+    if (shouldBeTimeBlocked == timeBlocked)
+        return;
+
+    timeBlocked = shouldBeTimeBlocked;
+
+    // The matrices went stale while the interleaved kernel ran
+    if (timeBlocked)
+        for (int slot = 0; slot < numSlots; ++slot)
+            for (int channel = 0; channel < numChannels; ++channel)
+                designBlockMatrices(slot, channel);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setSlotActive(int slot, bool shouldBeActive)
+{
+    jassert(juce::isPositiveAndBelow(slot, numSlots));
+
+    if (active[static_cast<size_t>(slot)] != shouldBeActive)
+    {
+        active[static_cast<size_t>(slot)] = shouldBeActive;
+        rebuildActiveSlots();
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::rebuildActiveSlots()
+{
+    numActiveSlots = 0;
+
+    for (int slot = 0; slot < numSlots; ++slot)
+        if (active[static_cast<size_t>(slot)])
+            activeSlots[static_cast<size_t>(numActiveSlots++)] = slot;
+}
+
+//==============================================================================
+template <typename SampleType>
+void BiquadCascade<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    process(block, 0, numChannels);
+}
+
+template <typename SampleType>
+int BiquadCascade<SampleType>::getChannelGroupAlignment() const noexcept
+{
+    return juce::jmax(kernels->laneWidth, static_cast<int>(cacheLineSize / sizeof(SampleType)));
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel, int count)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto endChannel = juce::jmin(numChannels, static_cast<int>(block.getNumChannels()), firstChannel + count);
+
+    jassert(maxBlockSize > 0);
+    jassert(firstChannel % kernels->laneWidth == 0);
+
+    if (numActiveSlots == 0 || numSamples == 0 || maxBlockSize == 0 || firstChannel >= endChannel)
+        return;
+
+    // Channels are contiguous already, so nothing is interleaved and the
+    // block size does not matter
+    if (timeBlocked)
+    {
+        for (int channel = firstChannel; channel < endChannel; ++channel)
+            blockedKernels->processBlocked(blockMatrices + channel * numSlots * blockMatrixSize, state + channel,
+                                           block.getChannelPointer(static_cast<size_t>(channel)), numSamples, numLanes,
+                                           activeSlots.data(), numActiveSlots);
+        return;
+    }
+
+    // Whole vectors of lanes, which may take in padding lanes at the end
+    const auto width = kernels->laneWidth;
+    const auto groupLanes = juce::jmin(numLanes - firstChannel, ((endChannel - firstChannel + width - 1) / width) * width);
+
+    // Hosts may exceed the announced block size, so work in chunks
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const auto length = juce::jmin(maxBlockSize, numSamples - start);
+
+        for (int channel = firstChannel; channel < endChannel; ++channel)
+        {
+            const auto* src = block.getChannelPointer(static_cast<size_t>(channel)) + start;
+            auto* dst = interleaved + channel;
+
+            for (int n = 0; n < length; ++n)
+                dst[n * numLanes] = src[n];
+        }
+
+        kernels->processCascade(coefficients + firstChannel, state + firstChannel, interleaved + firstChannel, length,
+                                groupLanes, numLanes, activeSlots.data(), numActiveSlots);
+
+        for (int channel = firstChannel; channel < endChannel; ++channel)
+        {
+            const auto* src = interleaved + channel;
+            auto* dst = block.getChannelPointer(static_cast<size_t>(channel)) + start;
+
+            for (int n = 0; n < length; ++n)
+                dst[n] = src[n * numLanes];
+        }
+    }
+}
+
+//==============================================================================
+template class BiquadCascade<float>;
+template class BiquadCascade<double>;
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+    Multi-channel cascade of biquad slots with structure-of-arrays storage,
+    processed by the dispatched filter kernels with one channel per lane.
+    Coefficients, state and the interleaved buffer each start on a cache
+    line. Instantiated for float and double.
+
+    With few channels most lanes carry padding, so the cascade can instead
+    run time blocked: each channel on its own through the blocked kernel,
+    which fills the lanes with consecutive samples.
+
+    Either way, groups of channels can be processed separately, which lets
+    wide buses be shared out between threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterKernels.h"
+
+//==============================================================================
+template <typename SampleType>
+class BiquadCascade
+{
+public:
+    //==============================================================================
+    // Allocates storage for the given layout. All slots start inactive with
+    // identity coefficients. The blocked kernel may use a different, usually
+    // wider, instruction set. Must not be called on the audio thread.
+    void prepare(int numChannels, int maxBlockSize, int numSlots, KernelIsa isa,
+                 KernelIsa blockedIsa = KernelIsa::scalar);
+
+    // Clears the filter state without touching the coefficients
+    void reset();
+
+    // Takes over the other cascade's coefficients, active slots, state and
+    // kernel mode, so both carry on as the same filter. The other cascade
+    // must have been prepared with the same arguments. Allocation free.
+    void copyFrom(const BiquadCascade& other);
+
+    //==============================================================================
+    // Sets a slot's coefficients for every channel, or for a single channel
+    void setSlot(int slot, const BiquadSection<SampleType>& section);
+    void setSlot(int slot, int channel, const BiquadSection<SampleType>& section);
+
+    // Inactive slots are skipped and keep their state, like a bypassed
+    // processor in a juce::dsp::ProcessorChain
+    void setSlotActive(int slot, bool shouldBeActive);
+    bool isSlotActive(int slot) const { return active[static_cast<size_t>(slot)]; }
+
+    // Switches between the interleaved and the time-blocked kernel. Both run
+    // on the same state, so this can change between any two blocks.
+    // Allocation free.
+    void setTimeBlocked(bool shouldBeTimeBlocked);
+    bool isTimeBlocked() const noexcept { return timeBlocked; }
+
+    //==============================================================================
+    // Processes the first getNumChannels() channels of the block in place
+    void process(const juce::dsp::AudioBlock<SampleType>& block);
+
+    // Processes only channels [firstChannel, firstChannel + count). Groups
+    // that start on a multiple of getChannelGroupAlignment() share no vector
+    // lanes and few cache lines, so several can run on different threads at
+    // once.
+    void process(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel, int count);
+    int getChannelGroupAlignment() const noexcept;
+
+    //==============================================================================
+    int getNumChannels() const noexcept { return numChannels; }
+    int getNumSlots() const noexcept { return numSlots; }
+    KernelIsa getKernelIsa() const noexcept { return kernels->isa; }
+    KernelIsa getBlockedKernelIsa() const noexcept { return blockedKernels->isa; }
+
+private:
+    //==============================================================================
+    void rebuildActiveSlots();
+    void designBlockMatrices(int slot, int channel);
+
+    static constexpr size_t cacheLineSize = 64;
+    static SampleType* allocateAligned(juce::HeapBlock<SampleType>& storage, size_t numElements);
+
+    const FilterKernels<SampleType>* kernels = &getFilterKernels<SampleType>(KernelIsa::scalar);
+    const FilterKernels<SampleType>* blockedKernels = kernels;
+
+    int numChannels = 0, numLanes = 0, numSlots = 0, maxBlockSize = 0;
+
+    juce::HeapBlock<SampleType> coefficientStorage, stateStorage, interleavedStorage, blockMatrixStorage;
+    SampleType* coefficients = nullptr;
+    SampleType* state = nullptr;
+    SampleType* interleaved = nullptr;
+
+    // Per channel, the block matrices of every slot. Only kept up to date
+    // while time blocked.
+    SampleType* blockMatrices = nullptr;
+    int blockMatrixSize = 0;
+    bool timeBlocked = false;
+
+    std::vector<bool> active;
+    std::vector<int> activeSlots;
+    int numActiveSlots = 0;
+
+    JUCE_LEAK_DETECTOR(BiquadCascade)
+};
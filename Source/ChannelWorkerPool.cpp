@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.cpp
+    Implements the worker threads and the lock-free task claiming.
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkerPool.h"
+
+//==============================================================================
+class ChannelWorkerPool::Worker : public juce::Thread
+{
+public:
+    explicit Worker(ChannelWorkerPool& ownerPool)
+        : juce::Thread("OloEQ Channel Worker"), pool(ownerPool) {}
+
+    ~Worker() override { stopThread(1000); }
+
+    void run() override
+    {
+        // The audio thread notifies every worker after publishing a job, and
+        // the event stays set if that happens before the wait
+        while (! threadShouldExit())
+            if (! pool.runNextTask())
+                wait(-1);
+    }
+
+private:
+    ChannelWorkerPool& pool;
+};
+
+//==============================================================================
+ChannelWorkerPool::ChannelWorkerPool() = default;
+
+ChannelWorkerPool::~ChannelWorkerPool()
+{
+    release();
+}
+
+void ChannelWorkerPool::prepare(int numWorkers)
+{
+    release();
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*this));
+        workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{});
+    }
+}
+
+void ChannelWorkerPool::release()
+{
+    // Stopping notifies each worker, so none stays asleep
+    for (auto& worker : workers)
+        worker->stopThread(1000);
+
+    workers.clear();
+}
+
+//==============================================================================
+void ChannelWorkerPool::runJob(int numTasks, JobFunction function, void* context)
+{
+    if (numTasks <= 0)
+        return;
+
+    if (workers.empty() || numTasks == 1)
+    {
+        for (int i = 0; i < numTasks; ++i)
+            function(context, i);
+
+        return;
+    }
+
+    // The job is written before its generation opens it, and workers only
+    // read it after seeing that generation
+    jobFunction = function;
+    jobContext = context;
+    jobSize = numTasks;
+    remaining = numTasks;
+
+    const auto generation = ((claims.load() >> 32) + 1) & 0xffffffff;
+    claims.store(generation << 32, std::memory_order_release);
+
+    for (auto& worker : workers)
+        worker->notify();
+
+    while (runNextTask()) {}
+
+    // Every task is claimed, wait for the ones still running elsewhere
+    while (remaining.load(std::memory_order_acquire) > 0)
+        juce::Thread::yield();
+
+    claims.store((generation << 32) | closedJob, std::memory_order_release);
+}
+
+bool ChannelWorkerPool::runNextTask()
+{
+    auto current = claims.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto next = static_cast<juce::uint32>(current & closedJob);
+        const auto function = jobFunction.load(std::memory_order_acquire);
+        const auto context = jobContext.load(std::memory_order_acquire);
+        const auto size = jobSize.load(std::memory_order_acquire);
+
+        if (next >= static_cast<juce::uint32>(size))
+            return false;
+
+        // Fails if another thread claimed this task first or the job was
+        // closed and replaced since it was read, in which case the job is
+        // read again
+        if (claims.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            function(context, static_cast<int>(next));
+            remaining.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.h
+    Pre-spawned real-time threads that share out groups of channels inside
+    one processing call. The audio thread publishes a job, wakes the
+    workers and claims tasks alongside them from a single atomic counter,
+    so whichever thread is free takes the next unclaimed group. The call
+    returns once every task has finished.
+
+    Claiming is lock free. Waking a sleeping worker signals its event,
+    which briefly takes the event's lock, the same as juce::ThreadPool.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class ChannelWorkerPool
+{
+public:
+    //==============================================================================
+    ChannelWorkerPool();
+    ~ChannelWorkerPool();
+
+    // Stops the current workers and starts numWorkers new ones, which sleep
+    // until there is work. Not for the audio thread.
+    void prepare(int numWorkers);
+    void release();
+
+    int getNumWorkers() const noexcept { return static_cast<int>(workers.size()); }
+
+    //==============================================================================
+    // Runs task(0) to task(numTasks - 1) on the workers and the calling
+    // thread and returns once all of them are done. Allocation free. With no
+    // workers, or a single task, everything runs on the calling thread.
+    template <typename Task>
+    void run(int numTasks, Task& task)
+    {
+        runJob(numTasks, [](void* context, int index) { (*static_cast<Task*>(context))(index); }, &task);
+    }
+
+private:
+    //==============================================================================
+    using JobFunction = void (*)(void* context, int index);
+
+    class Worker;
+
+    void runJob(int numTasks, JobFunction function, void* context);
+    bool runNextTask();
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // The job's generation in the high 32 bits and its next unclaimed task
+    // in the low ones. A finished job is closed by marking every task
+    // claimed, so that a worker still holding its generation can never
+    // claim a task of the next one.
+    static constexpr juce::uint64 closedJob = 0xffffffff;
+
+    std::atomic<juce::uint64> claims{ closedJob };
+    std::atomic<JobFunction> jobFunction{ nullptr };
+    std::atomic<void*> jobContext{ nullptr };
+    std::atomic<int> jobSize{ 0 }, remaining{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelWorkerPool)
+};
@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+    Implements the set associative coefficient cache.
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+#include "SharedCoefficientCache.h"
+
+namespace
+{
+    constexpr double gainStepsPerDecibel = 20.0;
+
+    // Rounding away the low mantissa bits of a float puts the value on a
+    // logarithmic grid with 1024 steps per octave, at no more cost than a
+    // couple of integer operations
+    constexpr int droppedMantissaBits = 13;
+
+    juce::int32 quantiseLog(float value)
+    {
+        jassert(value > 0.f);
+
+        juce::int32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits + (1 << (droppedMantissaBits - 1))) >> droppedMantissaBits;
+    }
+
+    float restoreLog(juce::int32 steps)
+    {
+        const juce::int32 bits = steps << droppedMantissaBits;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+//==============================================================================
+juce::uint32 CoefficientKey::getHash() const
+{
+    auto h = static_cast<juce::uint32>(frequency) * 0x9e3779b1u;
+    h ^= static_cast<juce::uint32>(quality) * 0x85ebca77u;
+    h ^= static_cast<juce::uint32>(gain) * 0xc2b2ae3du;
+    h ^= static_cast<juce::uint32>((static_cast<juce::int32>(band) << 4) | order) * 0x27d4eb2fu;
+    h ^= static_cast<juce::uint32>(sampleRate);
+    return h ^ (h >> 15);
+}
+
+//==============================================================================
+template <typename SampleType>
+void CoefficientCache<SampleType>::prepare(int capacity)
+{
+    numSets = juce::nextPowerOfTwo(juce::jmax(1, (capacity + numWays - 1) / numWays));
+    tags.assign(static_cast<size_t>(numSets * numWays), Tag{});
+    entries.assign(static_cast<size_t>(numSets * numWays), Entry{});
+    clear();
+}
+
+template <typename SampleType>
+void CoefficientCache<SampleType>::clear()
+{
+    for (auto& tag : tags)
+        tag.lastUsed = 0;
+
+    clock = 0;
+    hits.store(0, std::memory_order_relaxed);
+    misses.store(0, std::memory_order_relaxed);
+    sharedHits.store(0, std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+juce::uint32 CoefficientCache<SampleType>::tick()
+{
+    // Zero marks empty entries, so start over rather than wrap into it
+    if (++clock == 0)
+    {
+        clear();
+        clock = 1;
+    }
+
+    return clock;
+}
+
+//==============================================================================
+template <typename SampleType>
+template <typename DesignFn>
+const typename CoefficientCache<SampleType>::Entry& CoefficientCache<SampleType>::lookup(const Key& key, DesignFn&& design)
+{
+    // Designs made before prepare are passed straight through, by way of
+    // the shared cache if there is one
+    if (numSets == 0)
+    {
+        fill(key, unprepared, design);
+        return unprepared;
+    }
+
+    const auto hash = key.getHash();
+    const auto first = static_cast<size_t>(hash & static_cast<juce::uint32>(numSets - 1)) * numWays;
+    auto* set = tags.data() + first;
+    int victim = 0;
+
+    for (int way = 0; way < numWays; ++way)
+    {
+        auto& tag = set[way];
+
+        if (tag.lastUsed != 0 && tag.key == key)
+        {
+            tag.lastUsed = tick();
+            hits.store(hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return entries[first + static_cast<size_t>(way)];
+        }
+
+        if (tag.lastUsed < set[victim].lastUsed)
+            victim = way;
+    }
+
+    misses.store(misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    auto& entry = entries[first + static_cast<size_t>(victim)];
+    fill(key, entry, design);
+
+    set[victim].key = key;
+    set[victim].lastUsed = tick();
+    return entry;
+}
+
+template <typename SampleType>
+template <typename DesignFn>
+void CoefficientCache<SampleType>::fill(const Key& key, Entry& entry, DesignFn&& design)
+{
+    if (shared != nullptr && shared->lookup(key, entry))
+    {
+        sharedHits.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    entry.numSections = design(entry.sections);
+
+    if (shared != nullptr)
+        shared->publish(key, entry);
+}
+
+//==============================================================================
+template <typename SampleType>
+BiquadSection<SampleType> CoefficientCache<SampleType>::designPeak(double sampleRate, SampleType frequency, SampleType quality,
+                                                                   SampleType gainInDecibels, bool matched)
+{
+    const Key key{ matched ? Band::matchedPeak : Band::peak, 0,
+                   quantiseLog(static_cast<float>(frequency)), quantiseLog(static_cast<float>(quality)),
+                   juce::roundToInt(gainInDecibels * gainStepsPerDecibel), juce::roundToInt(sampleRate) };
+
+    const auto& entry = lookup(key, [&](BiquadSection<SampleType>* sections)
+    {
+        const auto f = static_cast<SampleType>(restoreLog(key.frequency));
+        const auto q = static_cast<SampleType>(restoreLog(key.quality));
+        const auto g = static_cast<SampleType>(key.gain / gainStepsPerDecibel);
+
+        sections[0] = matched ? designMatchedPeakSection<SampleType>(sampleRate, f, q, g)
+                              : designPeakSection<SampleType>(sampleRate, f, q, g);
+        return 1;
+    });
+
+    return entry.sections[0];
+}
+
+template <typename SampleType>
+int CoefficientCache<SampleType>::designHighPass(double sampleRate, SampleType frequency, int order, BiquadSection<SampleType>* sections)
+{
+    jassert(order > 0 && (order + 1) / 2 <= maxSectionsPerBand);
+
+    const Key key{ Band::highPass, order, quantiseLog(static_cast<float>(frequency)), 0, 0, juce::roundToInt(sampleRate) };
+
+    const auto& entry = lookup(key, [&](BiquadSection<SampleType>* designed)
+    {
+        return designButterworthHighPass<SampleType>(sampleRate, static_cast<SampleType>(restoreLog(key.frequency)), order, designed);
+    });
+
+    std::copy_n(entry.sections, entry.numSections, sections);
+    return entry.numSections;
+}
+
+template <typename SampleType>
+int CoefficientCache<SampleType>::designLowPass(double sampleRate, SampleType frequency, int order, BiquadSection<SampleType>* sections)
+{
+    jassert(order > 0 && (order + 1) / 2 <= maxSectionsPerBand);
+
+    const Key key{ Band::lowPass, order, quantiseLog(static_cast<float>(frequency)), 0, 0, juce::roundToInt(sampleRate) };
+
+    const auto& entry = lookup(key, [&](BiquadSection<SampleType>* designed)
+    {
+        return designButterworthLowPass<SampleType>(sampleRate, static_cast<SampleType>(restoreLog(key.frequency)), order, designed);
+    });
+
+    std::copy_n(entry.sections, entry.numSections, sections);
+    return entry.numSections;
+}
+
+//==============================================================================
+template class CoefficientCache<float>;
+template class CoefficientCache<double>;
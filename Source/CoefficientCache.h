@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    Least recently used cache of designed bands for the control-rate
+    updates. Parameters are quantised first (1024 steps per octave in
+    frequency and Q, which is under 2 cents, and 0.05 dB in gain) and the
+    band is designed from the quantised values, so a hit returns exactly
+    what a fresh design would. Automation that keeps coming back to the
+    same values, such as loops or LFO-like curves, then costs a lookup
+    instead of a redesign.
+
+    The cache is set associative with a fixed number of ways per set, so a
+    lookup touches at most one set and never allocates. Everything is
+    allocated in prepare. Instantiated for float and double.
+
+    With a shared cache attached, a miss asks it before designing and
+    offers it the new design, so instances loaded with the same settings
+    design each band once between them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+template <typename SampleType>
+class SharedCoefficientCache;
+
+//==============================================================================
+// The quantised parameters a band is designed from
+struct CoefficientKey
+{
+    enum class Band : juce::int32
+    {
+        peak,
+        matchedPeak,
+        highPass,
+        lowPass
+    };
+
+    Band band;
+    juce::int32 order, frequency, quality, gain, sampleRate;
+
+    bool operator==(const CoefficientKey& other) const
+    {
+        return band == other.band && order == other.order && frequency == other.frequency
+            && quality == other.quality && gain == other.gain && sampleRate == other.sampleRate;
+    }
+
+    juce::uint32 getHash() const;
+};
+
+// The sections designed for a key
+template <typename SampleType>
+struct CoefficientSet
+{
+    // Enough sections for an order 8 Butterworth cut
+    static constexpr int maxSections = 4;
+
+    juce::int32 numSections;
+    BiquadSection<SampleType> sections[maxSections];
+};
+
+//==============================================================================
+template <typename SampleType>
+class CoefficientCache
+{
+public:
+    //==============================================================================
+    static constexpr int maxSectionsPerBand = CoefficientSet<SampleType>::maxSections;
+
+    // Allocates room for at least capacity bands, across all band types
+    void prepare(int capacity);
+    void clear();
+
+    // Consulted on every miss from then on, including before prepare. The
+    // shared cache must outlive this one.
+    void setSharedCache(SharedCoefficientCache<SampleType>* cacheToShare) noexcept { shared = cacheToShare; }
+
+    //==============================================================================
+    // Same arguments and results as the designers in CoefficientDesign.h
+    BiquadSection<SampleType> designPeak(double sampleRate, SampleType frequency, SampleType quality,
+                                         SampleType gainInDecibels, bool matched);
+    int designHighPass(double sampleRate, SampleType frequency, int order, BiquadSection<SampleType>* sections);
+    int designLowPass(double sampleRate, SampleType frequency, int order, BiquadSection<SampleType>* sections);
+
+    //==============================================================================
+    // Counters since the last prepare or clear. Written on the audio thread.
+    int getHits() const noexcept { return hits.load(std::memory_order_relaxed); }
+    int getMisses() const noexcept { return misses.load(std::memory_order_relaxed); }
+
+    // Misses the shared cache answered
+    int getSharedHits() const noexcept { return sharedHits.load(std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    using Band = CoefficientKey::Band;
+    using Key = CoefficientKey;
+    using Entry = CoefficientSet<SampleType>;
+
+    // Tags are kept apart from the sections so a lookup only scans a few
+    // cache lines
+    struct Tag
+    {
+        Key key;
+        juce::uint32 lastUsed;   // zero while the entry is empty
+    };
+
+    static constexpr int numWays = 8;
+
+    template <typename DesignFn>
+    const Entry& lookup(const Key& key, DesignFn&& design);
+    juce::uint32 tick();
+
+    // Takes the entry from the shared cache if it has it, otherwise designs
+    // it and offers it to the shared cache
+    template <typename DesignFn>
+    void fill(const Key& key, Entry& entry, DesignFn&& design);
+
+    std::vector<Tag> tags;
+    std::vector<Entry> entries;
+    Entry unprepared{};
+    int numSets = 0;
+    juce::uint32 clock = 0;
+    SharedCoefficientCache<SampleType>* shared = nullptr;
+
+    std::atomic<int> hits{ 0 }, misses{ 0 }, sharedHits{ 0 };
+
+    JUCE_LEAK_DETECTOR(CoefficientCache)
+};
@@ -0,0 +1,273 @@
+/*
+  ==============================================================================
+
+    CoefficientDesign.cpp
+    Implements the allocation-free coefficient designers.
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesign.h"
+
+namespace
+{
+    // Normalises by a0 the same way IIR::Coefficients does
+    template <typename SampleType>
+    BiquadSection<SampleType> normalise(SampleType b0, SampleType b1, SampleType b2, SampleType a0, SampleType a1, SampleType a2)
+    {
+        const auto a0Inv = a0 != SampleType(0) ? SampleType(1) / a0 : SampleType(0);
+        return { b0 * a0Inv, b1 * a0Inv, b2 * a0Inv, a1 * a0Inv, a2 * a0Inv };
+    }
+
+    template <typename SampleType>
+    BiquadSection<SampleType> normaliseFirstOrder(SampleType b0, SampleType b1, SampleType a0, SampleType a1)
+    {
+        const auto a0Inv = a0 != SampleType(0) ? SampleType(1) / a0 : SampleType(0);
+        return { b0 * a0Inv, b1 * a0Inv, SampleType(0), a1 * a0Inv, SampleType(0) };
+    }
+
+    template <typename SampleType, typename FirstOrderFn, typename SecondOrderFn>
+    int designButterworth(int order, BiquadSection<SampleType>* sections, FirstOrderFn&& firstOrder, SecondOrderFn&& secondOrder)
+    {
+        jassert(order > 0);
+
+        int numSections = 0;
+
+        if (order % 2 == 1)
+            sections[numSections++] = firstOrder();
+
+        for (int i = 0; i < order / 2; ++i)
+            sections[numSections++] = secondOrder(static_cast<SampleType>(getButterworthInverseQuality(order, i)));
+
+        return numSections;
+    }
+
+    //==============================================================================
+    constexpr double getButterworthPoleAngle(int order, int index)
+    {
+        return order % 2 == 1 ? (index + 1.0) * juce::MathConstants<double>::pi / order
+                              : (2.0 * index + 1.0) * juce::MathConstants<double>::pi / (order * 2.0);
+    }
+
+    // Taylor series, the pole angles are all below pi / 2 where it converges
+    // to full precision well within the terms used
+    constexpr double constexprCos(double x)
+    {
+        double term = 1.0, sum = 1.0;
+
+        for (int i = 1; i < 24; ++i)
+        {
+            term *= -x * x / ((2.0 * i - 1.0) * (2.0 * i));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    using InverseQualityTable = std::array<std::array<double, maxTabulatedButterworthOrder / 2>, maxTabulatedButterworthOrder + 1>;
+
+    constexpr InverseQualityTable makeInverseQualityTable()
+    {
+        InverseQualityTable table{};
+
+        for (int order = 1; order <= maxTabulatedButterworthOrder; ++order)
+            for (int index = 0; index < order / 2; ++index)
+                table[static_cast<size_t>(order)][static_cast<size_t>(index)] = 2.0 * constexprCos(getButterworthPoleAngle(order, index));
+
+        return table;
+    }
+
+    constexpr auto inverseQualities = makeInverseQualityTable();
+
+    static_assert(inverseQualities[2][0] > 1.41421356237309 && inverseQualities[2][0] < 1.41421356237310,
+                  "Order 2 Butterworth should have Q = 1 / sqrt(2)");
+}
+
+//==============================================================================
+double getButterworthInverseQuality(int order, int index)
+{
+    jassert(order > 0 && index >= 0 && index < order / 2);
+
+    if (order <= maxTabulatedButterworthOrder)
+        return inverseQualities[static_cast<size_t>(order)][static_cast<size_t>(index)];
+
+    return 2.0 * std::cos(getButterworthPoleAngle(order, index));
+}
+
+double getButterworthQuality(int order, int index)
+{
+    return 1.0 / getButterworthInverseQuality(order, index);
+}
+
+//==============================================================================
+template <typename SampleType>
+BiquadSection<SampleType> designPeakSection(double sampleRate, SampleType frequency, SampleType quality, SampleType gainInDecibels)
+{
+    using T = SampleType;
+
+    const auto A = juce::jmax(T(0), std::sqrt(juce::Decibels::decibelsToGain(gainInDecibels)));
+    const auto omega = (T(2) * juce::MathConstants<T>::pi * juce::jmax(frequency, T(2))) / static_cast<T>(sampleRate);
+    const auto alpha = std::sin(omega) / (quality * T(2));
+    const auto c2 = T(-2) * std::cos(omega);
+    const auto alphaTimesA = alpha * A;
+    const auto alphaOverA = alpha / A;
+
+    return normalise(T(1) + alphaTimesA, c2, T(1) - alphaTimesA, T(1) + alphaOverA, c2, T(1) - alphaOverA);
+}
+
+template <typename SampleType>
+BiquadSection<SampleType> designLowShelfSection(double sampleRate, SampleType frequency, SampleType quality, SampleType gainInDecibels)
+{
+    using T = SampleType;
+
+    const auto A = juce::jmax(T(0), std::sqrt(juce::Decibels::decibelsToGain(gainInDecibels)));
+    const auto aMinus1 = A - T(1);
+    const auto aPlus1 = A + T(1);
+    const auto omega = (T(2) * juce::MathConstants<T>::pi * juce::jmax(frequency, T(2))) / static_cast<T>(sampleRate);
+    const auto cosOmega = std::cos(omega);
+    const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+    const auto aMinus1TimesCos = aMinus1 * cosOmega;
+
+    return normalise(A * (aPlus1 - aMinus1TimesCos + beta), A * T(2) * (aMinus1 - aPlus1 * cosOmega), A * (aPlus1 - aMinus1TimesCos - beta),
+                     aPlus1 + aMinus1TimesCos + beta, T(-2) * (aMinus1 + aPlus1 * cosOmega), aPlus1 + aMinus1TimesCos - beta);
+}
+
+template <typename SampleType>
+BiquadSection<SampleType> designHighShelfSection(double sampleRate, SampleType frequency, SampleType quality, SampleType gainInDecibels)
+{
+    using T = SampleType;
+
+    const auto A = juce::jmax(T(0), std::sqrt(juce::Decibels::decibelsToGain(gainInDecibels)));
+    const auto aMinus1 = A - T(1);
+    const auto aPlus1 = A + T(1);
+    const auto omega = (T(2) * juce::MathConstants<T>::pi * juce::jmax(frequency, T(2))) / static_cast<T>(sampleRate);
+    const auto cosOmega = std::cos(omega);
+    const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+    const auto aMinus1TimesCos = aMinus1 * cosOmega;
+
+    return normalise(A * (aPlus1 + aMinus1TimesCos + beta), A * T(-2) * (aMinus1 + aPlus1 * cosOmega), A * (aPlus1 + aMinus1TimesCos - beta),
+                     aPlus1 - aMinus1TimesCos + beta, T(2) * (aMinus1 - aPlus1 * cosOmega), aPlus1 - aMinus1TimesCos - beta);
+}
+
+template <typename SampleType>
+BiquadSection<SampleType> designNotchSection(double sampleRate, SampleType frequency, SampleType quality)
+{
+    using T = SampleType;
+
+    const auto n = T(1) / std::tan(juce::MathConstants<T>::pi * frequency / static_cast<T>(sampleRate));
+    const auto nSquared = n * n;
+    const auto invQ = T(1) / quality;
+    const auto c1 = T(1) / (T(1) + n * invQ + nSquared);
+    const auto b0 = c1 * (T(1) + nSquared);
+    const auto b1 = T(2) * c1 * (T(1) - nSquared);
+
+    return { b0, b1, b0, b1, c1 * (T(1) - n * invQ + nSquared) };
+}
+
+template <typename SampleType>
+BiquadSection<SampleType> designMatchedPeakSection(double sampleRate, SampleType frequency, SampleType quality, SampleType gainInDecibels)
+{
+    // Same prototype as the RBJ peak: H(s) = (s^2 + s A / Q + 1) / (s^2 + s / (A Q) + 1),
+    // i.e. damping 1 / (2 A Q) and a centre gain of A^2
+    const auto A = std::sqrt(juce::Decibels::decibelsToGain(static_cast<double>(gainInDecibels), -300.0));
+    const auto G = A * A;
+    const auto zeta = 1.0 / (2.0 * A * static_cast<double>(quality));
+    const auto w0 = juce::MathConstants<double>::twoPi * juce::jlimit(2.0, 0.5 * sampleRate, static_cast<double>(frequency)) / sampleRate;
+
+    // Impulse invariant poles
+    const auto decay = std::exp(-zeta * w0);
+    const auto a1 = zeta <= 1.0 ? -2.0 * decay * std::cos(std::sqrt(1.0 - zeta * zeta) * w0)
+                                : -2.0 * decay * std::cosh(std::sqrt(zeta * zeta - 1.0) * w0);
+    const auto a2 = decay * decay;
+
+    // Zeros from the squared magnitude, written in phi = sin^2(w / 2): B0
+    // keeps unity gain at DC, R1 sets the gain at w0 to G and R2 makes the
+    // slope there G^2 times the poles' slope, so the magnitude is flat at w0
+    const auto A0 = (1.0 + a1 + a2) * (1.0 + a1 + a2);
+    const auto A1 = (1.0 - a1 + a2) * (1.0 - a1 + a2);
+    const auto A2 = -4.0 * a2;
+
+    const auto phi1 = std::pow(std::sin(0.5 * w0), 2.0);
+    const auto phi0 = 1.0 - phi1;
+    const auto phi2 = 4.0 * phi0 * phi1;
+
+    const auto R1 = (A0 * phi0 + A1 * phi1 + A2 * phi2) * G * G;
+    const auto R2 = (-A0 + A1 + 4.0 * (phi0 - phi1) * A2) * G * G;
+
+    const auto B0 = A0;
+    const auto B2 = (R1 - R2 * phi1 - B0) / (4.0 * phi1 * phi1);
+    const auto B1 = R2 + B0 + 4.0 * (phi1 - phi0) * B2;
+
+    const auto rootB0 = std::sqrt(B0);
+    const auto rootB1 = std::sqrt(juce::jmax(0.0, B1));
+    const auto W = 0.5 * (rootB0 + rootB1);
+
+    const auto b0 = 0.5 * (W + std::sqrt(juce::jmax(0.0, W * W + B2)));
+    const auto b1 = 0.5 * (rootB0 - rootB1);
+    const auto b2 = -B2 / (4.0 * b0);
+
+    return { static_cast<SampleType>(b0), static_cast<SampleType>(b1), static_cast<SampleType>(b2),
+             static_cast<SampleType>(a1), static_cast<SampleType>(a2) };
+}
+
+//==============================================================================
+template <typename SampleType>
+int designButterworthHighPass(double sampleRate, SampleType frequency, int order, BiquadSection<SampleType>* sections)
+{
+    using T = SampleType;
+
+    const auto t = std::tan(juce::MathConstants<T>::pi * frequency / static_cast<T>(sampleRate));
+    const auto n = T(1) / t;
+    const auto nSquared = n * n;
+
+    return designButterworth(order, sections,
+        [t]
+        {
+            return normaliseFirstOrder(T(1), T(-1), t + T(1), t - T(1));
+        },
+        [n, nSquared](T invQ)
+        {
+            const auto c1 = T(1) / (T(1) + invQ * n + nSquared);
+            const auto b0 = c1 * nSquared;
+
+            return BiquadSection<T>{ b0, T(-2) * b0, b0, c1 * T(2) * (T(1) - nSquared), c1 * (T(1) - invQ * n + nSquared) };
+        });
+}
+
+template <typename SampleType>
+int designButterworthLowPass(double sampleRate, SampleType frequency, int order, BiquadSection<SampleType>* sections)
+{
+    using T = SampleType;
+
+    const auto t = std::tan(juce::MathConstants<T>::pi * frequency / static_cast<T>(sampleRate));
+    const auto n = T(1) / t;
+    const auto nSquared = n * n;
+
+    return designButterworth(order, sections,
+        [t]
+        {
+            return normaliseFirstOrder(t, t, t + T(1), t - T(1));
+        },
+        [n, nSquared](T invQ)
+        {
+            const auto c1 = T(1) / (T(1) + invQ * n + nSquared);
+
+            return BiquadSection<T>{ c1, T(2) * c1, c1, c1 * T(2) * (T(1) - nSquared), c1 * (T(1) - invQ * n + nSquared) };
+        });
+}
+
+//==============================================================================
+template BiquadSection<float> designPeakSection<float>(double, float, float, float);
+template BiquadSection<double> designPeakSection<double>(double, double, double, double);
+template BiquadSection<float> designLowShelfSection<float>(double, float, float, float);
+template BiquadSection<double> designLowShelfSection<double>(double, double, double, double);
+template BiquadSection<float> designHighShelfSection<float>(double, float, float, float);
+template BiquadSection<double> designHighShelfSection<double>(double, double, double, double);
+template BiquadSection<float> designNotchSection<float>(double, float, float);
+template BiquadSection<double> designNotchSection<double>(double, double, double);
+template BiquadSection<float> designMatchedPeakSection<float>(double, float, float, float);
+template BiquadSection<double> designMatchedPeakSection<double>(double, double, double, double);
+template int designButterworthHighPass<float>(double, float, int, BiquadSection<float>*);
+template int designButterworthHighPass<double>(double, double, int, BiquadSection<double>*);
+template int designButterworthLowPass<float>(double, float, int, BiquadSection<float>*);
+template int designButterworthLowPass<double>(double, double, int, BiquadSection<double>*);
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    CoefficientDesign.h
+    Allocation-free coefficient designers for the cascade. These follow the
+    same formulas as juce::dsp::IIR::Coefficients and FilterDesign, but write
+    straight into BiquadSection values so they are cheap enough to run at
+    control rate on the audio thread. The designers run in the precision of
+    the sections they produce and are instantiated for float and double.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterKernels.h"
+
+//==============================================================================
+// RBJ peaking section, as IIR::Coefficients::makePeakFilter
+template <typename SampleType>
+BiquadSection<SampleType> designPeakSection(double sampleRate, SampleType frequency, SampleType quality, SampleType gainInDecibels);
+
+// Magnitude-matched peaking section (M. Vicanek, "Matched Second Order
+// Digital Filters"). Takes the same parameters and analog prototype as the
+// RBJ design, but instead of warping the prototype it matches its unity
+// gain at DC and its gain at the centre frequency, with the magnitude flat
+// there so the bell peaks where it should. Bells near Nyquist therefore do
+// not cramp, though the gain at Nyquist itself is not matched. The design
+// is computed in double whatever the section type.
+template <typename SampleType>
+BiquadSection<SampleType> designMatchedPeakSection(double sampleRate, SampleType frequency, SampleType quality, SampleType gainInDecibels);
+
+// RBJ shelving sections and notch, as IIR::Coefficients::makeLowShelf,
+// makeHighShelf and makeNotch
+template <typename SampleType>
+BiquadSection<SampleType> designLowShelfSection(double sampleRate, SampleType frequency, SampleType quality, SampleType gainInDecibels);
+
+template <typename SampleType>
+BiquadSection<SampleType> designHighShelfSection(double sampleRate, SampleType frequency, SampleType quality, SampleType gainInDecibels);
+
+template <typename SampleType>
+BiquadSection<SampleType> designNotchSection(double sampleRate, SampleType frequency, SampleType quality);
+
+//==============================================================================
+// Orders up to this one have their section Qs computed at compile time
+constexpr int maxTabulatedButterworthOrder = 8;
+
+// Q of the index-th second order section of a Butterworth filter, not
+// counting the leading first order section of odd orders, and its inverse
+// (twice the cosine of the pole angle)
+double getButterworthQuality(int order, int index);
+double getButterworthInverseQuality(int order, int index);
+
+//==============================================================================
+// Butterworth cut filters of the given order, as FilterDesign's
+// designIIR...HighOrderButterworthMethod. Odd orders start with a first
+// order section. Writes (order + 1) / 2 sections and returns that count.
+// All sections share a single tan(pi f / fs).
+template <typename SampleType>
+int designButterworthHighPass(double sampleRate, SampleType frequency, int order, BiquadSection<SampleType>* sections);
+
+template <typename SampleType>
+int designButterworthLowPass(double sampleRate, SampleType frequency, int order, BiquadSection<SampleType>* sections);
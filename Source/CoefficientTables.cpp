@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    CoefficientTables.cpp
+    Implements the precomputed coefficient tables.
+
+  ==============================================================================
+*/
+
+#include "CoefficientTables.h"
+
+namespace
+{
+    // Splits a value into a table index and the fraction towards the next
+    // entry, clamped to the table
+    template <typename SampleType>
+    int splitIndex(SampleType position, int numEntries, SampleType& fraction)
+    {
+        position = juce::jlimit(SampleType(0), static_cast<SampleType>(numEntries - 1), position);
+
+        const auto index = juce::jmin(static_cast<int>(position), numEntries - 2);
+        fraction = position - static_cast<SampleType>(index);
+        return index;
+    }
+
+    template <typename SampleType>
+    SampleType interpolate(SampleType a, SampleType b, SampleType fraction)
+    {
+        return a + fraction * (b - a);
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void CoefficientTables<SampleType>::prepare(double sampleRate)
+{
+    using T = SampleType;
+
+    cutSections.resize(static_cast<size_t>(numFrequencies * numCutSections));
+    peakTrig.resize(static_cast<size_t>(numFrequencies));
+
+    // The inverse Qs in the order the sections are stored
+    std::array<double, numCutSections - 1> inverseQualities{};
+
+    for (int order = 3, i = 0; order <= 7; order += 2)
+        for (int section = 0; section < order / 2; ++section)
+            inverseQualities[static_cast<size_t>(i++)] = getButterworthInverseQuality(order, section);
+
+    // Built in double with the formulas of CoefficientDesign.cpp
+    for (int step = 0; step < numFrequencies; ++step)
+    {
+        const auto w = juce::MathConstants<double>::pi * (minFrequency + step) / sampleRate;
+        const auto t = std::tan(w);
+        auto* row = cutSections.data() + step * numCutSections;
+
+        const auto firstOrderInv = 1.0 / (t + 1.0);
+        row[0] = { static_cast<T>(t * firstOrderInv), static_cast<T>(firstOrderInv),
+                   static_cast<T>((t - 1.0) * firstOrderInv), T(0) };
+
+        const auto n = 1.0 / t;
+        const auto nSquared = n * n;
+
+        for (size_t i = 0; i < inverseQualities.size(); ++i)
+        {
+            const auto invQ = inverseQualities[i];
+            const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+            row[i + 1] = { static_cast<T>(c1), static_cast<T>(c1 * nSquared),
+                           static_cast<T>(c1 * 2.0 * (1.0 - nSquared)), static_cast<T>(c1 * (1.0 - invQ * n + nSquared)) };
+        }
+
+        const auto omega = 2.0 * w;
+        peakTrig[static_cast<size_t>(step)] = { static_cast<T>(std::sin(omega)), static_cast<T>(std::cos(omega)) };
+    }
+
+    const auto numGains = static_cast<int>((maxGain - minGain) / gainStep) + 1;
+    peakAmplitudes.resize(static_cast<size_t>(numGains));
+
+    for (int step = 0; step < numGains; ++step)
+    {
+        const auto amplitude = std::sqrt(juce::Decibels::decibelsToGain(static_cast<double>(minGain + step * gainStep)));
+        peakAmplitudes[static_cast<size_t>(step)] = { static_cast<T>(amplitude), static_cast<T>(1.0 / amplitude) };
+    }
+
+    tableSampleRate = sampleRate;
+}
+
+template <typename SampleType>
+size_t CoefficientTables<SampleType>::getMemoryUsage() const noexcept
+{
+    return cutSections.size() * sizeof(CutSection) + peakTrig.size() * sizeof(PeakTrig)
+         + peakAmplitudes.size() * sizeof(PeakAmplitude);
+}
+
+//==============================================================================
+template <typename SampleType>
+BiquadSection<SampleType> CoefficientTables<SampleType>::designPeak(SampleType frequency, SampleType quality,
+                                                                    SampleType gainInDecibels) const
+{
+    using T = SampleType;
+
+    jassert(tableSampleRate > 0.0);
+
+    T f, g;
+    const auto& trig0 = peakTrig[static_cast<size_t>(splitIndex(frequency - T(minFrequency), numFrequencies, f))];
+    const auto& trig1 = (&trig0)[1];
+
+    const auto gainIndex = splitIndex((gainInDecibels - T(minGain)) / T(gainStep), static_cast<int>(peakAmplitudes.size()), g);
+    const auto& amp0 = peakAmplitudes[static_cast<size_t>(gainIndex)];
+    const auto& amp1 = (&amp0)[1];
+
+    // As designPeakSection, with the transcendental parts looked up
+    const auto A = interpolate(amp0.amplitude, amp1.amplitude, g);
+    const auto AInv = interpolate(amp0.inverse, amp1.inverse, g);
+    const auto alpha = interpolate(trig0.sinOmega, trig1.sinOmega, f) / (quality * T(2));
+    const auto c2 = T(-2) * interpolate(trig0.cosOmega, trig1.cosOmega, f);
+    const auto alphaTimesA = alpha * A;
+    const auto alphaOverA = alpha * AInv;
+
+    const auto a0Inv = T(1) / (T(1) + alphaOverA);
+    return { (T(1) + alphaTimesA) * a0Inv, c2 * a0Inv, (T(1) - alphaTimesA) * a0Inv, c2 * a0Inv, (T(1) - alphaOverA) * a0Inv };
+}
+
+template <typename SampleType>
+template <bool isHighPass>
+int CoefficientTables<SampleType>::designCut(SampleType frequency, int order, BiquadSection<SampleType>* sections) const
+{
+    using T = SampleType;
+
+    jassert(tableSampleRate > 0.0);
+
+    T f;
+    const auto* row0 = cutSections.data() + splitIndex(frequency - T(minFrequency), numFrequencies, f) * numCutSections;
+    const auto* row1 = row0 + numCutSections;
+
+    auto lerp = [f](const CutSection& a, const CutSection& b)
+    {
+        return CutSection{ interpolate(a.lowGain, b.lowGain, f), interpolate(a.highGain, b.highGain, f),
+                           interpolate(a.a1, b.a1, f), interpolate(a.a2, b.a2, f) };
+    };
+
+    const auto first = lerp(row0[0], row1[0]);
+    sections[0] = isHighPass ? BiquadSection<T>{ first.highGain, -first.highGain, T(0), first.a1, T(0) }
+                             : BiquadSection<T>{ first.lowGain, first.lowGain, T(0), first.a1, T(0) };
+
+    const auto start = getFirstCutSection(order);
+
+    for (int i = 0; i < order / 2; ++i)
+    {
+        const auto s = lerp(row0[start + i], row1[start + i]);
+
+        sections[i + 1] = isHighPass ? BiquadSection<T>{ s.highGain, T(-2) * s.highGain, s.highGain, s.a1, s.a2 }
+                                     : BiquadSection<T>{ s.lowGain, T(2) * s.lowGain, s.lowGain, s.a1, s.a2 };
+    }
+
+    return order / 2 + 1;
+}
+
+template <typename SampleType>
+int CoefficientTables<SampleType>::designHighPass(SampleType frequency, int order, BiquadSection<SampleType>* sections) const
+{
+    if (order % 2 == 0 || order > 7)
+        return designButterworthHighPass(tableSampleRate, frequency, order, sections);
+
+    return designCut<true>(frequency, order, sections);
+}
+
+template <typename SampleType>
+int CoefficientTables<SampleType>::designLowPass(SampleType frequency, int order, BiquadSection<SampleType>* sections) const
+{
+    if (order % 2 == 0 || order > 7)
+        return designButterworthLowPass(tableSampleRate, frequency, order, sections);
+
+    return designCut<false>(frequency, order, sections);
+}
+
+//==============================================================================
+template class CoefficientTables<float>;
+template class CoefficientTables<double>;
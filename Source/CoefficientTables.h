@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    CoefficientTables.h
+    Precomputed coefficients on the parameter grid, for the optional table
+    mode. For every 1 Hz frequency step the tables hold each distinct
+    Butterworth section the four cut slopes use (the first order section
+    and the six second order Qs of orders 3, 5 and 7), plus the sine and
+    cosine the peak needs. Low and high cuts share their denominators, so
+    a section is stored as its two numerator gains and a1, a2. The peak
+    amplitude is tabulated per 0.5 dB gain step.
+
+    Smoothed values fall between grid steps, so lookups interpolate
+    linearly between the neighbouring entries. Interpolated denominators
+    stay inside the stability triangle, which is convex. Tables are built
+    for one sample rate in prepare and never allocate afterwards.
+    Instantiated for float and double.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+//==============================================================================
+template <typename SampleType>
+class CoefficientTables
+{
+public:
+    //==============================================================================
+    // Same grid as the parameters in createParameterLayout
+    static constexpr int minFrequency = 20;
+    static constexpr int maxFrequency = 20000;
+    static constexpr float minGain = -24.f;
+    static constexpr float maxGain = 24.f;
+    static constexpr float gainStep = 0.5f;
+
+    // Not for the audio thread
+    void prepare(double sampleRate);
+    bool isPreparedFor(double sampleRate) const noexcept { return sampleRate == tableSampleRate; }
+
+    size_t getMemoryUsage() const noexcept;
+
+    //==============================================================================
+    // Same arguments and results as the designers in CoefficientDesign.h, at
+    // the sample rate the tables were prepared for. Cut orders other than
+    // 1, 3, 5 and 7 are designed directly.
+    BiquadSection<SampleType> designPeak(SampleType frequency, SampleType quality, SampleType gainInDecibels) const;
+    int designHighPass(SampleType frequency, int order, BiquadSection<SampleType>* sections) const;
+    int designLowPass(SampleType frequency, int order, BiquadSection<SampleType>* sections) const;
+
+private:
+    //==============================================================================
+    struct CutSection
+    {
+        SampleType lowGain, highGain, a1, a2;
+    };
+
+    struct PeakTrig
+    {
+        SampleType sinOmega, cosOmega;
+    };
+
+    struct PeakAmplitude
+    {
+        SampleType amplitude, inverse;
+    };
+
+    static constexpr int numFrequencies = maxFrequency - minFrequency + 1;
+
+    // First order section, then the Qs of orders 3, 5 and 7
+    static constexpr int numCutSections = 7;
+
+    static constexpr int getFirstCutSection(int order) { return 1 + (order / 2) * (order / 2 - 1) / 2; }
+
+    template <bool isHighPass>
+    int designCut(SampleType frequency, int order, BiquadSection<SampleType>* sections) const;
+
+    std::vector<CutSection> cutSections;
+    std::vector<PeakTrig> peakTrig;
+    std::vector<PeakAmplitude> peakAmplitudes;
+    double tableSampleRate = 0.0;
+
+    JUCE_LEAK_DETECTOR(CoefficientTables)
+};
@@ -0,0 +1,508 @@
+/*
+  ==============================================================================
+
+    FilterKernels.cpp
+    Builds one kernel table per instruction set from FilterKernelsImpl.h and
+    selects between them at runtime based on the CPU the plugin is loaded on.
+
+    Each SIMD variant is compiled with a per-function target so the rest of
+    the plugin keeps its baseline architecture flags.
+
+  ==============================================================================
+*/
+
+#include "FilterKernels.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+#if JUCE_ARM && (defined (__aarch64__) || defined (_M_ARM64))
+ #include <arm_neon.h>
+ #define OLOEQ_NEON_KERNELS 1
+#else
+ #define OLOEQ_NEON_KERNELS 0
+#endif
+
+//==============================================================================
+// Scalar reference, matches juce::dsp::IIR::Filter bit for bit
+namespace scalar_kernels
+{
+    template <typename SampleType>
+    struct ScalarV
+    {
+        using Scalar = SampleType;
+        using Type = SampleType;
+        static constexpr int width = 1;
+
+        static Type load(const Scalar* p)       { return *p; }
+        static void store(Scalar* p, Type v)    { *p = v; }
+        static Type set1(Scalar v)              { return v; }
+        static Type add(Type a, Type b)         { return a + b; }
+        static Type sub(Type a, Type b)         { return a - b; }
+        static Type mul(Type a, Type b)         { return a * b; }
+        static Type div(Type a, Type b)         { return a / b; }
+        static Type max(Type a, Type b)         { return std::max(a, b); }
+        static Type sqrt(Type v)                { return std::sqrt(v); }
+        static Scalar sum(Type v)               { return v; }
+        static Type snapToZero(Type v)          { return (v < Type(-1.0e-8) || v > Type(1.0e-8)) ? v : Type(0); }
+    };
+
+    using VFloat = ScalarV<float>;
+    using VDouble = ScalarV<double>;
+
+    constexpr auto isa = KernelIsa::scalar;
+
+    #include "FilterKernelsImpl.h"
+}
+
+#if JUCE_INTEL
+//==============================================================================
+// SSE2
+#if defined (__clang__)
+ #pragma clang attribute push (__attribute__((target ("sse2"))), apply_to = function)
+#elif defined (__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target ("sse2")
+#endif
+
+namespace sse2_kernels
+{
+    struct VFloat
+    {
+        using Scalar = float;
+        using Type = __m128;
+        static constexpr int width = 4;
+
+        static __m128 load(const float* p)      { return _mm_loadu_ps(p); }
+        static void store(float* p, __m128 v)   { _mm_storeu_ps(p, v); }
+        static __m128 set1(float v)             { return _mm_set1_ps(v); }
+        static __m128 add(__m128 a, __m128 b)   { return _mm_add_ps(a, b); }
+        static __m128 sub(__m128 a, __m128 b)   { return _mm_sub_ps(a, b); }
+        static __m128 mul(__m128 a, __m128 b)   { return _mm_mul_ps(a, b); }
+        static __m128 div(__m128 a, __m128 b)   { return _mm_div_ps(a, b); }
+        static __m128 max(__m128 a, __m128 b)   { return _mm_max_ps(a, b); }
+        static __m128 sqrt(__m128 v)            { return _mm_sqrt_ps(v); }
+        static float sum(__m128 v)
+        {
+            const auto pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+            return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+        }
+
+        static __m128 snapToZero(__m128 v)
+        {
+            const auto magnitude = _mm_andnot_ps(_mm_set1_ps(-0.f), v);
+            return _mm_and_ps(v, _mm_cmpgt_ps(magnitude, _mm_set1_ps(1.0e-8f)));
+        }
+    };
+
+    struct VDouble
+    {
+        using Scalar = double;
+        using Type = __m128d;
+        static constexpr int width = 2;
+
+        static __m128d load(const double* p)        { return _mm_loadu_pd(p); }
+        static void store(double* p, __m128d v)     { _mm_storeu_pd(p, v); }
+        static __m128d set1(double v)               { return _mm_set1_pd(v); }
+        static __m128d add(__m128d a, __m128d b)    { return _mm_add_pd(a, b); }
+        static __m128d sub(__m128d a, __m128d b)    { return _mm_sub_pd(a, b); }
+        static __m128d mul(__m128d a, __m128d b)    { return _mm_mul_pd(a, b); }
+        static __m128d div(__m128d a, __m128d b)    { return _mm_div_pd(a, b); }
+        static __m128d max(__m128d a, __m128d b)    { return _mm_max_pd(a, b); }
+        static __m128d sqrt(__m128d v)              { return _mm_sqrt_pd(v); }
+        static double sum(__m128d v)                { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+
+        static __m128d snapToZero(__m128d v)
+        {
+            const auto magnitude = _mm_andnot_pd(_mm_set1_pd(-0.0), v);
+            return _mm_and_pd(v, _mm_cmpgt_pd(magnitude, _mm_set1_pd(1.0e-8)));
+        }
+    };
+
+    constexpr auto isa = KernelIsa::sse2;
+
+    #include "FilterKernelsImpl.h"
+}
+
+#if defined (__clang__)
+ #pragma clang attribute pop
+#elif defined (__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+//==============================================================================
+// AVX2
+#if defined (__clang__)
+ #pragma clang attribute push (__attribute__((target ("avx2"))), apply_to = function)
+#elif defined (__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target ("avx2")
+#endif
+
+namespace avx2_kernels
+{
+    struct VFloat
+    {
+        using Scalar = float;
+        using Type = __m256;
+        static constexpr int width = 8;
+
+        static __m256 load(const float* p)      { return _mm256_loadu_ps(p); }
+        static void store(float* p, __m256 v)   { _mm256_storeu_ps(p, v); }
+        static __m256 set1(float v)             { return _mm256_set1_ps(v); }
+        static __m256 add(__m256 a, __m256 b)   { return _mm256_add_ps(a, b); }
+        static __m256 sub(__m256 a, __m256 b)   { return _mm256_sub_ps(a, b); }
+        static __m256 mul(__m256 a, __m256 b)   { return _mm256_mul_ps(a, b); }
+        static __m256 div(__m256 a, __m256 b)   { return _mm256_div_ps(a, b); }
+        static __m256 max(__m256 a, __m256 b)   { return _mm256_max_ps(a, b); }
+        static __m256 sqrt(__m256 v)            { return _mm256_sqrt_ps(v); }
+        static float sum(__m256 v)
+        {
+            const auto quad = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            const auto pairs = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+            return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+        }
+
+        static __m256 snapToZero(__m256 v)
+        {
+            const auto magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.f), v);
+            return _mm256_and_ps(v, _mm256_cmp_ps(magnitude, _mm256_set1_ps(1.0e-8f), _CMP_GT_OQ));
+        }
+    };
+
+    struct VDouble
+    {
+        using Scalar = double;
+        using Type = __m256d;
+        static constexpr int width = 4;
+
+        static __m256d load(const double* p)        { return _mm256_loadu_pd(p); }
+        static void store(double* p, __m256d v)     { _mm256_storeu_pd(p, v); }
+        static __m256d set1(double v)               { return _mm256_set1_pd(v); }
+        static __m256d add(__m256d a, __m256d b)    { return _mm256_add_pd(a, b); }
+        static __m256d sub(__m256d a, __m256d b)    { return _mm256_sub_pd(a, b); }
+        static __m256d mul(__m256d a, __m256d b)    { return _mm256_mul_pd(a, b); }
+        static __m256d div(__m256d a, __m256d b)    { return _mm256_div_pd(a, b); }
+        static __m256d max(__m256d a, __m256d b)    { return _mm256_max_pd(a, b); }
+        static __m256d sqrt(__m256d v)              { return _mm256_sqrt_pd(v); }
+        static double sum(__m256d v)
+        {
+            const auto pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+        }
+
+        static __m256d snapToZero(__m256d v)
+        {
+            const auto magnitude = _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+            return _mm256_and_pd(v, _mm256_cmp_pd(magnitude, _mm256_set1_pd(1.0e-8), _CMP_GT_OQ));
+        }
+    };
+
+    constexpr auto isa = KernelIsa::avx2;
+
+    #include "FilterKernelsImpl.h"
+}
+
+#if defined (__clang__)
+ #pragma clang attribute pop
+#elif defined (__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+//==============================================================================
+// AVX-512
+#if defined (__clang__)
+ #pragma clang attribute push (__attribute__((target ("avx512f"))), apply_to = function)
+#elif defined (__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target ("avx512f")
+#endif
+
+namespace avx512_kernels
+{
+    struct VFloat
+    {
+        using Scalar = float;
+        using Type = __m512;
+        static constexpr int width = 16;
+
+        static __m512 load(const float* p)      { return _mm512_loadu_ps(p); }
+        static void store(float* p, __m512 v)   { _mm512_storeu_ps(p, v); }
+        static __m512 set1(float v)             { return _mm512_set1_ps(v); }
+        static __m512 add(__m512 a, __m512 b)   { return _mm512_add_ps(a, b); }
+        static __m512 sub(__m512 a, __m512 b)   { return _mm512_sub_ps(a, b); }
+        static __m512 mul(__m512 a, __m512 b)   { return _mm512_mul_ps(a, b); }
+        static __m512 div(__m512 a, __m512 b)   { return _mm512_div_ps(a, b); }
+        static __m512 max(__m512 a, __m512 b)   { return _mm512_max_ps(a, b); }
+        static __m512 sqrt(__m512 v)            { return _mm512_sqrt_ps(v); }
+        static float sum(__m512 v)              { return _mm512_reduce_add_ps(v); }
+
+        static __m512 snapToZero(__m512 v)
+        {
+            const auto keep = _mm512_cmp_ps_mask(_mm512_abs_ps(v), _mm512_set1_ps(1.0e-8f), _CMP_GT_OQ);
+            return _mm512_maskz_mov_ps(keep, v);
+        }
+    };
+
+    struct VDouble
+    {
+        using Scalar = double;
+        using Type = __m512d;
+        static constexpr int width = 8;
+
+        static __m512d load(const double* p)        { return _mm512_loadu_pd(p); }
+        static void store(double* p, __m512d v)     { _mm512_storeu_pd(p, v); }
+        static __m512d set1(double v)               { return _mm512_set1_pd(v); }
+        static __m512d add(__m512d a, __m512d b)    { return _mm512_add_pd(a, b); }
+        static __m512d sub(__m512d a, __m512d b)    { return _mm512_sub_pd(a, b); }
+        static __m512d mul(__m512d a, __m512d b)    { return _mm512_mul_pd(a, b); }
+        static __m512d div(__m512d a, __m512d b)    { return _mm512_div_pd(a, b); }
+        static __m512d max(__m512d a, __m512d b)    { return _mm512_max_pd(a, b); }
+        static __m512d sqrt(__m512d v)              { return _mm512_sqrt_pd(v); }
+        static double sum(__m512d v)                { return _mm512_reduce_add_pd(v); }
+
+        static __m512d snapToZero(__m512d v)
+        {
+            const auto keep = _mm512_cmp_pd_mask(_mm512_abs_pd(v), _mm512_set1_pd(1.0e-8), _CMP_GT_OQ);
+            return _mm512_maskz_mov_pd(keep, v);
+        }
+    };
+
+    constexpr auto isa = KernelIsa::avx512;
+
+    #include "FilterKernelsImpl.h"
+}
+
+#if defined (__clang__)
+ #pragma clang attribute pop
+#elif defined (__GNUC__)
+ #pragma GCC pop_options
+#endif
+#endif // JUCE_INTEL
+
+#if OLOEQ_NEON_KERNELS
+//==============================================================================
+// NEON (AArch64 only, where NEON is part of the baseline)
+namespace neon_kernels
+{
+    struct VFloat
+    {
+        using Scalar = float;
+        using Type = float32x4_t;
+        static constexpr int width = 4;
+
+        static float32x4_t load(const float* p)                   { return vld1q_f32(p); }
+        static void store(float* p, float32x4_t v)                { vst1q_f32(p, v); }
+        static float32x4_t set1(float v)                          { return vdupq_n_f32(v); }
+        static float32x4_t add(float32x4_t a, float32x4_t b)      { return vaddq_f32(a, b); }
+        static float32x4_t sub(float32x4_t a, float32x4_t b)      { return vsubq_f32(a, b); }
+        static float32x4_t mul(float32x4_t a, float32x4_t b)      { return vmulq_f32(a, b); }
+        static float32x4_t div(float32x4_t a, float32x4_t b)      { return vdivq_f32(a, b); }
+        static float32x4_t max(float32x4_t a, float32x4_t b)      { return vmaxq_f32(a, b); }
+        static float32x4_t sqrt(float32x4_t v)                    { return vsqrtq_f32(v); }
+        static float sum(float32x4_t v)                           { return vaddvq_f32(v); }
+
+        static float32x4_t snapToZero(float32x4_t v)
+        {
+            const auto keep = vcgtq_f32(vabsq_f32(v), vdupq_n_f32(1.0e-8f));
+            return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), keep));
+        }
+    };
+
+    struct VDouble
+    {
+        using Scalar = double;
+        using Type = float64x2_t;
+        static constexpr int width = 2;
+
+        static float64x2_t load(const double* p)                  { return vld1q_f64(p); }
+        static void store(double* p, float64x2_t v)               { vst1q_f64(p, v); }
+        static float64x2_t set1(double v)                         { return vdupq_n_f64(v); }
+        static float64x2_t add(float64x2_t a, float64x2_t b)      { return vaddq_f64(a, b); }
+        static float64x2_t sub(float64x2_t a, float64x2_t b)      { return vsubq_f64(a, b); }
+        static float64x2_t mul(float64x2_t a, float64x2_t b)      { return vmulq_f64(a, b); }
+        static float64x2_t div(float64x2_t a, float64x2_t b)      { return vdivq_f64(a, b); }
+        static float64x2_t max(float64x2_t a, float64x2_t b)      { return vmaxq_f64(a, b); }
+        static float64x2_t sqrt(float64x2_t v)                    { return vsqrtq_f64(v); }
+        static double sum(float64x2_t v)                          { return vaddvq_f64(v); }
+
+        static float64x2_t snapToZero(float64x2_t v)
+        {
+            const auto keep = vcgtq_f64(vabsq_f64(v), vdupq_n_f64(1.0e-8));
+            return vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(v), keep));
+        }
+    };
+
+    constexpr auto isa = KernelIsa::neon;
+
+    #include "FilterKernelsImpl.h"
+}
+#endif
+
+//==============================================================================
+// Dispatch
+bool isKernelIsaSupported(KernelIsa isa)
+{
+    switch (isa)
+    {
+        case KernelIsa::scalar: return true;
+       #if JUCE_INTEL
+        case KernelIsa::sse2:   return juce::SystemStats::hasSSE2();
+        case KernelIsa::avx2:   return juce::SystemStats::hasAVX2();
+        case KernelIsa::avx512: return juce::SystemStats::hasAVX512F();
+       #endif
+       #if OLOEQ_NEON_KERNELS
+        case KernelIsa::neon:   return true;
+       #endif
+        default:                return false;
+    }
+}
+
+namespace
+{
+    // Each namespace builds a float and a double table, pick the one asked for
+    template <typename SampleType>
+    const FilterKernels<SampleType>& selectKernels(const FilterKernels<float>& floatTable,
+                                                   const FilterKernels<double>& doubleTable)
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return floatTable;
+        else
+            return doubleTable;
+    }
+}
+
+template <typename SampleType>
+const FilterKernels<SampleType>& getFilterKernels(KernelIsa isa)
+{
+    // Asking for an unsupported table is a caller bug, fall back to scalar
+    jassert(isKernelIsaSupported(isa));
+
+    if (! isKernelIsaSupported(isa))
+        return selectKernels<SampleType>(scalar_kernels::floatKernels, scalar_kernels::doubleKernels);
+
+    switch (isa)
+    {
+       #if JUCE_INTEL
+        case KernelIsa::sse2:   return selectKernels<SampleType>(sse2_kernels::floatKernels, sse2_kernels::doubleKernels);
+        case KernelIsa::avx2:   return selectKernels<SampleType>(avx2_kernels::floatKernels, avx2_kernels::doubleKernels);
+        case KernelIsa::avx512: return selectKernels<SampleType>(avx512_kernels::floatKernels, avx512_kernels::doubleKernels);
+       #endif
+       #if OLOEQ_NEON_KERNELS
+        case KernelIsa::neon:   return selectKernels<SampleType>(neon_kernels::floatKernels, neon_kernels::doubleKernels);
+       #endif
+        default:                return selectKernels<SampleType>(scalar_kernels::floatKernels, scalar_kernels::doubleKernels);
+    }
+}
+
+const char* getKernelIsaName(KernelIsa isa)
+{
+    switch (isa)
+    {
+        case KernelIsa::scalar: return "Scalar";
+        case KernelIsa::sse2:   return "SSE2";
+        case KernelIsa::avx2:   return "AVX2";
+        case KernelIsa::avx512: return "AVX-512";
+        case KernelIsa::neon:   return "NEON";
+    }
+
+    return "Unknown";
+}
+
+template <typename SampleType>
+KernelIsa getBestKernelIsa(int numLanes)
+{
+    auto best = KernelIsa::scalar;
+    auto bestIterations = numLanes;
+
+    // Fewest vector iterations wins, ties go to the narrower instruction set
+    for (auto isa : { KernelIsa::sse2, KernelIsa::neon, KernelIsa::avx2, KernelIsa::avx512 })
+    {
+        if (! isKernelIsaSupported(isa))
+            continue;
+
+        const auto width = getFilterKernels<SampleType>(isa).laneWidth;
+        const auto iterations = (numLanes + width - 1) / width;
+
+        if (iterations < bestIterations)
+        {
+            best = isa;
+            bestIterations = iterations;
+        }
+    }
+
+    return best;
+}
+
+template <typename SampleType>
+KernelIsa getWidestKernelIsa()
+{
+    auto widest = KernelIsa::scalar;
+    auto widestLanes = 1;
+
+    for (auto isa : { KernelIsa::sse2, KernelIsa::neon, KernelIsa::avx2, KernelIsa::avx512 })
+    {
+        if (! isKernelIsaSupported(isa))
+            continue;
+
+        const auto width = getFilterKernels<SampleType>(isa).laneWidth;
+
+        if (width > widestLanes)
+        {
+            widest = isa;
+            widestLanes = width;
+        }
+    }
+
+    return widest;
+}
+
+//==============================================================================
+template <typename SampleType>
+void designBlockMatrices(const BiquadSection<SampleType>& section, int laneWidth, SampleType* matrices)
+{
+    // The three responses are run in double, so that float matrices are
+    // rounded once rather than accumulating rounding along the recursion
+    auto respond = [&section, laneWidth](double input, double lv1, double lv2, SampleType* response)
+    {
+        const auto b0 = static_cast<double>(section.b0), b1 = static_cast<double>(section.b1),
+                   b2 = static_cast<double>(section.b2), a1 = static_cast<double>(section.a1),
+                   a2 = static_cast<double>(section.a2);
+
+        for (int n = 0; n < laneWidth; ++n)
+        {
+            const auto output = input * b0 + lv1;
+            response[n] = static_cast<SampleType>(output);
+
+            lv1 = (input * b1 - output * a1) + lv2;
+            lv2 = input * b2 - output * a2;
+            input = 0.0;
+        }
+    };
+
+    std::fill_n(matrices, getBlockMatrixSize(laneWidth), SampleType(0));
+
+    respond(1.0, 0.0, 0.0, matrices + laneWidth);
+    respond(0.0, 1.0, 0.0, matrices + 2 * laneWidth);
+    respond(0.0, 0.0, 1.0, matrices + 3 * laneWidth);
+
+    auto* coefficients = matrices + 4 * laneWidth;
+    coefficients[0] = section.b0;
+    coefficients[1] = section.b1;
+    coefficients[2] = section.b2;
+    coefficients[3] = section.a1;
+    coefficients[4] = section.a2;
+    coefficients[5] = section.b1 - section.a1;
+    coefficients[6] = section.b2 - section.a2;
+}
+
+//==============================================================================
+template const FilterKernels<float>& getFilterKernels<float>(KernelIsa);
+template const FilterKernels<double>& getFilterKernels<double>(KernelIsa);
+template KernelIsa getBestKernelIsa<float>(int);
+template KernelIsa getBestKernelIsa<double>(int);
+template KernelIsa getWidestKernelIsa<float>();
+template KernelIsa getWidestKernelIsa<double>();
+template void designBlockMatrices<float>(const BiquadSection<float>&, int, float*);
+template void designBlockMatrices<double>(const BiquadSection<double>&, int, double*);
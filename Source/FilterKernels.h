@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    FilterKernels.h
+    Declares the low-level filter kernels used by the processing engine and
+    the response curve, along with runtime CPU feature dispatch between the
+    scalar, SSE2, AVX2, AVX-512 and NEON implementations.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Instruction sets a kernel table can be built for
+enum class KernelIsa
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512,
+    neon
+};
+
+//==============================================================================
+// A single normalised biquad section (a0 == 1), first order sections leave
+// b2 and a2 at zero
+template <typename SampleType>
+struct BiquadSection
+{
+    SampleType b0{ 1 }, b1{ 0 }, b2{ 0 }, a1{ 0 }, a2{ 0 };
+};
+
+//==============================================================================
+// Kernel table for one instruction set and sample type
+template <typename SampleType>
+struct FilterKernels
+{
+    // Runs the listed slots in series (transposed direct form II) over
+    // numLanes lanes of interleaved samples, laneStride values per frame.
+    // Coefficients are stored as five rows of laneStride values per slot
+    // (b0, b1, b2, a1, a2), state as two rows. Passing pointers offset into
+    // the rows runs a subset of the lanes.
+    using ProcessCascadeFn = void (*)(const SampleType* coefficients, SampleType* state, SampleType* samples,
+                                      int numSamples, int numLanes, int laneStride, const int* slots, int numSlots);
+
+    // Runs a parallel form realisation over one channel: writes direct *
+    // input plus the sum of every branch (c0 + c1 z^-1) / (1 + a1 z^-1 +
+    // a2 z^-2) into output. One branch per lane, coefficients are stored as
+    // four rows of numLanes values (c0, c1, a1, a2), state as two rows.
+    using ProcessParallelFn = void (*)(const SampleType* coefficients, SampleType* state, const SampleType* input,
+                                       SampleType* output, int numSamples, int numLanes, SampleType direct);
+
+    // Runs the listed slots in series over the contiguous samples of one
+    // channel, a whole vector of laneWidth samples per step. Each slot's
+    // block matrices hold its response over one vector (see
+    // designBlockMatrices), so the recursion only links one vector to the
+    // next. State is the same transposed direct form II pair processCascade
+    // uses, stateStride values apart, so the two can take over from each
+    // other mid-stream.
+    using ProcessBlockedFn = void (*)(const SampleType* matrices, SampleType* state, SampleType* samples,
+                                      int numSamples, int stateStride, const int* slots, int numSlots);
+
+    // Writes the magnitude of the cascade of sections at each point, where
+    // phi[i] = sin^2(w / 2) for the normalised angular frequency w
+    using EvaluateMagnitudeFn = void (*)(const BiquadSection<SampleType>* sections, int numSections,
+                                         const SampleType* phi, SampleType* magnitudes, int numPoints);
+
+    // Replaces a channel pair (a, b) with ((a + b) * scale, (a - b) * scale).
+    // A scale of 0.5 encodes left/right to mid/side, 1 decodes it again.
+    using RotateChannelPairFn = void (*)(SampleType* first, SampleType* second, int numSamples, SampleType scale);
+
+    KernelIsa isa;
+    int laneWidth;
+    ProcessCascadeFn processCascade;
+    ProcessParallelFn processParallel;
+    ProcessBlockedFn processBlocked;
+    EvaluateMagnitudeFn evaluateMagnitude;
+    RotateChannelPairFn rotateChannelPair;
+};
+
+//==============================================================================
+// Dispatch helpers, instantiated for float and double
+bool isKernelIsaSupported(KernelIsa isa);
+const char* getKernelIsaName(KernelIsa isa);
+
+template <typename SampleType>
+const FilterKernels<SampleType>& getFilterKernels(KernelIsa isa);
+
+// Picks the supported kernel that covers the given number of interleaved
+// lanes in the fewest vector iterations
+template <typename SampleType>
+KernelIsa getBestKernelIsa(int numLanes);
+
+// Picks the supported kernel with the most lanes, for the blocked kernel
+template <typename SampleType>
+KernelIsa getWidestKernelIsa();
+
+//==============================================================================
+// Block matrices of one section for the blocked kernel: its impulse
+// response over laneWidth samples after laneWidth zeros, its responses to
+// unit values of either state variable, and the section itself followed
+// by b1 - a1 and b2 - a2
+constexpr int getBlockMatrixSize(int laneWidth) { return 4 * laneWidth + 8; }
+
+template <typename SampleType>
+void designBlockMatrices(const BiquadSection<SampleType>& section, int laneWidth, SampleType* matrices);
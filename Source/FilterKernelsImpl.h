@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    FilterKernelsImpl.h
+    Generic kernel bodies shared by every instruction set. This file is
+    included once per target from FilterKernels.cpp, inside a namespace that
+    provides the float and double vector types VFloat and VDouble, so it
+    deliberately has no include guard.
+
+  ==============================================================================
+*/
+
+//==============================================================================
+// Cascade processing, one lane group and one slot at a time so that the
+// coefficients and state stay in registers for the whole block
+template <typename V, typename SampleType = typename V::Scalar>
+static void processCascade(const SampleType* coefficients, SampleType* state, SampleType* samples,
+                           int numSamples, int numLanes, int laneStride, const int* slots, int numSlots)
+{
+    for (int lane = 0; lane < numLanes; lane += V::width)
+    {
+        for (int i = 0; i < numSlots; ++i)
+        {
+            const auto* c = coefficients + slots[i] * 5 * laneStride + lane;
+            auto* s = state + slots[i] * 2 * laneStride + lane;
+
+            const auto b0 = V::load(c);
+            const auto b1 = V::load(c + laneStride);
+            const auto b2 = V::load(c + 2 * laneStride);
+            const auto a1 = V::load(c + 3 * laneStride);
+            const auto a2 = V::load(c + 4 * laneStride);
+
+            auto lv1 = V::load(s);
+            auto lv2 = V::load(s + laneStride);
+
+            auto* x = samples + lane;
+
+            for (int n = 0; n < numSamples; ++n, x += laneStride)
+            {
+                const auto input = V::load(x);
+                const auto output = V::add(V::mul(input, b0), lv1);
+                V::store(x, output);
+
+                lv1 = V::add(V::sub(V::mul(input, b1), V::mul(output, a1)), lv2);
+                lv2 = V::sub(V::mul(input, b2), V::mul(output, a2));
+            }
+
+            V::store(s, V::snapToZero(lv1));
+            V::store(s + laneStride, V::snapToZero(lv2));
+        }
+    }
+}
+
+//==============================================================================
+// Parallel form, with the branches of one channel across the lanes. Every
+// branch sees the same input, so the lanes run side by side and only their
+// sum joins them. Branch coefficients are four rows of numLanes values
+// (c0, c1, a1, a2), state two rows.
+template <typename V, typename SampleType = typename V::Scalar>
+static void processParallel(const SampleType* coefficients, SampleType* state, const SampleType* input, SampleType* output,
+                            int numSamples, int numLanes, SampleType direct)
+{
+    for (int n = 0; n < numSamples; ++n)
+        output[n] = direct * input[n];
+
+    for (int lane = 0; lane < numLanes; lane += V::width)
+    {
+        const auto* c = coefficients + lane;
+        auto* s = state + lane;
+
+        const auto c0 = V::load(c);
+        const auto c1 = V::load(c + numLanes);
+        const auto a1 = V::load(c + 2 * numLanes);
+        const auto minusA2 = V::sub(V::set1(SampleType(0)), V::load(c + 3 * numLanes));
+
+        auto lv1 = V::load(s);
+        auto lv2 = V::load(s + numLanes);
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            const auto x = V::set1(input[n]);
+            const auto y = V::add(V::mul(x, c0), lv1);
+
+            lv1 = V::add(V::sub(V::mul(x, c1), V::mul(y, a1)), lv2);
+            lv2 = V::mul(y, minusA2);
+
+            output[n] += V::sum(y);
+        }
+
+        V::store(s, V::snapToZero(lv1));
+        V::store(s + numLanes, V::snapToZero(lv2));
+    }
+}
+
+//==============================================================================
+// Time-blocked cascade over one channel. With x the next laneWidth inputs,
+// a block's outputs are the sum of x[j] times the impulse response delayed
+// by j, plus the responses to the state it starts from. Every term is one
+// vector operation, and the input terms do not depend on earlier blocks,
+// so only the two state terms sit on the recursion. The state after the
+// block follows from its last two inputs and outputs, written in terms of
+// x - y and b - a so that it stays exactly zero through sections that are
+// the identity, even where the compiler fuses the multiply-adds. Samples
+// left over after the last whole vector run through the plain recursion.
+template <typename V, typename SampleType = typename V::Scalar>
+static void processBlocked(const SampleType* matrices, SampleType* state, SampleType* samples,
+                           int numSamples, int stateStride, const int* slots, int numSlots)
+{
+    constexpr auto width = V::width;
+    constexpr auto matrixSize = getBlockMatrixSize(width);
+
+    // A single lane has nothing to block
+    const auto blockedLength = width > 1 ? numSamples - numSamples % width : 0;
+
+    auto snapToZero = [](SampleType v) { return (v < SampleType(-1.0e-8) || v > SampleType(1.0e-8)) ? v : SampleType(0); };
+
+    for (int i = 0; i < numSlots; ++i)
+    {
+        const auto* m = matrices + slots[i] * matrixSize;
+        const auto* impulse = m + width;
+        const auto fromState1 = V::load(m + 2 * width);
+        const auto fromState2 = V::load(m + 3 * width);
+
+        const auto* c = m + 4 * width;
+        const auto b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        const auto d1 = c[5], d2 = c[6];
+
+        auto* s = state + slots[i] * 2 * stateStride;
+        auto lv1 = s[0];
+        auto lv2 = s[stateStride];
+
+        for (int start = 0; start < blockedLength; start += width)
+        {
+            auto* x = samples + start;
+
+            auto output = V::mul(V::set1(x[0]), V::load(impulse));
+
+            for (int j = 1; j < width; ++j)
+                output = V::add(output, V::mul(V::set1(x[j]), V::load(impulse - j)));
+
+            const auto lastInput = x[width - 1];
+            const auto previousInput = x[width - 2];
+
+            output = V::add(output, V::add(V::mul(V::set1(lv1), fromState1), V::mul(V::set1(lv2), fromState2)));
+            V::store(x, output);
+
+            const auto lastOutput = x[width - 1];
+            const auto previousOutput = x[width - 2];
+
+            const auto lastDifference = lastInput - lastOutput;
+            const auto previousDifference = previousInput - previousOutput;
+
+            lv1 = (b1 * lastDifference + d1 * lastOutput) + (b2 * previousDifference + d2 * previousOutput);
+            lv2 = b2 * lastDifference + d2 * lastOutput;
+        }
+
+        for (int n = blockedLength; n < numSamples; ++n)
+        {
+            const auto input = samples[n];
+            const auto output = input * b0 + lv1;
+            samples[n] = output;
+
+            lv1 = (input * b1 - output * a1) + lv2;
+            lv2 = input * b2 - output * a2;
+        }
+
+        s[0] = snapToZero(lv1);
+        s[stateStride] = snapToZero(lv2);
+    }
+}
+
+//==============================================================================
+// Magnitude response, vectorised across evaluation points. Uses the
+// sin^2(w / 2) form of |H|^2, which stays accurate near DC and Nyquist,
+// and takes the ratio per section so deep stop bands do not underflow.
+template <typename V, typename SampleType = typename V::Scalar>
+static void evaluateMagnitude(const BiquadSection<SampleType>* sections, int numSections,
+                              const SampleType* phi, SampleType* magnitudes, int numPoints)
+{
+    struct Terms { SampleType n0, n1, n2, d0, d1, d2; };
+
+    auto makeTerms = [](const BiquadSection<SampleType>& s)
+    {
+        const auto bSum = s.b0 + s.b1 + s.b2;
+        const auto aSum = SampleType(1) + s.a1 + s.a2;
+
+        return Terms{ bSum * bSum, SampleType(-4) * (s.b0 * s.b1 + SampleType(4) * s.b0 * s.b2 + s.b1 * s.b2), SampleType(16) * s.b0 * s.b2,
+                      aSum * aSum, SampleType(-4) * (s.a1 + SampleType(4) * s.a2 + s.a1 * s.a2),            SampleType(16) * s.a2 };
+    };
+
+    int i = 0;
+
+    for (; i + V::width <= numPoints; i += V::width)
+    {
+        const auto p = V::load(phi + i);
+        auto power = V::set1(SampleType(1));
+
+        for (int k = 0; k < numSections; ++k)
+        {
+            const auto t = makeTerms(sections[k]);
+            const auto num = V::add(V::set1(t.n0), V::mul(p, V::add(V::set1(t.n1), V::mul(p, V::set1(t.n2)))));
+            const auto den = V::add(V::set1(t.d0), V::mul(p, V::add(V::set1(t.d1), V::mul(p, V::set1(t.d2)))));
+            power = V::mul(power, V::div(num, den));
+        }
+
+        V::store(magnitudes + i, V::sqrt(V::max(power, V::set1(SampleType(0)))));
+    }
+
+    for (; i < numPoints; ++i)
+    {
+        const auto p = phi[i];
+        auto power = SampleType(1);
+
+        for (int k = 0; k < numSections; ++k)
+        {
+            const auto t = makeTerms(sections[k]);
+            power *= (t.n0 + p * (t.n1 + p * t.n2)) / (t.d0 + p * (t.d1 + p * t.d2));
+        }
+
+        magnitudes[i] = std::sqrt(std::max(power, SampleType(0)));
+    }
+}
+
+//==============================================================================
+// Sum and difference of a channel pair, in place
+template <typename V, typename SampleType = typename V::Scalar>
+static void rotateChannelPair(SampleType* first, SampleType* second, int numSamples, SampleType scale)
+{
+    const auto s = V::set1(scale);
+    int i = 0;
+
+    for (; i + V::width <= numSamples; i += V::width)
+    {
+        const auto a = V::load(first + i);
+        const auto b = V::load(second + i);
+        V::store(first + i, V::mul(V::add(a, b), s));
+        V::store(second + i, V::mul(V::sub(a, b), s));
+    }
+
+    for (; i < numSamples; ++i)
+    {
+        const auto a = first[i];
+        const auto b = second[i];
+        first[i] = (a + b) * scale;
+        second[i] = (a - b) * scale;
+    }
+}
+
+//==============================================================================
+static const FilterKernels<float> floatKernels{ isa, VFloat::width, processCascade<VFloat>, processParallel<VFloat>,
+                                                processBlocked<VFloat>, evaluateMagnitude<VFloat>, rotateChannelPair<VFloat> };
+static const FilterKernels<double> doubleKernels{ isa, VDouble::width, processCascade<VDouble>, processParallel<VDouble>,
+                                                  processBlocked<VDouble>, evaluateMagnitude<VDouble>, rotateChannelPair<VDouble> };
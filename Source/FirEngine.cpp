@@ -0,0 +1,263 @@
+/*
+  ==============================================================================
+
+    FirEngine.cpp
+    Implements the background FIR designer, its kernel cache and the FIR
+    processing engine.
+
+  ==============================================================================
+*/
+
+#include "FirEngine.h"
+
+namespace
+{
+    // The cepstrum is computed on a grid this many times finer than the
+    // kernel, which keeps its time aliasing well below the kernel's own
+    // truncation error
+    constexpr int cepstrumOversampling = 4;
+
+    // Floor for the log magnitude, cut filters reach true zeros at Nyquist
+    constexpr double minimumMagnitude = 1.0e-7;
+}
+
+//==============================================================================
+FirEngine::FirEngine() : juce::Thread("OloEQ FIR Designer") {}
+
+FirEngine::~FirEngine()
+{
+    stopThread(1000);
+}
+
+//==============================================================================
+void FirEngine::prepare(int numChannels, KernelIsa isa, const DesignRequest& initialRequest)
+{
+    stopThread(1000);
+
+    kernelIsa = isa;
+    convolver.prepare(numChannels, headPartitionSize, maxLength);
+
+    const auto maxFftLength = cepstrumOversampling * maxLength;
+    phi.calloc(static_cast<size_t>(maxFftLength / 2 + 1));
+    magnitudes.calloc(static_cast<size_t>(maxFftLength / 2 + 1));
+    fftBuffer.calloc(static_cast<size_t>(2 * maxFftLength));
+
+    cachedKernels.calloc(static_cast<size_t>(numCachedKernels * maxLength));
+    cacheEntries = {};
+    cacheClock = 0;
+    cacheHits = cacheMisses = 0;
+
+    designPending = false;
+
+    // With the thread stopped the designer state can be written directly
+    request = initialRequest;
+    loadRequestedKernel();
+}
+
+void FirEngine::start()
+{
+    if (! isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+
+    convolver.start();
+}
+
+void FirEngine::stop()
+{
+    stopThread(1000);
+    convolver.stop();
+}
+
+void FirEngine::reset()
+{
+    convolver.reset();
+}
+
+bool FirEngine::requestDesign(const DesignRequest& newRequest)
+{
+    {
+        const juce::SpinLock::ScopedTryLockType lock(requestLock);
+
+        if (! lock.isLocked())
+            return false;
+
+        pendingRequest = newRequest;
+        designPending = true;
+    }
+
+    notify();
+    return true;
+}
+
+void FirEngine::designPendingNow()
+{
+    loadPendingRequest();
+}
+
+//==============================================================================
+void FirEngine::run()
+{
+    // Sleeps until requestDesign wakes it. The audio thread only wakes it
+    // once per accepted request, which can afford the event's lock.
+    while (! threadShouldExit())
+        if (! loadPendingRequest())
+            wait(-1);
+}
+
+bool FirEngine::loadPendingRequest()
+{
+    // The request is taken under the lock, so designPendingNow cannot
+    // return while the designer is still on the one it took
+    const juce::ScopedLock lock(designLock);
+
+    if (! designPending.exchange(false))
+        return false;
+
+    {
+        const juce::SpinLock::ScopedLockType requestScope(requestLock);
+        request = pendingRequest;
+    }
+
+    loadRequestedKernel();
+    return true;
+}
+
+void FirEngine::loadRequestedKernel()
+{
+    jassert(juce::isPowerOfTwo(request.length) && request.length >= minLength && request.length <= maxLength);
+    request.length = juce::jlimit(minLength, maxLength, juce::nextPowerOfTwo(request.length));
+    request.numSections = juce::jlimit(0, maxSections, request.numSections);
+
+    const auto latency = request.phase == FirPhase::linear ? request.length / 2 : 0;
+
+    // Settings that come back reuse their kernel as it was designed
+    for (size_t i = 0; i < cacheEntries.size(); ++i)
+    {
+        auto& entry = cacheEntries[i];
+
+        if (entry.length == request.length && entry.phase == request.phase && entry.key == request.key)
+        {
+            entry.lastUsed = ++cacheClock;
+            ++cacheHits;
+
+            convolver.loadKernel(cachedKernels + static_cast<int>(i) * maxLength, request.length, latency);
+            return;
+        }
+    }
+
+    // Otherwise design into the least recently used entry
+    const auto oldest = std::min_element(cacheEntries.begin(), cacheEntries.end(),
+                                         [](const CacheEntry& a, const CacheEntry& b) { return a.lastUsed < b.lastUsed; });
+
+    auto* kernel = cachedKernels + static_cast<int>(std::distance(cacheEntries.begin(), oldest)) * maxLength;
+
+    if (request.phase == FirPhase::minimum)
+        designMinimumPhase(kernel);
+    else
+        designLinearPhase(kernel);
+
+    *oldest = { request.key, request.length, request.phase, ++cacheClock };
+    ++cacheMisses;
+
+    convolver.loadKernel(kernel, request.length, latency);
+}
+
+//==============================================================================
+juce::dsp::FFT& FirEngine::getFft(int length)
+{
+    const auto order = juce::roundToInt(std::log2(length));
+    auto& fft = ffts[static_cast<size_t>(order)];
+
+    // Only ever created on the designer thread
+    if (fft == nullptr)
+        fft = std::make_unique<juce::dsp::FFT>(order);
+
+    return *fft;
+}
+
+void FirEngine::sampleMagnitude(int fftLength)
+{
+    // Sample the cascade's magnitude on the FFT bins, using the same kernel
+    // as the response curve
+    const auto numBins = fftLength / 2 + 1;
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const auto s = std::sin(juce::MathConstants<double>::pi * k / fftLength);
+        phi[k] = s * s;
+    }
+
+    getFilterKernels<double>(kernelIsa).evaluateMagnitude(request.sections.data(), request.numSections,
+                                                          phi, magnitudes, numBins);
+}
+
+void FirEngine::designLinearPhase(float* kernel)
+{
+    const auto length = request.length;
+    const auto numBins = length / 2 + 1;
+
+    sampleMagnitude(length);
+
+    // A real, zero phase spectrum gives an impulse symmetric around time
+    // zero. Alternating the sign moves its centre to the middle tap.
+    juce::FloatVectorOperations::clear(fftBuffer.get(), 2 * length);
+
+    for (int k = 0; k < numBins; ++k)
+        fftBuffer[2 * k] = static_cast<float>((k & 1) != 0 ? -magnitudes[k] : magnitudes[k]);
+
+    getFft(length).performRealOnlyInverseTransform(fftBuffer);
+
+    // Blackman window, which is zero on tap 0 and so leaves the kernel
+    // exactly symmetric around length / 2
+    for (int n = 0; n < length; ++n)
+    {
+        const auto x = juce::MathConstants<double>::twoPi * n / length;
+        kernel[n] = fftBuffer[n] * static_cast<float>(0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2.0 * x));
+    }
+}
+
+void FirEngine::designMinimumPhase(float* kernel)
+{
+    const auto length = request.length;
+    const auto fftLength = cepstrumOversampling * length;
+    const auto numBins = fftLength / 2 + 1;
+    auto& fft = getFft(fftLength);
+
+    sampleMagnitude(fftLength);
+
+    // Real cepstrum of the magnitude
+    juce::FloatVectorOperations::clear(fftBuffer.get(), 2 * fftLength);
+
+    for (int k = 0; k < numBins; ++k)
+        fftBuffer[2 * k] = static_cast<float>(std::log(juce::jmax(magnitudes[k], minimumMagnitude)));
+
+    fft.performRealOnlyInverseTransform(fftBuffer);
+
+    // Folding the anti-causal half onto the causal one keeps the magnitude
+    // and gives the minimum phase log spectrum
+    for (int n = 1; n < fftLength / 2; ++n)
+        fftBuffer[n] *= 2.f;
+
+    juce::FloatVectorOperations::clear(fftBuffer + fftLength / 2 + 1, fftLength / 2 - 1);
+    fft.performRealOnlyForwardTransform(fftBuffer, true);
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const auto bin = std::exp(std::complex<double>(fftBuffer[2 * k], fftBuffer[2 * k + 1]));
+        fftBuffer[2 * k] = static_cast<float>(bin.real());
+        fftBuffer[2 * k + 1] = static_cast<float>(bin.imag());
+    }
+
+    fft.performRealOnlyInverseTransform(fftBuffer);
+
+    // The energy is packed at the start, so only the last eighth is faded
+    // to keep the truncation smooth
+    const auto fadeStart = length - length / 8;
+
+    for (int n = 0; n < length; ++n)
+    {
+        const auto fade = n < fadeStart ? 1.0
+                                        : 0.5 + 0.5 * std::cos(juce::MathConstants<double>::pi * (n - fadeStart) / (length - fadeStart));
+        kernel[n] = fftBuffer[n] * static_cast<float>(fade);
+    }
+}
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    FirEngine.h
+    FIR processing engine for the linear and minimum phase modes. The
+    magnitude response of the active cascade sections is sampled on an FFT
+    grid and turned into either a symmetric, windowed kernel (linear phase)
+    or the minimum phase kernel with the same magnitude, found through the
+    real cepstrum. Kernels run through a non-uniformly partitioned
+    convolver, so only one small head partition of latency is added.
+
+    Kernels are designed on a background thread, which keeps the last few
+    in a cache so settings that come back (recalled presets, A/B switches)
+    skip the design. The audio thread only hands over a request, and the
+    convolver crossfades to each new kernel once it is ready. A kernel of
+    another length or phase has another latency, so it is held back until
+    the audio thread restarts the engine on it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterKernels.h"
+#include "NonUniformConvolver.h"
+
+//==============================================================================
+enum class FirPhase
+{
+    linear,
+    minimum
+};
+
+//==============================================================================
+class FirEngine : private juce::Thread
+{
+public:
+    //==============================================================================
+    static constexpr int maxSections = 112;   // the main bands and every band engine band
+    static constexpr int headPartitionSize = 128;
+    static constexpr int minLength = 4096;
+    static constexpr int maxLength = 65536;
+    static constexpr int numCachedKernels = 8;
+
+    // Quantised settings a request was designed from. Requests with equal
+    // keys, lengths and phases are assumed to give the same kernel.
+    using DesignKey = std::array<juce::int64, 10>;
+
+    struct DesignRequest
+    {
+        std::array<BiquadSection<double>, maxSections> sections;
+        int numSections = 0;
+        int length = minLength;
+        FirPhase phase = FirPhase::linear;
+        DesignKey key{};
+    };
+
+    FirEngine();
+    ~FirEngine() override;
+
+    //==============================================================================
+    // Allocates for the longest kernel and designs the first one before
+    // returning, so the engine is audible straight away. Leaves the designer
+    // and the convolver's worker stopped. Not for the audio thread.
+    void prepare(int numChannels, KernelIsa isa, const DesignRequest& initialRequest);
+    void reset();
+
+    // Start and stop the designer and the convolver's worker, which only
+    // need to run while a FIR mode is selected. Requests made while stopped
+    // are designed once started. Not for the audio thread.
+    void start();
+    void stop();
+
+    // Queues a new kernel. Safe on the audio thread, returns false if the
+    // designer is busy reading the last request, in which case the caller
+    // should try again on a later block.
+    bool requestDesign(const DesignRequest& request);
+
+    // Designs and loads the last accepted request on the calling thread, or
+    // waits for the designer if it is already on it. For offline renders,
+    // which must not run a block on a kernel that is still being designed.
+    // Blocks for the whole design, so not for real-time audio.
+    void designPendingNow();
+
+    //==============================================================================
+    template <typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& block) { convolver.process(block); }
+
+    void setNonRealtime(bool isNonRealtime) noexcept { convolver.setNonRealtime(isNonRealtime); }
+
+    // A designed kernel with a new latency waits for restart(), which clears
+    // the history and switches to it without a crossfade. Audio thread only.
+    bool isRestartPending() const noexcept { return convolver.isRestartPending(); }
+    void restart() { convolver.restart(); }
+
+    // Latency of the kernel playing, and what it will be after a restart
+    int getLatencyInSamples() const noexcept { return convolver.getLatencyInSamples(); }
+    int getLatencyAfterRestart() const noexcept { return convolver.getLatencyAfterRestart(); }
+
+    // A linear phase kernel is centred on its middle tap, a minimum phase one
+    // starts at tap zero. Both add one head partition.
+    static constexpr int getLatency(int length, FirPhase phase)
+    {
+        return (phase == FirPhase::linear ? length / 2 : 0) + headPartitionSize;
+    }
+
+    //==============================================================================
+    // Designer cache statistics, for profiling
+    int getCacheHits() const noexcept { return cacheHits.load(); }
+    int getCacheMisses() const noexcept { return cacheMisses.load(); }
+
+private:
+    //==============================================================================
+    struct CacheEntry
+    {
+        DesignKey key{};
+        int length = 0;
+        FirPhase phase = FirPhase::linear;
+        juce::uint32 lastUsed = 0;
+    };
+
+    void run() override;
+    bool loadPendingRequest();
+    void loadRequestedKernel();
+    void designLinearPhase(float* kernel);
+    void designMinimumPhase(float* kernel);
+    void sampleMagnitude(int fftLength);
+    juce::dsp::FFT& getFft(int length);
+
+    NonUniformConvolver convolver;
+    KernelIsa kernelIsa = KernelIsa::scalar;
+
+    // Written by the audio thread under the try-lock, read by the designer
+    juce::SpinLock requestLock;
+    DesignRequest pendingRequest;
+    std::atomic<bool> designPending{ false };
+
+    // Designer state, owned by whichever thread holds designLock
+    juce::CriticalSection designLock;
+    DesignRequest request;
+
+    std::array<std::unique_ptr<juce::dsp::FFT>, 20> ffts;
+    juce::HeapBlock<double> phi, magnitudes;
+    juce::HeapBlock<float> fftBuffer;
+
+    // Least recently used kernels, numCachedKernels * maxLength taps
+    std::array<CacheEntry, numCachedKernels> cacheEntries;
+    juce::HeapBlock<float> cachedKernels;
+    juce::uint32 cacheClock = 0;
+    std::atomic<int> cacheHits{ 0 }, cacheMisses{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FirEngine)
+};
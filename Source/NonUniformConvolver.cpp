@@ -0,0 +1,347 @@
+/*
+  ==============================================================================
+
+    NonUniformConvolver.cpp
+    Implements the head / tail split and the tail worker.
+
+  ==============================================================================
+*/
+
+#include "NonUniformConvolver.h"
+
+//==============================================================================
+NonUniformConvolver::NonUniformConvolver() : juce::Thread("OloEQ Convolution Tail") {}
+
+NonUniformConvolver::~NonUniformConvolver()
+{
+    stopThread(1000);
+}
+
+//==============================================================================
+void NonUniformConvolver::prepare(int newNumChannels, int newHeadPartitionSize, int maxKernelLength)
+{
+    stopThread(1000);
+
+    numChannels = newNumChannels;
+    headPartitionSize = newHeadPartitionSize;
+    tailStep = headPartitionSize * growthFactor;
+    headLength = juce::jmin(maxKernelLength, 2 * tailStep);
+
+    head.prepare(numChannels, headPartitionSize, headLength);
+
+    // Each segment starts at twice its partition size and runs up to where
+    // the next, larger one can start. The last one takes the rest.
+    segments.clear();
+
+    for (int size = tailStep, offset = headLength; offset < maxKernelLength; size *= growthFactor)
+    {
+        auto segment = std::make_unique<Segment>();
+        const auto end = juce::jmin(maxKernelLength, 2 * size * growthFactor);
+
+        segment->offset = offset;
+        segment->length = end - offset;
+        segment->partitionSize = size;
+        segment->convolver.prepare(numChannels, size, segment->length);
+        segment->inputSlots.calloc(static_cast<size_t>(numSlots * numChannels * size));
+        segment->outputSlots.calloc(static_cast<size_t>(numSlots * numChannels * size));
+
+        segments.push_back(std::move(segment));
+        offset = end;
+    }
+
+    streamPosition = 0;
+    deadlineMisses = 0;
+    latency = restartLatency = 0;
+    restartPending = false;
+}
+
+void NonUniformConvolver::start()
+{
+    if (! segments.empty() && ! isThreadRunning())
+        startThread(juce::Thread::Priority::high);
+}
+
+void NonUniformConvolver::stop()
+{
+    stopThread(1000);
+}
+
+void NonUniformConvolver::reset()
+{
+    head.reset();
+
+    // The stream keeps its position, so blocks posted from here on use other
+    // slots than any the worker may still be running. The blocks posted so
+    // far hold the old input and are dropped when the segment is cleared.
+    for (auto& segment : segments)
+    {
+        const auto size = segment->partitionSize;
+
+        // The block being filled is not posted yet, so only this thread
+        // touches it
+        juce::FloatVectorOperations::clear(getSlot(*segment, segment->inputSlots, streamPosition / size),
+                                           numChannels * size);
+
+        segment->resetBlock = segment->posted.load();
+        ++segment->resetsRequested;
+
+        if (tryAcquire(*segment))
+            segment->busy = false;
+    }
+}
+
+void NonUniformConvolver::loadKernel(const float* impulseResponse, int length, int kernelLatency)
+{
+    // While a restart is waiting the old latency still plays, so a newer
+    // kernel with the new one waits for the same restart. Nothing plays
+    // before the first kernel, which starts straight away.
+    const auto newLatency = kernelLatency + headPartitionSize;
+    const auto restart = latency.load() != 0 && newLatency != latency.load();
+
+    if (latency.load() == 0)
+        latency = newLatency;
+
+    head.loadKernel(impulseResponse, juce::jmin(length, headLength), kernelLatency, restart);
+
+    for (auto& segment : segments)
+    {
+        const auto count = juce::jmin(segment->length, length - segment->offset);
+
+        // Segments past the end of a shorter kernel play silence
+        if (count > 0)
+        {
+            segment->convolver.loadKernel(impulseResponse + segment->offset, count, 0, restart);
+        }
+        else
+        {
+            const float silence = 0.f;
+            segment->convolver.loadKernel(&silence, 1, 0, restart);
+        }
+    }
+
+    // A kernel back at the playing latency replaces one still waiting, so
+    // that restart is off
+    restartLatency = newLatency;
+    restartPending = restart;
+}
+
+void NonUniformConvolver::restart()
+{
+    if (! restartPending.exchange(false))
+        return;
+
+    // Every block run from here on holds only new input, so whichever
+    // thread runs it can take the new kernel with it
+    reset();
+    latency = restartLatency.load();
+
+    head.allowRestart();
+
+    for (auto& segment : segments)
+        segment->convolver.allowRestart();
+}
+
+//==============================================================================
+template <typename SampleType>
+void NonUniformConvolver::process(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto channelsToProcess = juce::jmin(numChannels, static_cast<int>(block.getNumChannels()));
+
+    for (int start = 0; start < numSamples;)
+    {
+        auto length = numSamples - start;
+
+        if (! segments.empty())
+        {
+            // Keep each chunk inside one input block and one output block of
+            // every segment. Output runs one head partition behind the input.
+            const auto outputPhase = (streamPosition - headPartitionSize) % tailStep;
+            const auto toInputBoundary = tailStep - static_cast<int>(streamPosition % tailStep);
+            const auto toOutputBoundary = tailStep - static_cast<int>(outputPhase < 0 ? outputPhase + tailStep : outputPhase);
+
+            length = juce::jmin(length, toInputBoundary, toOutputBoundary);
+        }
+
+        const auto chunk = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length));
+
+        // The tails need the dry input, so take it before the head runs in place
+        for (auto& segment : segments)
+        {
+            const auto size = segment->partitionSize;
+            auto* slot = getSlot(*segment, segment->inputSlots, streamPosition / size)
+                       + static_cast<int>(streamPosition % size);
+
+            for (int channel = 0; channel < channelsToProcess; ++channel)
+            {
+                const auto* samples = chunk.getChannelPointer(static_cast<size_t>(channel));
+
+                for (int n = 0; n < length; ++n)
+                    slot[channel * size + n] = static_cast<float>(samples[n]);
+            }
+        }
+
+        head.process(chunk);
+
+        const auto outputPosition = streamPosition - headPartitionSize;
+
+        if (outputPosition >= 0)
+        {
+            for (auto& segment : segments)
+            {
+                // Output block k of a segment comes from input block k - 2
+                const auto size = segment->partitionSize;
+                const auto inputBlock = outputPosition / size - 2;
+
+                if (inputBlock < 0 || ! isBlockReady(*segment, inputBlock))
+                    continue;
+
+                const auto* slot = getSlot(*segment, segment->outputSlots, inputBlock)
+                                 + static_cast<int>(outputPosition % size);
+
+                for (int channel = 0; channel < channelsToProcess; ++channel)
+                {
+                    auto* samples = chunk.getChannelPointer(static_cast<size_t>(channel));
+
+                    for (int n = 0; n < length; ++n)
+                        samples[n] += static_cast<SampleType>(slot[channel * size + n]);
+                }
+            }
+        }
+
+        streamPosition += length;
+        start += length;
+
+        auto anyPosted = false;
+
+        for (auto& segment : segments)
+        {
+            if (streamPosition % segment->partitionSize == 0)
+            {
+                segment->posted = streamPosition / segment->partitionSize - 1;
+                anyPosted = true;
+            }
+        }
+
+        // At most once per smallest tail partition
+        if (anyPosted)
+            notify();
+    }
+}
+
+bool NonUniformConvolver::isBlockReady(Segment& segment, juce::int64 block)
+{
+    // Blocks completed before a pending reset hold old output
+    if (! segment.isResetPending() && segment.completed.load() >= block)
+        return true;
+
+    // The worker is behind. If it is not inside this segment right now, run
+    // the late blocks here rather than dropping them.
+    for (;;)
+    {
+        if (runBlocks(segment, block))
+            return true;
+
+        if (! nonRealtime.load())
+        {
+            ++deadlineMisses;
+            return false;
+        }
+
+        juce::Thread::yield();
+
+        if (! segment.isResetPending() && segment.completed.load() >= block)
+            return true;
+    }
+}
+
+//==============================================================================
+void NonUniformConvolver::run()
+{
+    while (! threadShouldExit())
+    {
+        // Earliest deadline first across the segments with a block waiting
+        Segment* next = nullptr;
+        auto earliestDeadline = std::numeric_limits<juce::int64>::max();
+
+        for (auto& segment : segments)
+        {
+            const auto block = segment->completed.load() + 1;
+
+            if (block > segment->posted.load() && ! segment->isResetPending())
+                continue;
+
+            const auto deadline = (block + 2) * segment->partitionSize;
+
+            if (deadline < earliestDeadline)
+            {
+                earliestDeadline = deadline;
+                next = segment.get();
+            }
+        }
+
+        // Sleeps until process() posts a block. Waking the worker takes the
+        // event's lock for as long as it takes to set it, which the audio
+        // thread can afford once per tail partition.
+        if (next == nullptr)
+            wait(-1);
+        else
+            runBlocks(*next, next->completed.load() + 1);
+    }
+}
+
+bool NonUniformConvolver::tryAcquire(Segment& segment)
+{
+    auto expected = false;
+
+    if (! segment.busy.compare_exchange_strong(expected, true))
+        return false;
+
+    // Clear a reset that came in while another thread held the segment. The
+    // blocks posted before it are skipped, and their slots can hold no
+    // newer output, since nothing runs a block before this.
+    const auto requested = segment.resetsRequested.load();
+
+    if (requested != segment.resetsHandled.load())
+    {
+        const auto resetBlock = segment.resetBlock.load();
+
+        segment.convolver.reset();
+        juce::FloatVectorOperations::clear(segment.outputSlots.get(), numSlots * numChannels * segment.partitionSize);
+
+        if (segment.completed.load() < resetBlock)
+            segment.completed = resetBlock;
+
+        segment.resetsHandled = requested;
+    }
+
+    return true;
+}
+
+bool NonUniformConvolver::runBlocks(Segment& segment, juce::int64 lastBlock)
+{
+    if (! tryAcquire(segment))
+        return false;
+
+    // Re-read under busy, the audio thread may have posted more meanwhile
+    lastBlock = juce::jmin(lastBlock, segment.posted.load());
+
+    for (auto block = segment.completed.load() + 1; block <= lastBlock; ++block)
+    {
+        segment.convolver.processPartition(getSlot(segment, segment.inputSlots, block),
+                                           getSlot(segment, segment.outputSlots, block));
+        segment.completed = block;
+    }
+
+    segment.busy = false;
+    return true;
+}
+
+float* NonUniformConvolver::getSlot(const Segment& segment, const juce::HeapBlock<float>& slots, juce::int64 block) const
+{
+    return slots + static_cast<int>(block % numSlots) * numChannels * segment.partitionSize;
+}
+
+//==============================================================================
+template void NonUniformConvolver::process<float>(const juce::dsp::AudioBlock<float>&);
+template void NonUniformConvolver::process<double>(const juce::dsp::AudioBlock<double>&);
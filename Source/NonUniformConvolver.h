@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    NonUniformConvolver.h
+    Non-uniformly partitioned convolution for long kernels at low latency.
+    The start of the kernel runs on the audio thread with small partitions,
+    so the only added latency is one head partition. The rest is split into
+    segments whose partitions grow by growthFactor each time, and these run
+    on a background worker.
+
+    Segment i has partition size B and starts at tap 2B, so each of its
+    blocks is due one whole block period after its input is complete. The
+    worker always runs the waiting block with the earliest deadline. If it
+    falls behind, the audio thread runs the block itself once it is due.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+class NonUniformConvolver : private juce::Thread
+{
+public:
+    //==============================================================================
+    static constexpr int growthFactor = 8;
+
+    NonUniformConvolver();
+    ~NonUniformConvolver() override;
+
+    //==============================================================================
+    // Lays out the segments for kernels up to maxKernelLength taps, with the
+    // worker stopped. Not for the audio thread.
+    void prepare(int numChannels, int headPartitionSize, int maxKernelLength);
+
+    // The worker only needs to run while the convolver is in use. While it is
+    // stopped, the audio thread runs each tail block itself once it is due.
+    // Not for the audio thread.
+    void start();
+    void stop();
+
+    // Clears all history without waiting for the worker. A segment the
+    // worker holds is cleared by whichever thread takes it next, before it
+    // runs another block.
+    void reset();
+
+    // Same contract as PartitionedConvolver::loadKernel. Each segment picks up
+    // its part at its own next partition boundary, with a crossfade. A kernel
+    // with another latency than the one playing cannot be crossfaded to, as
+    // the parts would switch at different times and the old and new delays
+    // would overlap, so it waits for restart().
+    void loadKernel(const float* impulseResponse, int length, int latency);
+
+    // Switches to a kernel waiting for a restart: clears the history, as
+    // reset() does, and has every part pick up the new kernel without a
+    // crossfade. Does nothing if none is waiting. Audio thread only.
+    void restart();
+    bool isRestartPending() const noexcept { return restartPending.load(); }
+
+    //==============================================================================
+    template <typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& block);
+
+    // When rendering offline the host runs faster than real time, so the
+    // audio thread waits for late tail blocks instead of dropping them
+    void setNonRealtime(bool shouldWait) noexcept { nonRealtime = shouldWait; }
+
+    //==============================================================================
+    // Latency of the playing kernel plus one head partition, and what it
+    // will be after a pending restart
+    int getLatencyInSamples() const noexcept { return latency.load(); }
+    int getLatencyAfterRestart() const noexcept { return isRestartPending() ? restartLatency.load() : latency.load(); }
+
+    // Times part of a tail block was dropped because it was not ready in time
+    int getDeadlineMisses() const noexcept { return deadlineMisses.load(); }
+
+private:
+    //==============================================================================
+    // Block b of a segment is posted once its input is complete and is due
+    // two blocks later. Blocks run strictly in order, by whichever thread
+    // holds busy.
+    struct Segment
+    {
+        PartitionedConvolver convolver;
+        int offset = 0, length = 0, partitionSize = 0;
+
+        // numSlots blocks of partitionSize samples per channel
+        juce::HeapBlock<float> inputSlots, outputSlots;
+
+        std::atomic<juce::int64> posted{ -1 }, completed{ -1 };
+        std::atomic<bool> busy{ false };
+
+        // reset() bumps resetsRequested after storing the last block posted
+        // before it, the thread holding busy catches resetsHandled up
+        std::atomic<juce::int64> resetBlock{ -1 };
+        std::atomic<int> resetsRequested{ 0 }, resetsHandled{ 0 };
+
+        bool isResetPending() const noexcept { return resetsRequested.load() != resetsHandled.load(); }
+    };
+
+    static constexpr int numSlots = 3;
+
+    void run() override;
+    bool tryAcquire(Segment& segment);
+    bool runBlocks(Segment& segment, juce::int64 lastBlock);
+    bool isBlockReady(Segment& segment, juce::int64 block);
+
+    float* getSlot(const Segment& segment, const juce::HeapBlock<float>& slots, juce::int64 block) const;
+
+    //==============================================================================
+    PartitionedConvolver head;
+    std::vector<std::unique_ptr<Segment>> segments;
+
+    // The head covers taps [0, headLength), tail boundaries fall on multiples
+    // of tailStep, the smallest tail partition
+    int numChannels = 0, headPartitionSize = 0, headLength = 0, tailStep = 0;
+    juce::int64 streamPosition = 0;
+
+    std::atomic<bool> nonRealtime{ false };
+    std::atomic<int> deadlineMisses{ 0 };
+
+    // The loader sets restartLatency before restartPending
+    std::atomic<int> latency{ 0 }, restartLatency{ 0 };
+    std::atomic<bool> restartPending{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NonUniformConvolver)
+};
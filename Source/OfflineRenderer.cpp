@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Implements the chunked offline renderer.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+    // Corrections run in steps of this many samples, and stop once the
+    // state has fallen this far below the precision of where it started
+    constexpr int correctionStepLength = 1024;
+    constexpr double decayThreshold = 1.0e-4;
+
+    // Runs task(0) to task(numTasks - 1) on a pool of numThreads threads
+    // and returns once all of them are done
+    template <typename Task>
+    void runInParallel(int numThreads, int numTasks, Task&& task)
+    {
+        juce::ThreadPool pool(juce::jlimit(1, numTasks, numThreads));
+        juce::WaitableEvent finished;
+        std::atomic<int> remaining{ numTasks };
+
+        for (int i = 0; i < numTasks; ++i)
+        {
+            pool.addJob([i, &task, &remaining, &finished]
+            {
+                task(i);
+
+                if (--remaining == 0)
+                    finished.signal();
+            });
+        }
+
+        finished.wait();
+    }
+
+    template <typename SampleType>
+    SampleType getMaxMagnitude(const std::vector<SampleType>& values)
+    {
+        auto magnitude = SampleType(0);
+
+        for (auto value : values)
+            magnitude = juce::jmax(magnitude, std::abs(value));
+
+        return magnitude;
+    }
+
+    // The power of two whose inverse brings the smallest nonzero value up to
+    // unit size, limited so the largest keeps half the exponent range spare
+    template <typename SampleType>
+    int getScaleExponent(const std::vector<SampleType>& values)
+    {
+        auto smallest = std::numeric_limits<SampleType>::max();
+        auto largest = SampleType(0);
+
+        for (auto value : values)
+        {
+            if (value != SampleType(0))
+            {
+                smallest = juce::jmin(smallest, std::abs(value));
+                largest = juce::jmax(largest, std::abs(value));
+            }
+        }
+
+        if (largest == SampleType(0))
+            return 0;
+
+        int smallestExponent = 0, largestExponent = 0;
+        std::frexp(smallest, &smallestExponent);
+        std::frexp(largest, &largestExponent);
+
+        return juce::jmax(smallestExponent, largestExponent - std::numeric_limits<SampleType>::max_exponent / 2);
+    }
+
+    //==============================================================================
+    // The cascade laid out for the blocked kernel, with the state of one
+    // channel stored two values per section
+    template <typename SampleType>
+    struct BlockedCascade
+    {
+        BlockedCascade(const BiquadSection<SampleType>* sections, int numSections, KernelIsa isa)
+            : kernels(getFilterKernels<SampleType>(isa)),
+              matrixSize(getBlockMatrixSize(kernels.laneWidth)),
+              matrices(static_cast<size_t>(numSections * matrixSize)),
+              slots(static_cast<size_t>(numSections))
+        {
+            for (int i = 0; i < numSections; ++i)
+                designBlockMatrices(sections[i], kernels.laneWidth, matrices.data() + i * matrixSize);
+
+            std::iota(slots.begin(), slots.end(), 0);
+        }
+
+        int getStateSize() const { return 2 * static_cast<int>(slots.size()); }
+
+        void process(SampleType* samples, int numSamples, SampleType* state) const
+        {
+            kernels.processBlocked(matrices.data(), state, samples, numSamples, 1, slots.data(), static_cast<int>(slots.size()));
+        }
+
+        // Adds the response to the state with no input, leaving the state
+        // it ends in, which is zero once the response has died away. The
+        // kernel snaps small states to zero, which would cut the slower
+        // sections' responses short, so before every step the state is
+        // scaled by a power of two that brings its smallest value up to
+        // unit size and the scale is put back on the output.
+        void addZeroInputResponse(SampleType* samples, int numSamples, std::vector<SampleType>& state,
+                                  std::vector<SampleType>& scratch) const
+        {
+            const auto threshold = getMaxMagnitude(state) * std::numeric_limits<SampleType>::epsilon() * decayThreshold;
+            auto scale = SampleType(1);
+
+            for (int start = 0; start < numSamples; start += correctionStepLength)
+            {
+                const auto magnitude = getMaxMagnitude(state);
+
+                if (magnitude * scale <= threshold)
+                {
+                    std::fill(state.begin(), state.end(), SampleType(0));
+                    return;
+                }
+
+                const auto exponent = getScaleExponent(state);
+
+                for (auto& value : state)
+                    value = std::ldexp(value, -exponent);
+
+                scale = std::ldexp(scale, exponent);
+
+                const auto length = juce::jmin(correctionStepLength, numSamples - start);
+
+                std::fill_n(scratch.begin(), length, SampleType(0));
+                process(scratch.data(), length, state.data());
+                juce::FloatVectorOperations::addWithMultiply(samples + start, scratch.data(), scale, length);
+            }
+
+            for (auto& value : state)
+                value *= scale;
+        }
+
+        const FilterKernels<SampleType>& kernels;
+        const int matrixSize;
+        std::vector<SampleType> matrices;
+        std::vector<int> slots;
+    };
+}
+
+//==============================================================================
+template <typename SampleType>
+void renderCascadeOffline(const BiquadSection<SampleType>* sections, int numSections, juce::AudioBuffer<SampleType>& buffer,
+                          KernelIsa isa, int numThreads)
+{
+    const auto numChannels = buffer.getNumChannels();
+    const auto numSamples = buffer.getNumSamples();
+
+    if (numSections == 0 || numChannels == 0 || numSamples == 0)
+        return;
+
+    const BlockedCascade<SampleType> cascade(sections, numSections, isa);
+    const auto stateSize = cascade.getStateSize();
+
+    // Enough chunks to give every thread one, unless that makes them short
+    const auto maxChunks = juce::jmax(1, numSamples / minOfflineChunkLength);
+    const auto numChunks = juce::jlimit(1, maxChunks, (numThreads + numChannels - 1) / numChannels);
+    const auto chunkLength = (numSamples + numChunks - 1) / numChunks;
+
+    // The state each chunk ends in, first from zero state and then, once
+    // corrected, from the true one
+    std::vector<SampleType> endStates(static_cast<size_t>(numChannels * numChunks * stateSize));
+
+    auto getChunk = [&](int chunk)
+    {
+        const auto start = chunk * chunkLength;
+        return std::make_pair(start, juce::jmax(0, juce::jmin(chunkLength, numSamples - start)));
+    };
+
+    runInParallel(numThreads, numChannels * numChunks, [&](int task)
+    {
+        const auto channel = task / numChunks;
+        const auto [start, length] = getChunk(task % numChunks);
+
+        cascade.process(buffer.getWritePointer(channel, start), length, endStates.data() + task * stateSize);
+    });
+
+    if (numChunks == 1)
+        return;
+
+    // Each chunk starts where the last one ended, so the corrections run in
+    // order within a channel. Channels are independent.
+    runInParallel(numThreads, numChannels, [&](int channel)
+    {
+        std::vector<SampleType> state(static_cast<size_t>(stateSize)), scratch(static_cast<size_t>(correctionStepLength));
+        auto* channelStates = endStates.data() + channel * numChunks * stateSize;
+
+        for (int chunk = 1; chunk < numChunks; ++chunk)
+        {
+            const auto [start, length] = getChunk(chunk);
+            auto* endState = channelStates + chunk * stateSize;
+
+            std::copy_n(endState - stateSize, stateSize, state.begin());
+            cascade.addZeroInputResponse(buffer.getWritePointer(channel, start), length, state, scratch);
+
+            for (int i = 0; i < stateSize; ++i)
+                endState[i] += state[static_cast<size_t>(i)];
+        }
+    });
+}
+
+template <typename SampleType>
+void renderChainOffline(const ChainSettings& chainSettings, double sampleRate, juce::AudioBuffer<SampleType>& buffer)
+{
+    const auto design = makeCascadeDesign<SampleType>(chainSettings, sampleRate);
+
+    std::vector<BiquadSection<SampleType>> sections;
+
+    for (size_t slot = 0; slot < design.sections.size(); ++slot)
+        if (design.active[slot])
+            sections.push_back(design.sections[slot]);
+
+    renderCascadeOffline(sections.data(), static_cast<int>(sections.size()), buffer, getWidestKernelIsa<SampleType>(),
+                         juce::SystemStats::getNumCpus());
+}
+
+//==============================================================================
+template void renderCascadeOffline<float>(const BiquadSection<float>*, int, juce::AudioBuffer<float>&, KernelIsa, int);
+template void renderCascadeOffline<double>(const BiquadSection<double>*, int, juce::AudioBuffer<double>&, KernelIsa, int);
+template void renderChainOffline<float>(const ChainSettings&, double, juce::AudioBuffer<float>&);
+template void renderChainOffline<double>(const ChainSettings&, double, juce::AudioBuffer<double>&);
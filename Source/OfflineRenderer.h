@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Renders whole files through a biquad cascade on every core. A channel is
+    split into chunks that are filtered in parallel, each from zero state.
+    Filtering is linear, so a chunk's true output is that plus the response
+    of the cascade, with no input, to the state the previous chunk ended
+    in. The corrections then run chunk by chunk, each only until the
+    response has died away, which for any stable cascade is far shorter
+    than a chunk. The result matches sequential processing to rounding.
+
+    For headless rendering, the plugin itself streams and never calls this.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterKernels.h"
+
+struct ChainSettings;
+
+//==============================================================================
+// Chunks are never shorter than this, so the corrections stay a small
+// fraction of the work
+constexpr int minOfflineChunkLength = 1 << 16;
+
+// Filters every channel of the buffer in place through the sections, from
+// zero state, using up to numThreads threads and the time-blocked kernel
+// of the given instruction set
+template <typename SampleType>
+void renderCascadeOffline(const BiquadSection<SampleType>* sections, int numSections, juce::AudioBuffer<SampleType>& buffer,
+                          KernelIsa isa, int numThreads);
+
+// The same for the plugin's chain at the given sample rate, on every core
+// with the widest supported kernel
+template <typename SampleType>
+void renderChainOffline(const ChainSettings& chainSettings, double sampleRate, juce::AudioBuffer<SampleType>& buffer);
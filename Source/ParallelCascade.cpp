@@ -0,0 +1,328 @@
+/*
+  ==============================================================================
+
+    ParallelCascade.cpp
+    Implements the partial fraction expansion, its background designer and
+    the parallel form processor.
+
+  ==============================================================================
+*/
+
+#include "ParallelCascade.h"
+
+namespace
+{
+    using Complex = std::complex<double>;
+
+    // Frequencies the expansion is checked at, log spaced up to Nyquist from
+    // well below 20 Hz at the highest oversampled rate
+    constexpr int numCheckPoints = 128;
+    constexpr double lowestCheckFrequency = 1.0e-5;
+    constexpr double errorFloor = 1.0e-3;
+
+    bool isFirstOrder(const BiquadSection<double>& s) { return s.a2 == 0.0 && s.b2 == 0.0; }
+
+    // Numerator and denominator as polynomials in z rather than z^-1
+    Complex evaluateNumerator(const BiquadSection<double>& s, Complex z)
+    {
+        return isFirstOrder(s) ? s.b0 * z + s.b1 : (s.b0 * z + s.b1) * z + s.b2;
+    }
+
+    Complex evaluateDenominator(const BiquadSection<double>& s, Complex z)
+    {
+        return isFirstOrder(s) ? z + s.a1 : (z + s.a1) * z + s.a2;
+    }
+
+    int findPoles(const BiquadSection<double>& s, Complex* poles)
+    {
+        if (isFirstOrder(s))
+        {
+            poles[0] = -s.a1;
+            return 1;
+        }
+
+        const auto root = std::sqrt(Complex(s.a1 * s.a1 - 4.0 * s.a2));
+        poles[0] = 0.5 * (-s.a1 + root);
+        poles[1] = 0.5 * (-s.a1 - root);
+        return 2;
+    }
+
+    double getExpansionError(const BiquadSection<double>* sections, int numSections, const ParallelExpansion& expansion)
+    {
+        auto worst = 0.0;
+
+        for (int i = 0; i < numCheckPoints; ++i)
+        {
+            const auto w = juce::MathConstants<double>::pi * std::pow(lowestCheckFrequency, 1.0 - i / (numCheckPoints - 1.0));
+            const auto z = std::polar(1.0, w);
+            const auto zInv = 1.0 / z;
+
+            Complex serial(1.0);
+
+            for (int k = 0; k < numSections; ++k)
+                serial *= evaluateNumerator(sections[k], z) / evaluateDenominator(sections[k], z);
+
+            Complex parallel(expansion.direct);
+
+            for (int k = 0; k < expansion.numBranches; ++k)
+            {
+                const auto& b = expansion.branches[static_cast<size_t>(k)];
+                parallel += (b.c0 + b.c1 * zInv) / (1.0 + (b.a1 + b.a2 * zInv) * zInv);
+            }
+
+            worst = juce::jmax(worst, std::abs(parallel - serial) / juce::jmax(std::abs(serial), errorFloor));
+        }
+
+        return worst;
+    }
+}
+
+//==============================================================================
+ParallelExpansion expandCascade(const BiquadSection<double>* sections, const int* ids, int numSections)
+{
+    jassert(numSections <= ParallelExpansion::maxBranches);
+
+    ParallelExpansion expansion;
+    expansion.numBranches = juce::jmin(numSections, ParallelExpansion::maxBranches);
+
+    // H(z) = d + sum_p r_p / (1 - p z^-1), where r_p is the residue of
+    // H(z) / z at the pole p, and d follows from H at z^-1 = 0
+    auto direct = 1.0;
+
+    for (int k = 0; k < expansion.numBranches; ++k)
+        direct *= sections[k].b0;
+
+    for (int k = 0; k < expansion.numBranches; ++k)
+    {
+        const auto& section = sections[k];
+
+        Complex poles[2], residues[2];
+        const auto numPoles = findPoles(section, poles);
+
+        for (int j = 0; j < numPoles; ++j)
+        {
+            const auto p = poles[j];
+            auto residue = evaluateNumerator(section, p) / p;
+
+            for (int i = 0; i < expansion.numBranches; ++i)
+                if (i != k)
+                    residue *= evaluateNumerator(sections[i], p) / evaluateDenominator(sections[i], p);
+
+            if (numPoles == 2)
+                residue /= p - poles[1 - j];
+
+            residues[j] = residue;
+        }
+
+        // Conjugate or real pairs give real coefficients, the imaginary
+        // parts left over are rounding
+        auto& branch = expansion.branches[static_cast<size_t>(k)];
+        branch.c0 = numPoles == 2 ? (residues[0] + residues[1]).real() : residues[0].real();
+        branch.c1 = numPoles == 2 ? -(residues[0] * poles[1] + residues[1] * poles[0]).real() : 0.0;
+        branch.a1 = section.a1;
+        branch.a2 = section.a2;
+        branch.id = ids[k];
+
+        direct -= branch.c0;
+    }
+
+    expansion.direct = direct;
+
+    const auto error = getExpansionError(sections, expansion.numBranches, expansion);
+    expansion.valid = std::isfinite(error) && error <= maxExpansionError;
+
+    return expansion;
+}
+
+//==============================================================================
+ParallelDesigner::ParallelDesigner() : juce::Thread("OloEQ Parallel Designer") {}
+
+ParallelDesigner::~ParallelDesigner()
+{
+    stopThread(1000);
+}
+
+void ParallelDesigner::prepare()
+{
+    stopThread(1000);
+
+    requestPending = false;
+    resultReady = false;
+}
+
+void ParallelDesigner::start()
+{
+    if (! isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+void ParallelDesigner::stop()
+{
+    stopThread(1000);
+}
+
+ParallelDesigner::Result ParallelDesigner::expand(const Request& request)
+{
+    Result result;
+    result.generation = request.generation;
+
+    for (size_t path = 0; path < numPaths; ++path)
+        result.expansions[path] = expandCascade(request.sections[path].data(), request.ids[path].data(), request.numSections[path]);
+
+    return result;
+}
+
+bool ParallelDesigner::requestExpansion(const Request& request)
+{
+    {
+        const juce::SpinLock::ScopedTryLockType lock(requestLock);
+
+        if (! lock.isLocked())
+            return false;
+
+        pendingRequest = request;
+        requestPending = true;
+    }
+
+    notify();
+    return true;
+}
+
+bool ParallelDesigner::takeResult(Result& result)
+{
+    if (! resultReady.load())
+        return false;
+
+    const juce::SpinLock::ScopedTryLockType lock(resultLock);
+
+    if (! lock.isLocked())
+        return false;
+
+    result = readyResult;
+    resultReady = false;
+    return true;
+}
+
+void ParallelDesigner::run()
+{
+    Request request;
+
+    while (! threadShouldExit())
+    {
+        // Sleeps until requestExpansion wakes it, like the FIR designer. A
+        // wake per control-rate update is as often as the audio thread does it.
+        if (! requestPending.exchange(false))
+        {
+            wait(-1);
+            continue;
+        }
+
+        {
+            const juce::SpinLock::ScopedLockType lock(requestLock);
+            request = pendingRequest;
+        }
+
+        const auto result = expand(request);
+
+        const juce::SpinLock::ScopedLockType lock(resultLock);
+        readyResult = result;
+        resultReady = true;
+    }
+}
+
+//==============================================================================
+void ParallelCascade::prepare(int numChannels, int newMaxBlockSize, KernelIsa isa)
+{
+    kernels = &getFilterKernels<double>(isa);
+    maxBlockSize = newMaxBlockSize;
+
+    channels.assign(static_cast<size_t>(numChannels), Channel{});
+    numInvalidChannels = 0;
+
+    coefficients.calloc(static_cast<size_t>(numChannels * 4 * rowLength));
+    state.calloc(static_cast<size_t>(numChannels * 2 * rowLength));
+    input.calloc(static_cast<size_t>(maxBlockSize));
+}
+
+void ParallelCascade::reset()
+{
+    juce::FloatVectorOperations::clear(state.get(), getNumChannels() * 2 * rowLength);
+}
+
+void ParallelCascade::setExpansion(int channel, const ParallelExpansion& expansion)
+{
+    jassert(juce::isPositiveAndBelow(channel, getNumChannels()));
+
+    auto& ch = channels[static_cast<size_t>(channel)];
+    auto* c = coefficients + channel * 4 * rowLength;
+    auto* s = state + channel * 2 * rowLength;
+
+    // Rows are packed numLanes apart, as the kernel reads them, so move each
+    // branch's state to its new lane by id before the rows are rewritten
+    std::array<double, 2 * rowLength> previous;
+    std::copy_n(s, 2 * rowLength, previous.begin());
+    juce::FloatVectorOperations::clear(c, 4 * rowLength);
+    juce::FloatVectorOperations::clear(s, 2 * rowLength);
+
+    const auto width = kernels->laneWidth;
+    const auto numBranches = expansion.numBranches;
+    const auto numLanes = ((numBranches + width - 1) / width) * width;
+
+    for (int lane = 0; lane < numBranches; ++lane)
+    {
+        const auto& branch = expansion.branches[static_cast<size_t>(lane)];
+
+        c[lane]                = branch.c0;
+        c[numLanes + lane]     = branch.c1;
+        c[2 * numLanes + lane] = branch.a1;
+        c[3 * numLanes + lane] = branch.a2;
+
+        for (int old = 0; old < ch.numBranches; ++old)
+        {
+            if (ch.ids[static_cast<size_t>(old)] == branch.id)
+            {
+                s[lane]            = previous[static_cast<size_t>(old)];
+                s[numLanes + lane] = previous[static_cast<size_t>(ch.numLanes + old)];
+                break;
+            }
+        }
+
+        ch.ids[static_cast<size_t>(lane)] = branch.id;
+    }
+
+    numInvalidChannels += (expansion.valid ? 0 : 1) - (ch.valid ? 0 : 1);
+
+    ch.numBranches = numBranches;
+    ch.numLanes = numLanes;
+    ch.direct = expansion.direct;
+    ch.valid = expansion.valid;
+}
+
+//==============================================================================
+void ParallelCascade::process(const juce::dsp::AudioBlock<double>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto channelsToProcess = juce::jmin(getNumChannels(), static_cast<int>(block.getNumChannels()));
+
+    jassert(maxBlockSize > 0);
+
+    if (numSamples == 0 || maxBlockSize == 0)
+        return;
+
+    // The kernel writes its output over the block, so the input is copied
+    // aside first. Hosts may exceed the announced block size.
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const auto length = juce::jmin(maxBlockSize, numSamples - start);
+
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+        {
+            const auto& ch = channels[static_cast<size_t>(channel)];
+            auto* samples = block.getChannelPointer(static_cast<size_t>(channel)) + start;
+
+            juce::FloatVectorOperations::copy(input.get(), samples, length);
+            kernels->processParallel(coefficients + channel * 4 * rowLength, state + channel * 2 * rowLength,
+                                     input, samples, length, ch.numLanes, ch.direct);
+        }
+    }
+}
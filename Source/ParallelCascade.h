@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    ParallelCascade.h
+    Parallel form realisation of a biquad cascade. The cascade's transfer
+    function is expanded into partial fractions, a direct gain plus one
+    branch per section that keeps that section's denominator:
+
+        H(z) = d + sum_k (c0_k + c1_k z^-1) / (1 + a1_k z^-1 + a2_k z^-2)
+
+    Every branch sees the same input, so a channel's branches run side by
+    side in the SIMD lanes rather than each section waiting on the one
+    before it. Branches are tagged with the slot of the section they came
+    from, so their state carries over as parameters move and sections come
+    and go.
+
+    Expansions are computed on a background thread. Clustered low
+    frequency poles make the branches cancel each other, which costs up to
+    50 dB of accuracy in float, so the expansion is always built and run
+    in double. Poles that coincide (a low and high cut at the same
+    frequency and order) have no expansion at all. Every expansion is
+    therefore checked against the serial response, and ones that miss it
+    are flagged invalid so the caller can keep the serial cascade.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterKernels.h"
+
+//==============================================================================
+struct ParallelExpansion
+{
+    static constexpr int maxBranches = 16;
+
+    struct Branch
+    {
+        double c0 = 0.0, c1 = 0.0, a1 = 0.0, a2 = 0.0;
+        int id = -1;
+    };
+
+    // The empty expansion is the identity
+    std::array<Branch, maxBranches> branches;
+    int numBranches = 0;
+    double direct = 1.0;
+    bool valid = true;
+};
+
+// Largest response error an expansion may have, relative to the serial
+// response or to -60 dB, whichever is larger
+constexpr double maxExpansionError = 1.0e-6;
+
+// Expands a cascade of stable sections, tagging each branch with the
+// section's id. Not for the audio thread.
+ParallelExpansion expandCascade(const BiquadSection<double>* sections, const int* ids, int numSections);
+
+//==============================================================================
+// Expands cascades on a background thread. The audio thread posts the
+// sections of up to two paths and later picks up their expansions, both
+// without waiting on the designer.
+class ParallelDesigner : private juce::Thread
+{
+public:
+    //==============================================================================
+    static constexpr int numPaths = 2;
+
+    struct Request
+    {
+        std::array<std::array<BiquadSection<double>, ParallelExpansion::maxBranches>, numPaths> sections;
+        std::array<std::array<int, ParallelExpansion::maxBranches>, numPaths> ids;
+        std::array<int, numPaths> numSections{};
+        juce::uint32 generation = 0;
+    };
+
+    struct Result
+    {
+        std::array<ParallelExpansion, numPaths> expansions;
+        juce::uint32 generation = 0;
+    };
+
+    ParallelDesigner();
+    ~ParallelDesigner() override;
+
+    // Drops any request or result left over, with the thread stopped. Not
+    // for the audio thread.
+    void prepare();
+
+    // Start and stop the designer thread, which only needs to run while the
+    // parallel mode is selected. Requests made while stopped are expanded
+    // once started. Not for the audio thread.
+    void start();
+    void stop();
+
+    // Expands a request on the calling thread, for callers that need the
+    // result straight away
+    static Result expand(const Request& request);
+
+    //==============================================================================
+    // Both return false rather than wait when the designer holds the lock,
+    // in which case the caller should try again later
+    bool requestExpansion(const Request& request);
+    bool takeResult(Result& result);
+
+private:
+    //==============================================================================
+    void run() override;
+
+    // Written by the audio thread under the try-lock, read by the designer
+    juce::SpinLock requestLock;
+    Request pendingRequest;
+    std::atomic<bool> requestPending{ false };
+
+    // Written by the designer, read by the audio thread under the try-lock
+    juce::SpinLock resultLock;
+    Result readyResult;
+    std::atomic<bool> resultReady{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParallelDesigner)
+};
+
+//==============================================================================
+// Runs one expansion per channel through the dispatched parallel kernel, in
+// double
+class ParallelCascade
+{
+public:
+    //==============================================================================
+    // Must not be called on the audio thread. Channels start as the identity.
+    void prepare(int numChannels, int maxBlockSize, KernelIsa isa);
+    void reset();
+
+    // Loads a channel's expansion. A branch keeps the state of the branch
+    // with the same id in the previous expansion, new branches start clean.
+    void setExpansion(int channel, const ParallelExpansion& expansion);
+
+    // False while any channel holds an invalid expansion
+    bool isValid() const noexcept { return numInvalidChannels == 0; }
+
+    //==============================================================================
+    // Processes the first getNumChannels() channels of the block in place
+    void process(const juce::dsp::AudioBlock<double>& block);
+
+    int getNumChannels() const noexcept { return static_cast<int>(channels.size()); }
+
+private:
+    //==============================================================================
+    // Space for each channel's rows, which are packed numLanes apart
+    static constexpr int rowLength = ParallelExpansion::maxBranches;
+
+    struct Channel
+    {
+        std::array<int, ParallelExpansion::maxBranches> ids;
+        int numBranches = 0, numLanes = 0;
+        double direct = 1.0;
+        bool valid = true;
+    };
+
+    const FilterKernels<double>* kernels = &getFilterKernels<double>(KernelIsa::scalar);
+
+    std::vector<Channel> channels;
+    int maxBlockSize = 0, numInvalidChannels = 0;
+
+    // Per channel, four coefficient rows then two state rows
+    juce::HeapBlock<double> coefficients, state, input;
+
+    JUCE_LEAK_DETECTOR(ParallelCascade)
+};
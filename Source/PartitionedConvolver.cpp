@@ -0,0 +1,314 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+    Implements the uniformly partitioned overlap-save convolver.
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+namespace
+{
+    constexpr juce::uint32 busyMask = 0xff;
+    constexpr int readyShift = 8;
+
+    juce::uint32 slotBit(int slot) { return slot >= 0 ? juce::uint32(1) << slot : 0; }
+    int getReadySlot(juce::uint32 state) { return static_cast<int>(state >> readyShift) - 1; }
+
+    // JUCE's real-only transforms use interleaved complex bins, the delay line
+    // and kernels keep real and imaginary parts in separate rows so the
+    // multiply-accumulate vectorises
+    void deinterleave(const float* interleaved, float* split, int numBins)
+    {
+        for (int k = 0; k < numBins; ++k)
+        {
+            split[k]           = interleaved[2 * k];
+            split[numBins + k] = interleaved[2 * k + 1];
+        }
+    }
+
+    void interleave(const float* split, float* interleaved, int numBins)
+    {
+        for (int k = 0; k < numBins; ++k)
+        {
+            interleaved[2 * k]     = split[k];
+            interleaved[2 * k + 1] = split[numBins + k];
+        }
+    }
+}
+
+//==============================================================================
+void PartitionedConvolver::prepare(int newNumChannels, int newPartitionSize, int maxKernelLength)
+{
+    jassert(juce::isPowerOfTwo(newPartitionSize));
+
+    numChannels   = newNumChannels;
+    partitionSize = newPartitionSize;
+    fftSize       = 2 * partitionSize;
+    numBins       = partitionSize + 1;
+    maxPartitions = juce::jmax(1, (maxKernelLength + partitionSize - 1) / partitionSize);
+
+    const auto fftOrder = juce::roundToInt(std::log2(fftSize));
+    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+    loaderFft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+    for (auto& kernel : kernels)
+    {
+        kernel.spectra.calloc(static_cast<size_t>(maxPartitions * 2 * numBins));
+        kernel.numPartitions = 0;
+        kernel.latency = 0;
+        kernel.restart = false;
+    }
+
+    slotState = 0;
+    activeLatency = 0;
+    restartAllowed = false;
+    activeSlot = previousSlot = -1;
+
+    history.calloc(static_cast<size_t>(numChannels * partitionSize));
+    inputFifo.calloc(static_cast<size_t>(numChannels * partitionSize));
+    outputFifo.calloc(static_cast<size_t>(numChannels * partitionSize));
+    delayLine.calloc(static_cast<size_t>(numChannels * maxPartitions * 2 * numBins));
+
+    fftBuffer.calloc(static_cast<size_t>(2 * fftSize));
+    previousBuffer.calloc(static_cast<size_t>(2 * fftSize));
+    spectrum.calloc(static_cast<size_t>(2 * numBins));
+    loaderBuffer.calloc(static_cast<size_t>(2 * fftSize));
+
+    fifoPosition = delayLinePosition = 0;
+}
+
+void PartitionedConvolver::reset()
+{
+    juce::FloatVectorOperations::clear(history.get(), numChannels * partitionSize);
+    juce::FloatVectorOperations::clear(inputFifo.get(), numChannels * partitionSize);
+    juce::FloatVectorOperations::clear(outputFifo.get(), numChannels * partitionSize);
+    juce::FloatVectorOperations::clear(delayLine.get(), numChannels * maxPartitions * 2 * numBins);
+
+    fifoPosition = delayLinePosition = 0;
+}
+
+//==============================================================================
+void PartitionedConvolver::loadKernel(const float* impulseResponse, int length, int latency, bool restart)
+{
+    jassert(length > 0 && length <= maxPartitions * partitionSize);
+    length = juce::jmin(length, maxPartitions * partitionSize);
+
+    // Any slot the audio thread is not reading and that is not waiting is
+    // free. The audio thread only ever claims the published slot, so the
+    // choice stays valid until we publish.
+    auto state = slotState.load();
+    auto slot = 0;
+
+    while ((state & slotBit(slot)) != 0 || getReadySlot(state) == slot)
+        ++slot;
+
+    jassert(slot < numKernelSlots);
+
+    auto& kernel = kernels[static_cast<size_t>(slot)];
+    kernel.numPartitions = (length + partitionSize - 1) / partitionSize;
+    kernel.latency = latency + partitionSize;
+    kernel.restart = restart;
+
+    for (int p = 0; p < kernel.numPartitions; ++p)
+    {
+        const auto start = p * partitionSize;
+        const auto count = juce::jmin(partitionSize, length - start);
+
+        juce::FloatVectorOperations::clear(loaderBuffer.get(), 2 * fftSize);
+        juce::FloatVectorOperations::copy(loaderBuffer.get(), impulseResponse + start, count);
+
+        loaderFft->performRealOnlyForwardTransform(loaderBuffer, true);
+        deinterleave(loaderBuffer, kernel.spectra + p * 2 * numBins, numBins);
+    }
+
+    // Publish, dropping any kernel that was still waiting
+    while (! slotState.compare_exchange_weak(state, (state & busyMask) | (juce::uint32(slot + 1) << readyShift)))
+    {
+    }
+}
+
+void PartitionedConvolver::takePublishedKernel()
+{
+    auto state = slotState.load();
+
+    for (;;)
+    {
+        const auto ready = getReadySlot(state);
+
+        if (ready < 0)
+            return;
+
+        // The loader never writes the published slot, so this is stable
+        const auto restart = kernels[static_cast<size_t>(ready)].restart;
+
+        if (restart && ! restartAllowed.load())
+            return;
+
+        if (slotState.compare_exchange_weak(state, slotBit(ready) | slotBit(activeSlot)))
+        {
+            previousSlot = activeSlot;
+            activeSlot = ready;
+            activeLatency = kernels[static_cast<size_t>(ready)].latency;
+
+            // A restart switches over on the spot
+            if (restart)
+            {
+                restartAllowed = false;
+
+                if (previousSlot >= 0)
+                    releasePreviousKernel();
+            }
+
+            return;
+        }
+    }
+}
+
+void PartitionedConvolver::releasePreviousKernel()
+{
+    auto state = slotState.load();
+
+    while (! slotState.compare_exchange_weak(state, state & ~slotBit(previousSlot)))
+    {
+    }
+
+    previousSlot = -1;
+}
+
+//==============================================================================
+template <typename SampleType>
+void PartitionedConvolver::process(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto channelsToProcess = juce::jmin(numChannels, static_cast<int>(block.getNumChannels()));
+
+    jassert(partitionSize > 0);
+
+    if (partitionSize == 0)
+        return;
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto length = juce::jmin(partitionSize - fifoPosition, numSamples - start);
+
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+        {
+            auto* samples = block.getChannelPointer(static_cast<size_t>(channel)) + start;
+            auto* in = inputFifo + channel * partitionSize + fifoPosition;
+            const auto* out = outputFifo + channel * partitionSize + fifoPosition;
+
+            for (int n = 0; n < length; ++n)
+            {
+                in[n] = static_cast<float>(samples[n]);
+                samples[n] = static_cast<SampleType>(out[n]);
+            }
+        }
+
+        fifoPosition += length;
+        start += length;
+
+        if (fifoPosition == partitionSize)
+        {
+            processPartition(inputFifo, outputFifo);
+            fifoPosition = 0;
+        }
+    }
+}
+
+void PartitionedConvolver::accumulate(const Kernel& kernel, int channel, float* result) const
+{
+    juce::FloatVectorOperations::clear(result, 2 * numBins);
+
+    auto* resultRe = result;
+    auto* resultIm = result + numBins;
+
+    const auto* channelLine = delayLine + channel * maxPartitions * 2 * numBins;
+
+    for (int p = 0; p < kernel.numPartitions; ++p)
+    {
+        // Partition p of the kernel meets the input from p blocks ago
+        const auto index = (delayLinePosition - p + maxPartitions) % maxPartitions;
+        const auto* xRe = channelLine + index * 2 * numBins;
+        const auto* xIm = xRe + numBins;
+        const auto* hRe = kernel.spectra + p * 2 * numBins;
+        const auto* hIm = hRe + numBins;
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            resultRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+            resultIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+        }
+    }
+}
+
+void PartitionedConvolver::processPartition(const float* input, float* output)
+{
+    // New kernels are only picked up once the last crossfade has finished
+    if (previousSlot < 0)
+        takePublishedKernel();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* channelHistory = history + channel * partitionSize;
+        const auto* channelInput = input + channel * partitionSize;
+        auto* channelOutput = output + channel * partitionSize;
+
+        // Overlap-save frame: the previous block followed by the new one
+        juce::FloatVectorOperations::copy(fftBuffer.get(), channelHistory, partitionSize);
+        juce::FloatVectorOperations::copy(fftBuffer + partitionSize, channelInput, partitionSize);
+        juce::FloatVectorOperations::clear(fftBuffer + fftSize, fftSize);
+        juce::FloatVectorOperations::copy(channelHistory, channelInput, partitionSize);
+
+        fft->performRealOnlyForwardTransform(fftBuffer, true);
+        deinterleave(fftBuffer, delayLine + (channel * maxPartitions + delayLinePosition) * 2 * numBins, numBins);
+
+        if (activeSlot < 0)
+        {
+            juce::FloatVectorOperations::clear(channelOutput, partitionSize);
+            continue;
+        }
+
+        // The second half of the inverse transform is free of wrap-around
+        auto renderKernel = [&](int slot, float* buffer)
+        {
+            accumulate(kernels[static_cast<size_t>(slot)], channel, spectrum);
+            interleave(spectrum, buffer, numBins);
+            fft->performRealOnlyInverseTransform(buffer);
+        };
+
+        renderKernel(activeSlot, fftBuffer);
+
+        if (previousSlot >= 0)
+        {
+            // The delay line is shared, so the old kernel's output is valid
+            // for this block and both can be blended sample by sample
+            renderKernel(previousSlot, previousBuffer);
+
+            const auto* oldOutput = previousBuffer + partitionSize;
+            const auto* newOutput = fftBuffer + partitionSize;
+            const auto step = 1.f / static_cast<float>(partitionSize);
+
+            for (int n = 0; n < partitionSize; ++n)
+            {
+                const auto fade = static_cast<float>(n) * step;
+                channelOutput[n] = oldOutput[n] + fade * (newOutput[n] - oldOutput[n]);
+            }
+        }
+        else
+        {
+            juce::FloatVectorOperations::copy(channelOutput, fftBuffer + partitionSize, partitionSize);
+        }
+    }
+
+    if (previousSlot >= 0)
+        releasePreviousKernel();
+
+    delayLinePosition = (delayLinePosition + 1) % maxPartitions;
+}
+
+//==============================================================================
+template void PartitionedConvolver::process<float>(const juce::dsp::AudioBlock<float>&);
+template void PartitionedConvolver::process<double>(const juce::dsp::AudioBlock<double>&);
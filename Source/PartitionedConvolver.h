@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Uniformly partitioned overlap-save FFT convolution for long FIR kernels.
+    The kernel is split into partitions of partitionSize taps whose spectra
+    are multiplied against a frequency-domain delay line of past input
+    blocks, so the cost per sample grows with the number of partitions
+    rather than with the kernel length.
+
+    Kernels are transformed off the audio thread and published through a
+    small set of preallocated slots. The processing thread picks up a new
+    kernel at its next partition boundary and crossfades to it over one
+    partition.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class PartitionedConvolver
+{
+public:
+    //==============================================================================
+    // Allocates everything for kernels up to maxKernelLength taps. Must not be
+    // called on the audio thread, and drops any loaded kernel.
+    void prepare(int numChannels, int partitionSize, int maxKernelLength);
+
+    // Clears the input history and FIFOs, keeping the current kernel
+    void reset();
+
+    //==============================================================================
+    // Transforms and publishes a kernel. latency is the kernel's own delay in
+    // samples, the partition buffering is added on top. Call from a single
+    // non-audio thread at a time; a kernel that has not been picked up yet is
+    // replaced by the newer one. A restart kernel is switched to without a
+    // crossfade, and only once allowRestart() has been called.
+    void loadKernel(const float* impulseResponse, int length, int latency, bool restart = false);
+
+    // Lets the processing thread pick up a waiting restart kernel at its
+    // next partition boundary
+    void allowRestart() noexcept { restartAllowed = true; }
+
+    //==============================================================================
+    // Convolves the first numChannels channels of the block in place. Output
+    // is silent until the first kernel has been picked up.
+    template <typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& block);
+
+    // Runs exactly one partition without the FIFOs, for callers that do their
+    // own buffering. Both buffers hold partitionSize samples per channel,
+    // channel after channel. The output is the convolution for the samples
+    // of this input block, so no latency is added.
+    void processPartition(const float* input, float* output);
+
+    //==============================================================================
+    int getPartitionSize() const noexcept { return partitionSize; }
+
+    // Latency of the kernel currently playing, including partition buffering
+    int getLatencyInSamples() const noexcept { return activeLatency.load(); }
+
+private:
+    //==============================================================================
+    static constexpr int numKernelSlots = 4;
+
+    struct Kernel
+    {
+        juce::HeapBlock<float> spectra;     // per partition: numBins real, then numBins imaginary
+        int numPartitions = 0;
+        int latency = 0;
+        bool restart = false;
+    };
+
+    void takePublishedKernel();
+    void releasePreviousKernel();
+    void accumulate(const Kernel& kernel, int channel, float* spectrum) const;
+
+    //==============================================================================
+    std::unique_ptr<juce::dsp::FFT> fft, loaderFft;
+
+    int numChannels = 0, partitionSize = 0, fftSize = 0, numBins = 0, maxPartitions = 0;
+
+    std::array<Kernel, numKernelSlots> kernels;
+
+    // Low bits: slots the audio thread is reading. Bits 8+: published slot
+    // plus one, zero when nothing is waiting.
+    std::atomic<juce::uint32> slotState{ 0 };
+    std::atomic<int> activeLatency{ 0 };
+    std::atomic<bool> restartAllowed{ false };
+    int activeSlot = -1, previousSlot = -1;
+
+    // Per channel: overlap-save history, input and output FIFOs, and the
+    // frequency-domain delay line of input spectra
+    juce::HeapBlock<float> history, inputFifo, outputFifo, delayLine;
+    int fifoPosition = 0, delayLinePosition = 0;
+
+    // Audio thread scratch (FFT buffers hold 2 * fftSize floats)
+    juce::HeapBlock<float> fftBuffer, previousBuffer, spectrum, loaderBuffer;
+
+    JUCE_LEAK_DETECTOR(PartitionedConvolver)
+};
@@ -86,15 +86,16 @@ void ResponseCurveComponent::timerCallback()
     if (parametersChanged.compareAndSetBool(false, true))
     {
         auto chainSettings = getChainSettings(audioProcessor.apvts);
-        
-        auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-        updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+        cascadeDesign = makeCascadeDesign<float>(chainSettings, audioProcessor.getProcessingSampleRate());
 
-        auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-        auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+        bandSections.clear();
+        std::array<BiquadSection<float>, maxSectionsPerEngineBand> designed;
 
-        updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-        updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+        for (const auto& band : getBandSettings(audioProcessor.apvts))
+        {
+            const auto numSections = designBandSections(band, audioProcessor.getProcessingSampleRate(), designed.data());
+            bandSections.insert(bandSections.end(), designed.begin(), designed.begin() + numSections);
+        }
 
         repaint();
     }
@@ -120,45 +121,35 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
     auto responseArea = getLocalBounds();
     auto w = responseArea.getWidth();
 
-    auto& lowCut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highCut = monoChain.get<ChainPositions::HighCut>();
-    auto sampleRate = audioProcessor.getSampleRate();
+    auto sampleRate = audioProcessor.getProcessingSampleRate();
 
     if (w <= 0)
         return;
 
+    std::vector<BiquadSection<float>> sections;
+    for (size_t slot = 0; slot < cascadeDesign.sections.size(); ++slot)
+        if (cascadeDesign.active[slot])
+            sections.push_back(cascadeDesign.sections[slot]);
+
+    sections.insert(sections.end(), bandSections.begin(), bandSections.end());
+
+    // The magnitude kernel takes sin^2(w / 2) for each pixel's frequency
+    std::vector<float> phi(static_cast<size_t>(w));
     std::vector<float> mags(static_cast<size_t>(w), 1.0f);
 
     for (int i = 0; i < w; ++i)
     {
-        float mag = 1.0f;
         auto freq = mapToLog10(static_cast<float>(i) / static_cast<float>(w), 20.0f, 20000.0f);
-
-        if (!monoChain.isBypassed<ChainPositions::Peak>())
-            mag *= static_cast<float>(peak.coefficients->getMagnitudeForFrequency(freq, sampleRate));
-
-        if (!lowCut.isBypassed<0>())
-            mag *= static_cast<float>(lowCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate));
-        if (!lowCut.isBypassed<1>())
-            mag *= static_cast<float>(lowCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate));
-        if (!lowCut.isBypassed<2>())
-            mag *= static_cast<float>(lowCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate));
-        if (!lowCut.isBypassed<3>())
-            mag *= static_cast<float>(lowCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate));
-
-        if (!highCut.isBypassed<0>())
-            mag *= static_cast<float>(highCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate));
-        if (!highCut.isBypassed<1>())
-            mag *= static_cast<float>(highCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate));
-        if (!highCut.isBypassed<2>())
-            mag *= static_cast<float>(highCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate));
-        if (!highCut.isBypassed<3>())
-            mag *= static_cast<float>(highCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate));
-
-        mags[static_cast<size_t>(i)] = juce::Decibels::gainToDecibels(mag);
+        auto s = std::sin(juce::MathConstants<double>::pi * freq / sampleRate);
+        phi[static_cast<size_t>(i)] = static_cast<float>(s * s);
     }
 
+    const auto& kernels = getFilterKernels<float>(audioProcessor.getActiveKernelIsa());
+    kernels.evaluateMagnitude(sections.data(), static_cast<int>(sections.size()), phi.data(), mags.data(), w);
+
+    for (auto& mag : mags)
+        mag = juce::Decibels::gainToDecibels(mag);
+
     juce::Path responseCurve;
 
     const float outputMin = static_cast<float>(responseArea.getBottom());
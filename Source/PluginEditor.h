@@ -49,7 +49,8 @@ private:
     OloEQAudioProcessor& audioProcessor;
     juce::Atomic<bool> parametersChanged{ false };
 
-    MonoChain monoChain;
+    CascadeDesign<float> cascadeDesign;
+    std::vector<BiquadSection<float>> bandSections;   // the band engine's enabled bands
 };
 
 
@@ -10,8 +10,254 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PresetLibrary.h"
 #include "JucePluginDefines.h"
 
+namespace
+{
+    static_assert(NumCascadeSlots + maxEngineBands * maxSectionsPerEngineBand <= FirEngine::maxSections,
+                  "FIR section list too short");
+    static_assert(NumCascadeSlots <= ParallelExpansion::maxBranches, "Parallel form too short");
+
+    bool isFirMode(ProcessingMode mode) { return mode == Mode_LinearPhase || mode == Mode_MinimumPhase; }
+    FirPhase getFirPhase(ProcessingMode mode) { return mode == Mode_MinimumPhase ? FirPhase::minimum : FirPhase::linear; }
+
+    // Active cascade sections followed by the enabled bands' sections,
+    // flattened for the FIR designer
+    FirEngine::DesignRequest makeFirRequest(const ChainSettings& settings, const BandSettingsArray& bands, double sampleRate,
+                                            int length, FirPhase phase)
+    {
+        FirEngine::DesignRequest request;
+        const auto design = makeCascadeDesign<double>(settings, sampleRate);
+
+        for (size_t slot = 0; slot < design.sections.size(); ++slot)
+            if (design.active[slot])
+                request.sections[static_cast<size_t>(request.numSections++)] = design.sections[slot];
+
+        for (const auto& band : bands)
+            request.numSections += designBandSections(band, sampleRate, request.sections.data() + request.numSections);
+
+        request.length = length;
+        request.phase = phase;
+
+        // Finer than every parameter step, so distinct settings never share
+        // a kernel and equal ones match without comparing floats exactly
+        auto quantise = [](double value, double step) { return static_cast<juce::int64>(std::llround(value / step)); };
+
+        // The enabled bands are folded into the last entry, FNV-1a style,
+        // one quantised value at a time
+        auto bandKey = static_cast<juce::uint64>(14695981039346656037ull);
+
+        for (size_t index = 0; index < bands.size(); ++index)
+        {
+            const auto& band = bands[index];
+
+            if (! band.enabled)
+                continue;
+
+            for (auto value : { static_cast<juce::int64>(index), static_cast<juce::int64>(band.type), static_cast<juce::int64>(band.order),
+                                quantise(band.frequency, 0.01), quantise(band.gainInDecibels, 0.01), quantise(band.quality, 0.001) })
+                bandKey = (bandKey ^ static_cast<juce::uint64>(value)) * 1099511628211ull;
+        }
+
+        request.key = { quantise(settings.lowCutFreq, 0.01), quantise(settings.highCutFreq, 0.01),
+                        quantise(settings.peakFreq, 0.01), quantise(settings.peakGainInDecibels, 0.01),
+                        quantise(settings.peakQuality, 0.001), settings.lowCutSlope, settings.highCutSlope,
+                        settings.peakDesign, quantise(sampleRate, 1.0), static_cast<juce::int64>(bandKey) };
+
+        return request;
+    }
+
+    // No sections, which designs a pure delay with the latency of any other
+    // kernel of the length and phase. No settings quantise to a negative
+    // key, so the flat kernel is cached under its own.
+    FirEngine::DesignRequest makeFlatFirRequest(int length, FirPhase phase)
+    {
+        FirEngine::DesignRequest request;
+        request.length = length;
+        request.phase = phase;
+        request.key.fill(-1);
+
+        return request;
+    }
+
+    //==============================================================================
+    // Bands of a cascade design and the slots they occupy
+    enum class CascadeBand
+    {
+        lowCut,
+        peak,
+        highCut
+    };
+
+    constexpr std::array<CascadeBand, 3> cascadeBands{ CascadeBand::lowCut, CascadeBand::peak, CascadeBand::highCut };
+
+    // First slot and end of the slots a band may occupy
+    std::pair<int, int> getBandSlots(CascadeBand band)
+    {
+        switch (band)
+        {
+            case CascadeBand::lowCut:  return { LowCutSlot, PeakSlot };
+            case CascadeBand::peak:    return { PeakSlot, HighCutSlot };
+            case CascadeBand::highCut:
+            default:                   return { HighCutSlot, NumCascadeSlots };
+        }
+    }
+
+    bool isSameBand(CascadeBand band, const ChainSettings& a, const ChainSettings& b)
+    {
+        switch (band)
+        {
+            case CascadeBand::lowCut:  return a.lowCutFreq == b.lowCutFreq && a.lowCutSlope == b.lowCutSlope;
+            case CascadeBand::highCut: return a.highCutFreq == b.highCutFreq && a.highCutSlope == b.highCutSlope;
+            case CascadeBand::peak:
+            default:                   return a.peakFreq == b.peakFreq && a.peakGainInDecibels == b.peakGainInDecibels
+                                           && a.peakQuality == b.peakQuality && a.peakDesign == b.peakDesign;
+        }
+    }
+
+    template <typename SampleType>
+    void designBand(CascadeDesign<SampleType>& design, CascadeBand band, const ChainSettings& settings, double sampleRate,
+                    CoefficientCache<SampleType>* cache, const CoefficientTables<SampleType>* tables)
+    {
+        // Tables only hold one sample rate and the RBJ peak, anything else
+        // falls through to the cache or a direct design
+        const auto useTables = tables != nullptr && tables->isPreparedFor(sampleRate);
+
+        if (band == CascadeBand::peak)
+        {
+            const auto matched = settings.peakDesign == PeakDesign_Matched;
+
+            if (useTables && ! matched)
+                design.sections[PeakSlot] = tables->designPeak(settings.peakFreq, settings.peakQuality, settings.peakGainInDecibels);
+            else if (cache != nullptr)
+                design.sections[PeakSlot] = cache->designPeak(sampleRate, settings.peakFreq, settings.peakQuality,
+                                                              settings.peakGainInDecibels, matched);
+            else
+                design.sections[PeakSlot] = matched
+                    ? designMatchedPeakSection<SampleType>(sampleRate, settings.peakFreq, settings.peakQuality, settings.peakGainInDecibels)
+                    : designPeakSection<SampleType>(sampleRate, settings.peakFreq, settings.peakQuality, settings.peakGainInDecibels);
+
+            design.active[PeakSlot] = true;
+            return;
+        }
+
+        // Cut filters use one section per slope step, as in updateCutFilter
+        const auto highPass = band == CascadeBand::lowCut;
+        const auto frequency = static_cast<SampleType>(highPass ? settings.lowCutFreq : settings.highCutFreq);
+        const auto order = 2 * (highPass ? settings.lowCutSlope : settings.highCutSlope) + 1;
+        const auto firstSlot = getBandSlots(band).first;
+        auto* sections = design.sections.data() + firstSlot;
+
+        int numSections = 0;
+
+        if (useTables)
+            numSections = highPass ? tables->designHighPass(frequency, order, sections)
+                                   : tables->designLowPass(frequency, order, sections);
+        else if (cache != nullptr)
+            numSections = highPass ? cache->designHighPass(sampleRate, frequency, order, sections)
+                                   : cache->designLowPass(sampleRate, frequency, order, sections);
+        else
+            numSections = highPass ? designButterworthHighPass<SampleType>(sampleRate, frequency, order, sections)
+                                   : designButterworthLowPass<SampleType>(sampleRate, frequency, order, sections);
+
+        std::fill_n(design.active.begin() + firstSlot, numSections, true);
+    }
+
+    //==============================================================================
+    enum class ChannelPath
+    {
+        a,
+        b,
+        bypass
+    };
+
+    // Which parameter set a channel runs. Only the first two channels form
+    // the stereo pair, and a single channel always runs set A.
+    ChannelPath getChannelPath(StereoMode mode, int channel, int numChannels)
+    {
+        if (numChannels < 2 || channel > 1)
+            return ChannelPath::a;
+
+        switch (mode)
+        {
+            case StereoMode_MidSide:   return channel == 0 ? ChannelPath::a : ChannelPath::b;
+            case StereoMode_LeftOnly:  return channel == 0 ? ChannelPath::a : ChannelPath::bypass;
+            case StereoMode_RightOnly: return channel == 1 ? ChannelPath::a : ChannelPath::bypass;
+            case StereoMode_DualMono:  return channel == 0 ? ChannelPath::a : ChannelPath::b;
+            case StereoMode_Stereo:
+            default:                   return ChannelPath::a;
+        }
+    }
+
+    // Slots are active when any channel uses them, channels that do not get
+    // an identity section there, which passes samples through unchanged
+    template <typename SampleType>
+    void applyPathDesigns(BiquadCascade<SampleType>& cascade, StereoMode mode,
+                          const CascadeDesign<SampleType>& designA, const CascadeDesign<SampleType>& designB)
+    {
+        const auto numChannels = cascade.getNumChannels();
+
+        auto getDesign = [&](int channel) -> const CascadeDesign<SampleType>*
+        {
+            switch (getChannelPath(mode, channel, numChannels))
+            {
+                case ChannelPath::a: return &designA;
+                case ChannelPath::b: return &designB;
+                case ChannelPath::bypass:
+                default:             return nullptr;
+            }
+        };
+
+        for (size_t slot = 0; slot < NumCascadeSlots; ++slot)
+        {
+            auto slotActive = false;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                if (const auto* design = getDesign(channel))
+                    slotActive = slotActive || design->active[slot];
+
+            if (slotActive)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    const auto* design = getDesign(channel);
+                    cascade.setSlot(static_cast<int>(slot), channel,
+                                    design != nullptr && design->active[slot] ? design->sections[slot] : BiquadSection<SampleType>{});
+                }
+            }
+
+            cascade.setSlotActive(static_cast<int>(slot), slotActive);
+        }
+    }
+
+    bool usesSetB(StereoMode mode) { return mode == StereoMode_MidSide || mode == StereoMode_DualMono; }
+
+    // Both sets' designs as designPaths makes them for a cascade of two or
+    // more channels, going through an unprepared cache
+    template <typename SampleType>
+    void designSets(const PathSettings& settings, double sampleRate, CoefficientCache<SampleType>& cache,
+                    CascadeDesign<SampleType>& designA, CascadeDesign<SampleType>& designB)
+    {
+        designA = makeCascadeDesign(settings.a, sampleRate, &cache);
+
+        if (usesSetB(settings.stereoMode) && settings.b != settings.a)
+            designB = deriveCascadeDesign(settings.b, sampleRate, settings.a, designA, &cache);
+        else
+            designB = designA;
+    }
+}
+
+juce::String getParameterId(const char* name, ParameterSet set)
+{
+    return set == ParameterSet_B ? juce::String(name) + " B" : juce::String(name);
+}
+
+juce::String getBandParameterId(int band, const char* name)
+{
+    return "Band " + juce::String(band + 1) + " " + name;
+}
+
 //==============================================================================
 // Constructor / Destructor
 OloEQAudioProcessor::OloEQAudioProcessor()
@@ -26,9 +272,24 @@ OloEQAudioProcessor::OloEQAudioProcessor()
     )
 #endif
 {
+    auto shareDesigns = [this](auto& engine, auto& cache)
+    {
+        engine.coefficientCache.setSharedCache(&cache);
+        engine.sharedDesigns.setSharedCache(&cache);
+        engine.switchDesigns.setSharedCache(&cache);
+    };
+
+    shareDesigns(floatEngine, sharedCoefficientCaches->get<float>());
+    shareDesigns(doubleEngine, sharedCoefficientCaches->get<double>());
+
+    apvts.addParameterListener("Processing Mode", this);
 }
 
-OloEQAudioProcessor::~OloEQAudioProcessor() {}
+OloEQAudioProcessor::~OloEQAudioProcessor()
+{
+    apvts.removeParameterListener("Processing Mode", this);
+    cancelPendingUpdate();
+}
 
 //==============================================================================
 // Plugin information
@@ -72,18 +333,300 @@ void OloEQAudioProcessor::changeProgramName(int index, const juce::String& newNa
 // Prepare / release resources
 void OloEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    // The background threads stay stopped until everything they use is
+    // prepared again
+    {
+        const juce::ScopedLock lock(backgroundThreadLock);
+        backgroundThreadsPrepared = false;
+        updateBackgroundThreads();
+    }
+
+    // One lane per channel, using the widest kernel this CPU supports
+    const auto numChannels = juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+
+    auto floatIsa = getBestKernelIsa<float>(numChannels);
+    auto doubleIsa = getBestKernelIsa<double>(numChannels);
+
+    // The time-blocked kernel fills the lanes with samples rather than
+    // channels, so it always takes the widest
+    auto floatBlockedIsa = getWidestKernelIsa<float>();
+    auto doubleBlockedIsa = getWidestKernelIsa<double>();
+
+    if (forcedKernelIsa.has_value() && isKernelIsaSupported(*forcedKernelIsa))
+        floatIsa = doubleIsa = floatBlockedIsa = doubleBlockedIsa = *forcedKernelIsa;
+
+    // Everything the parameters can switch between at runtime is allocated
+    // here: both precisions, and buffers sized for the largest oversampling
+    // factor so a factor change on the audio thread never allocates
+    const auto maxProcessingBlockSize = samplesPerBlock << maxOversamplingOrder;
+
+    floatEngine.cascade.prepare(numChannels, maxProcessingBlockSize, NumCascadeSlots, floatIsa, floatBlockedIsa);
+    doubleEngine.cascade.prepare(numChannels, maxProcessingBlockSize, NumCascadeSlots, doubleIsa, doubleBlockedIsa);
+    floatEngine.fadeCascade.prepare(numChannels, maxProcessingBlockSize, NumCascadeSlots, floatIsa, floatBlockedIsa);
+    doubleEngine.fadeCascade.prepare(numChannels, maxProcessingBlockSize, NumCascadeSlots, doubleIsa, doubleBlockedIsa);
+    floatEngine.fadeBuffer.setSize(numChannels, maxProcessingBlockSize);
+    doubleEngine.fadeBuffer.setSize(numChannels, maxProcessingBlockSize);
+    floatEngine.bands.prepare(sampleRate, numChannels, maxProcessingBlockSize, floatIsa, floatBlockedIsa);
+    doubleEngine.bands.prepare(sampleRate, numChannels, maxProcessingBlockSize, doubleIsa, doubleBlockedIsa);
+    activeKernelIsa = floatIsa;
+
+    parallelCascade.prepare(numChannels, maxProcessingBlockSize, doubleIsa);
+    parallelDesigner.prepare();
+
+    // One group per core, as long as every group gets enough channels and
+    // starts on an alignment boundary of the cascade
+    auto getGroupCount = [numChannels](int alignment)
+    {
+        return juce::jlimit(1, juce::SystemStats::getNumCpus(), numChannels / juce::jmax(minChannelsPerGroup, alignment));
+    };
+
+    numChannelGroups[Precision_Float] = getGroupCount(floatEngine.cascade.getChannelGroupAlignment());
+    numChannelGroups[Precision_Double] = getGroupCount(doubleEngine.cascade.getChannelGroupAlignment());
+    channelWorkers.prepare(juce::jmax(numChannelGroups[Precision_Float], numChannelGroups[Precision_Double]) - 1);
+
+    floatEngine.svf.prepare(sampleRate, numChannels);
+    doubleEngine.svf.prepare(sampleRate, numChannels);
+    floatEngine.svfB.prepare(sampleRate, numChannels);
+    doubleEngine.svfB.prepare(sampleRate, numChannels);
+
+    floatEngine.coefficientCache.prepare(coefficientCacheCapacity);
+    doubleEngine.coefficientCache.prepare(coefficientCacheCapacity);
+
+    // Built whether or not the table mode is on, so it can be switched at
+    // any time. Oversampled rates are not tabulated.
+    floatEngine.coefficientTables.prepare(sampleRate);
+    doubleEngine.coefficientTables.prepare(sampleRate);
+
+    prepareOversamplers(floatEngine, numChannels, samplesPerBlock);
+    prepareOversamplers(doubleEngine, numChannels, samplesPerBlock);
+
+    conversionBuffer.setSize(numChannels, samplesPerBlock);
+    maxHostBlockSize = samplesPerBlock;
+
+    // Padding never exceeds the latency of the longest linear phase kernel,
+    // which is longer than any oversampler's
+    const juce::dsp::ProcessSpec paddingSpec{ sampleRate, static_cast<juce::uint32>(samplesPerBlock), static_cast<juce::uint32>(numChannels) };
+    const auto maxPadding = FirEngine::getLatency(FirEngine::maxLength, FirPhase::linear);
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    floatLatencyPadding.prepare(paddingSpec);
+    doubleLatencyPadding.prepare(paddingSpec);
+    floatLatencyPadding.setMaximumDelayInSamples(maxPadding);
+    doubleLatencyPadding.setMaximumDelayInSamples(maxPadding);
+    latencyPadding = 0;
+
+    // Hosts announce offline renders before preparing, so a render starts
+    // with the render settings and the first FIR is designed at its length
+    renderQualityEnabled = apvts.getRawParameterValue("Render Quality")->load() > 0.5f;
+    renderingAtHighQuality = renderQualityEnabled && isNonRealtime();
+
+    // The first FIR is designed up front so the FIR modes are audible from
+    // the first block
+    const auto mode = static_cast<ProcessingMode>(apvts.getRawParameterValue("Processing Mode")->load());
+
+    const auto firTargets = getPathSettings(apvts);
+
+    firSettings = firTargets.a;
+    firBands = getBandSettings(apvts);
+    firLength = getFirLength(renderingAtHighQuality);
+    firPhase = getFirPhase(mode);
+    firEngine.prepare(numChannels, doubleIsa, makeFirRequest(firSettings, firBands, sampleRate, firLength, firPhase));
+
+    firSettingsB = firTargets.b;
+    firBandsB = firBands;
+    firFlatB = ! usesSetB(firTargets.stereoMode);
+    firLengthB = firLength;
+    firPhaseB = firPhase;
+    firEngineB.prepare(1, doubleIsa, firFlatB ? makeFlatFirRequest(firLengthB, firPhaseB)
+                                              : makeFirRequest(firSettingsB, firBandsB, sampleRate, firLengthB, firPhaseB));
+
+    activeMode = mode;
+    setOversamplingOrder(getEffectiveOversamplingOrder(activeMode, renderingAtHighQuality));
+
+    // The update below supersedes any switch still pending
+    switchPending = false;
+    crossfadeRemaining = 0;
 
     updateFilters();
+
+    // Hosts take the latency from prepareToPlay, so it is reported here
+    // rather than later from the message thread
+    setLatencySamples(latencyToReport.load());
+
+    const juce::ScopedLock lock(backgroundThreadLock);
+    backgroundThreadsPrepared = true;
+    updateBackgroundThreads();
+}
+
+//==============================================================================
+// Oversampling
+template <typename SampleType>
+void OloEQAudioProcessor::prepareOversamplers(Engine<SampleType>& engine, int numChannels, int maxBlockSize)
+{
+    // Polyphase IIR half-band stages, with the fractional group delay padded
+    // to a whole number of samples so the reported latency is exact
+    for (size_t i = 0; i < engine.oversamplers.size(); ++i)
+    {
+        engine.oversamplers[i] = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+            static_cast<size_t>(numChannels), i + 1, juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+            true, true);
+
+        engine.oversamplers[i]->initProcessing(static_cast<size_t>(maxBlockSize));
+    }
+}
+
+void OloEQAudioProcessor::setOversamplingOrder(int order)
+{
+    activeOversamplingOrder = juce::jlimit(0, maxOversamplingOrder, order);
+    processingSampleRate = getSampleRate() * (1 << activeOversamplingOrder);
+
+    // Smoothers count samples at the processing rate
+    smootherA.reset(processingSampleRate);
+    smootherB.reset(processingSampleRate);
+    bandSmoother.reset(processingSampleRate);
+
+    floatEngine.bands.setSampleRate(processingSampleRate);
+    doubleEngine.bands.setSampleRate(processingSampleRate);
+
+    for (auto* svf : { &floatEngine.svf, &floatEngine.svfB })
+        svf->setSampleRate(processingSampleRate);
+
+    for (auto* svf : { &doubleEngine.svf, &doubleEngine.svfB })
+        svf->setSampleRate(processingSampleRate);
+
+    updateLatency();
+}
+
+void OloEQAudioProcessor::updateLatency()
+{
+    // The FIR engines only take on a new latency when they restart
+    const auto latency = isFirMode(activeMode) ? firEngine.getLatencyInSamples()
+                                               : getEngineLatency(activeMode, activeOversamplingOrder, firLength, firPhase);
+    auto reported = latency;
+
+    // Playback and renders report the same latency, whichever engine
+    // settings need more, so a bounce lines up with what was heard. The
+    // active engine is padded up to it.
+    if (renderQualityEnabled)
+    {
+        const auto phase = getFirPhase(activeMode);
+        const auto playback = getEngineLatency(activeMode, getEffectiveOversamplingOrder(activeMode), getFirLength(), phase);
+        const auto render = getEngineLatency(activeMode, getEffectiveOversamplingOrder(activeMode, true), getFirLength(true), phase);
+
+        reported = juce::jmax(latency, playback, render);
+    }
+
+    if (reported - latency != latencyPadding)
+    {
+        latencyPadding = reported - latency;
+
+        floatLatencyPadding.reset();
+        doubleLatencyPadding.reset();
+        floatLatencyPadding.setDelay(static_cast<float>(latencyPadding));
+        doubleLatencyPadding.setDelay(static_cast<double>(latencyPadding));
+    }
+
+    if (latencyToReport.exchange(reported) != reported)
+        triggerAsyncUpdate();
+}
+
+int OloEQAudioProcessor::getEngineLatency(ProcessingMode mode, int oversamplingOrder, int firKernelLength,
+                                          FirPhase firKernelPhase) const
+{
+    if (isFirMode(mode))
+        return FirEngine::getLatency(firKernelLength, firKernelPhase);
+
+    // Both precisions use the same stages, so either reports the latency
+    const auto latency = oversamplingOrder > 0
+        ? floatEngine.oversamplers[static_cast<size_t>(oversamplingOrder - 1)]->getLatencyInSamples()
+        : 0.f;
+
+    return juce::roundToInt(latency);
+}
+
+int OloEQAudioProcessor::getEffectiveOversamplingOrder(ProcessingMode mode, bool highQualityRender) const
+{
+    // The FIR modes are designed and run at the host rate, oversampling
+    // would only multiply the kernel length
+    if (isFirMode(mode))
+        return 0;
+
+    auto order = static_cast<int>(apvts.getRawParameterValue("Oversampling")->load());
+
+    if (highQualityRender)
+        order = juce::jmax(order, renderOversamplingOrder);
+
+    return juce::jlimit(0, maxOversamplingOrder, order);
+}
+
+int OloEQAudioProcessor::getFirLength(bool highQualityRender) const
+{
+    const auto length = FirEngine::minLength << static_cast<int>(apvts.getRawParameterValue("FIR Length")->load());
+    return highQualityRender ? juce::jmin(FirEngine::maxLength, length << renderFirLengthSteps) : length;
+}
+
+int OloEQAudioProcessor::getCoefficientCacheHits() const
+{
+    return activePrecision == Precision_Double ? doubleEngine.coefficientCache.getHits()
+                                               : floatEngine.coefficientCache.getHits();
+}
+
+int OloEQAudioProcessor::getCoefficientCacheMisses() const
+{
+    return activePrecision == Precision_Double ? doubleEngine.coefficientCache.getMisses()
+                                               : floatEngine.coefficientCache.getMisses();
 }
 
-void OloEQAudioProcessor::releaseResources() {}
+double OloEQAudioProcessor::getProcessingSampleRate() const
+{
+    const auto mode = static_cast<ProcessingMode>(apvts.getRawParameterValue("Processing Mode")->load());
+    return getSampleRate() * (1 << getEffectiveOversamplingOrder(mode));
+}
+
+void OloEQAudioProcessor::releaseResources()
+{
+    channelWorkers.release();
+
+    const juce::ScopedLock lock(backgroundThreadLock);
+    backgroundThreadsPrepared = false;
+    updateBackgroundThreads();
+}
+
+//==============================================================================
+// Background threads
+void OloEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused(parameterID, newValue);
+    triggerAsyncUpdate();
+}
+
+void OloEQAudioProcessor::handleAsyncUpdate()
+{
+    if (getLatencySamples() != latencyToReport.load())
+        setLatencySamples(latencyToReport.load());
+
+    const juce::ScopedLock lock(backgroundThreadLock);
+    updateBackgroundThreads();
+}
+
+void OloEQAudioProcessor::updateBackgroundThreads()
+{
+    // Until the threads start, the audio thread runs the convolver's tail
+    // blocks itself and keeps the last kernel or expansion it was given
+    const auto mode = static_cast<ProcessingMode>(apvts.getRawParameterValue("Processing Mode")->load());
+
+    for (auto* engine : { &firEngine, &firEngineB })
+    {
+        if (backgroundThreadsPrepared && isFirMode(mode))
+            engine->start();
+        else
+            engine->stop();
+    }
+
+    if (backgroundThreadsPrepared && mode == Mode_Parallel)
+        parallelDesigner.start();
+    else
+        parallelDesigner.stop();
+}
 
 //==============================================================================
 // Check bus layouts
@@ -97,8 +640,9 @@ bool OloEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) con
     const auto mainOut = layouts.getMainOutputChannelSet();
     const auto mainIn  = layouts.getMainInputChannelSet();
 
-
-    if (mainOut != juce::AudioChannelSet::mono() && mainOut != juce::AudioChannelSet::stereo())
+    // Mono, stereo and wide buses up to maxBusChannels. Channels beyond the
+    // stereo pair always run set A.
+    if (mainOut.isDisabled() || mainOut.size() > maxBusChannels)
         return false;
 
 #if ! JucePlugin_IsSynth
@@ -117,142 +661,1218 @@ void OloEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
 {
     juce::ScopedNoDenormals noDenormals;
 
-    auto totalInputChannels  = getTotalNumInputChannels();
-    auto totalOutputChannels = getTotalNumOutputChannels();
+    beginBlock(buffer, static_cast<Precision>(apvts.getRawParameterValue("Precision")->load()));
 
-    for (auto i = totalInputChannels; i < totalOutputChannels; ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
+    if (activePrecision == Precision_Double)
+        processWithDoubleState(buffer);
+    else
+        processWithOversampling(floatEngine, juce::dsp::AudioBlock<float>(buffer));
 
-    updateFilters();
+    applyLatencyPadding(floatLatencyPadding, buffer);
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    juce::ignoreUnused(midiMessages);
+}
 
-    auto leftBlock  = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+void OloEQAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ScopedNoDenormals noDenormals;
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    beginBlock(buffer, Precision_Double);
+    processWithOversampling(doubleEngine, juce::dsp::AudioBlock<double>(buffer));
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    applyLatencyPadding(doubleLatencyPadding, buffer);
 
     juce::ignoreUnused(midiMessages);
 }
 
-//==============================================================================
-// Editor
-bool OloEQAudioProcessor::hasEditor() const { return true; }
-juce::AudioProcessorEditor* OloEQAudioProcessor::createEditor() { return new OloEQAudioProcessorEditor(*this); }
-
-//==============================================================================
-// State management
-void OloEQAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
+template <typename SampleType>
+void OloEQAudioProcessor::applyLatencyPadding(juce::dsp::DelayLine<SampleType, PaddingDelay>& delay,
+                                              juce::AudioBuffer<SampleType>& buffer)
 {
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    if (latencyPadding == 0)
+        return;
+
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    delay.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
 }
 
-void OloEQAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+template <typename SampleType>
+void OloEQAudioProcessor::beginBlock(juce::AudioBuffer<SampleType>& buffer, Precision precision)
 {
-    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
-    if (tree.isValid())
+    auto totalInputChannels  = getTotalNumInputChannels();
+    auto totalOutputChannels = getTotalNumOutputChannels();
+
+    for (auto i = totalInputChannels; i < totalOutputChannels; ++i)
+        buffer.clear(i, 0, buffer.getNumSamples());
+
+    setSmoothingTargets(getPathSettings(apvts));
+    bandTargets = getBandSettings(apvts);
+    bandSmoother.setTargetValues(bandTargets);
+    useCoefficientTables = apvts.getRawParameterValue("Coefficient Tables")->load() > 0.5f;
+
+    // Both kernels share the cascade state, so this switches seamlessly
+    const auto timeBlocked = apvts.getRawParameterValue("Time Blocking")->load() > 0.5f;
+    floatEngine.cascade.setTimeBlocked(timeBlocked);
+    doubleEngine.cascade.setTimeBlocked(timeBlocked);
+    floatEngine.bands.setTimeBlocked(timeBlocked);
+    doubleEngine.bands.setTimeBlocked(timeBlocked);
+
+    useChannelWorkers = apvts.getRawParameterValue("Channel Threads")->load() > 0.5f;
+
+    // Hosts may switch to offline rendering without preparing again, which
+    // restarts the engine below with the render settings
+    const auto renderQuality = apvts.getRawParameterValue("Render Quality")->load() > 0.5f;
+    renderingAtHighQuality = renderQuality && isNonRealtime();
+
+    if (renderQuality != renderQualityEnabled)
     {
-        apvts.replaceState(tree);
-        updateFilters();
+        renderQualityEnabled = renderQuality;
+        updateLatency();
     }
-}
 
-//==============================================================================
-// Parameter helpers
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
-{
-    ChainSettings settings;
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
-    return settings;
-}
+    const auto mode = static_cast<ProcessingMode>(apvts.getRawParameterValue("Processing Mode")->load());
+    const auto useDouble = mode == Mode_Parallel || renderingAtHighQuality;
 
-Coefficients makePeakFilter(const ChainSettings& settings, double sampleRate)
-{
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        sampleRate, settings.peakFreq, settings.peakQuality,
-        juce::Decibels::decibelsToGain(settings.peakGainInDecibels)
-    );
+    selectEngine(mode, useDouble ? Precision_Double : precision, targetSettings.stereoMode,
+                 getEffectiveOversamplingOrder(mode, renderingAtHighQuality));
+
+    takeEngineSwitch();
 }
 
-//==============================================================================
-// Filter updates
-void OloEQAudioProcessor::updatePeakFilter(const ChainSettings& settings)
+void OloEQAudioProcessor::selectEngine(ProcessingMode mode, Precision precision, StereoMode stereoMode, int oversamplingOrder)
 {
-    auto peakCoefficients = makePeakFilter(settings, getSampleRate());
+    if (mode == activeMode && precision == activePrecision && stereoMode == activeStereoMode
+        && oversamplingOrder == activeOversamplingOrder)
+        return;
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-}
+    activeMode = mode;
+    activePrecision = precision;
+    activeStereoMode = stereoMode;
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
-{
-    *old = *replacements;
-}
+    if (oversamplingOrder != activeOversamplingOrder)
+        setOversamplingOrder(oversamplingOrder);
 
-void OloEQAudioProcessor::updateLowCutFilters(const ChainSettings& settings)
-{
-    auto lowCutCoefficients = makeLowCutFilter(settings, getSampleRate());
+    // Engines keep their own state, so start the newly selected one clean
+    // and bring its design up to date with the current smoothed values
+    const auto settings = advanceSmoothing(0);
+    const auto bands = bandSmoother.skip(bandTargets, 0);
 
-    updateCutFilter(leftChain.get<ChainPositions::LowCut>(), lowCutCoefficients, settings.lowCutSlope);
-    updateCutFilter(rightChain.get<ChainPositions::LowCut>(), lowCutCoefficients, settings.lowCutSlope);
-}
+    auto restart = [&settings, &bands, this](auto& engine)
+    {
+        engine.cascade.reset();
+        engine.svf.reset();
+        engine.svfB.reset();
+        engine.bands.reset();
+        updateBands(engine.bands, bands);
 
-void OloEQAudioProcessor::updateHighCutFilters(const ChainSettings& settings)
-{
-    auto highCutCoefficients = makeHighCutFilter(settings, getSampleRate());
+        for (auto& oversampler : engine.oversamplers)
+            oversampler->reset();
 
-    updateCutFilter(leftChain.get<ChainPositions::HighCut>(), highCutCoefficients, settings.highCutSlope);
-    updateCutFilter(rightChain.get<ChainPositions::HighCut>(), highCutCoefficients, settings.highCutSlope);
+        designEngine(engine, settings);
+    };
+
+    parallelCascade.reset();
+
+    if (precision == Precision_Double)
+        restart(doubleEngine);
+    else
+        restart(floatEngine);
+
+    firEngine.reset();
+    firEngineB.reset();
+    samplesUntilControlUpdate = 0;
+    samplesUntilBandUpdate = 0;
+    crossfadeRemaining = 0;
+
+    updateLatency();
 }
 
-void OloEQAudioProcessor::updateFilters()
+void OloEQAudioProcessor::processWithDoubleState(juce::AudioBuffer<float>& buffer)
 {
-    auto settings = getChainSettings(apvts);
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), conversionBuffer.getNumChannels());
+    const auto numSamples = buffer.getNumSamples();
+    const auto chunkSize = conversionBuffer.getNumSamples();
+
+    jassert(chunkSize > 0);
+
+    if (chunkSize == 0)
+        return;
+
+    // Convert through the preallocated buffer, in chunks in case the host
+    // exceeds the announced block size
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const auto length = juce::jmin(chunkSize, numSamples - start);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* src = buffer.getReadPointer(channel, start);
+            auto* dst = conversionBuffer.getWritePointer(channel);
+
+            for (int n = 0; n < length; ++n)
+                dst[n] = static_cast<double>(src[n]);
+        }
+
+        processWithOversampling(doubleEngine, juce::dsp::AudioBlock<double>(conversionBuffer)
+                                                  .getSubsetChannelBlock(0, static_cast<size_t>(numChannels))
+                                                  .getSubBlock(0, static_cast<size_t>(length)));
 
-    updateLowCutFilters(settings);
-    updatePeakFilter(settings);
-    updateHighCutFilters(settings);
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* src = conversionBuffer.getReadPointer(channel);
+            auto* dst = buffer.getWritePointer(channel, start);
+
+            for (int n = 0; n < length; ++n)
+                dst[n] = static_cast<float>(src[n]);
+        }
+    }
 }
 
-//==============================================================================
-// Create parameter layout
-juce::AudioProcessorValueTreeState::ParameterLayout
-OloEQAudioProcessor::createParameterLayout()
+template <typename SampleType>
+void OloEQAudioProcessor::processWithOversampling(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block)
 {
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    // Mid/Side is encoded and decoded at the host rate, around everything
+    // else, the FIR convolvers included
+    const auto midSide = activeStereoMode == StereoMode_MidSide && block.getNumChannels() > 1;
+    const auto& kernels = getFilterKernels<SampleType>(engine.cascade.getKernelIsa());
+    const auto numSamples = block.getNumSamples();
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "LowCut Freq", "LowCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
+    if (midSide)
+        kernels.rotateChannelPair(block.getChannelPointer(0), block.getChannelPointer(1), static_cast<int>(numSamples), SampleType(0.5));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "HighCut Freq", "HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
+    if (activeOversamplingOrder == 0 || maxHostBlockSize == 0)
+    {
+        process(engine, block);
+    }
+    else
+    {
+        auto& oversampler = *engine.oversamplers[static_cast<size_t>(activeOversamplingOrder - 1)];
+        const auto chunkSize = static_cast<size_t>(maxHostBlockSize);
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "Peak Freq", "Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f));
+        // The oversampler buffers hold one announced block, so work in chunks
+        for (size_t start = 0; start < numSamples; start += chunkSize)
+        {
+            auto subBlock = block.getSubBlock(start, juce::jmin(chunkSize, numSamples - start));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "Peak Gain", "Peak Gain", juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.f));
+            process(engine, oversampler.processSamplesUp(subBlock));
+            oversampler.processSamplesDown(subBlock);
+        }
+    }
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "Peak Quality", "Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+    if (midSide)
+        kernels.rotateChannelPair(block.getChannelPointer(0), block.getChannelPointer(1), static_cast<int>(numSamples), SampleType(1));
+}
 
-    juce::StringArray slopeChoices;
-    for (int i = 0; i < 4; ++i)
-        slopeChoices.add(juce::String(12 + i * 12) + " db/Oct");
+template <typename SampleType>
+void OloEQAudioProcessor::process(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block)
+{
+    // The FIR kernels take the band engine's bands in with the main ones
+    if (isFirMode(activeMode))
+    {
+        processFir(block);
+        return;
+    }
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", slopeChoices, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", slopeChoices, 0));
+    if (activeMode == Mode_Svf)
+        processSvf(engine, block);
+    else if constexpr (std::is_same_v<SampleType, double>)
+    {
+        // Only the double engine has a parallel form, see beginBlock
+        if (activeMode == Mode_Parallel)
+            processParallel(engine, block);
+        else
+            processBiquad(engine, block);
+    }
+    else
+    {
+        processBiquad(engine, block);
+    }
+
+    processBands(engine, block);
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::processBiquad(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+
+    // Split the block at control-rate boundaries, which carry over between
+    // blocks so the update rate does not depend on the host buffer size.
+    // The interval scales with oversampling to keep the same rate in time.
+    const auto interval = controlInterval << activeOversamplingOrder;
+
+    for (int start = 0; start < numSamples;)
+    {
+        if (samplesUntilControlUpdate == 0)
+        {
+            updateFilters(engine, advanceSmoothing(interval));
+            samplesUntilControlUpdate = interval;
+        }
+
+        auto length = juce::jmin(samplesUntilControlUpdate, numSamples - start);
+
+        // Once nothing is ramping and the design is current, the updates
+        // left in this block would change nothing, so the rest of it runs in
+        // one pass and the count carries on as if it had been split
+        if (! isSmoothing() && advanceSmoothing(0) == engine.designedSettings)
+            length = numSamples - start;
+
+        const auto subBlock = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length));
+
+        if (crossfadeRemaining > 0)
+            processCrossfade(engine, subBlock);
+        else
+            processCascade(engine.cascade, subBlock);
+
+        start += length;
+        samplesUntilControlUpdate = ((samplesUntilControlUpdate - length) % interval + interval) % interval;
+    }
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::processCascade(BiquadCascade<SampleType>& cascade, const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numGroupsWanted = numChannelGroups[std::is_same<SampleType, float>::value ? Precision_Float : Precision_Double];
+
+    if (! useChannelWorkers || numGroupsWanted < 2)
+    {
+        cascade.process(block);
+        return;
+    }
+
+    // Equal groups of whole alignment units, the last one takes what is left
+    const auto numChannels = cascade.getNumChannels();
+    const auto alignment = cascade.getChannelGroupAlignment();
+    const auto groupUnits = (numChannels + alignment * numGroupsWanted - 1) / (alignment * numGroupsWanted);
+    const auto groupSize = groupUnits * alignment;
+    const auto numGroups = (numChannels + groupSize - 1) / groupSize;
+
+    auto processGroup = [&cascade, &block, groupSize](int group)
+    {
+        cascade.process(block, group * groupSize, groupSize);
+    };
+
+    channelWorkers.run(numGroups, processGroup);
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::processCrossfade(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+
+    // Hosts may pass longer blocks than they announced, which only the
+    // oversamplers split up, so the copy of the input is taken in chunks
+    // the buffer can hold
+    const auto chunkSize = engine.fadeBuffer.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const auto length = juce::jmin(chunkSize, numSamples - start);
+        const auto chunk = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length));
+
+        if (crossfadeRemaining == 0)
+        {
+            processCascade(engine.cascade, chunk);
+            continue;
+        }
+
+        auto outgoing = juce::dsp::AudioBlock<SampleType>(engine.fadeBuffer)
+                            .getSubsetChannelBlock(0, numChannels)
+                            .getSubBlock(0, static_cast<size_t>(length));
+
+        outgoing.copyFrom(chunk);
+        processCascade(engine.fadeCascade, outgoing);
+        processCascade(engine.cascade, chunk);
+
+        // Linear from the outgoing filter to the incoming one, which runs on
+        // alone once the crossfade is over
+        const auto done = crossfadeLength - crossfadeRemaining;
+        const auto fadeSamples = juce::jmin(length, crossfadeRemaining);
+        const auto step = SampleType(1) / static_cast<SampleType>(crossfadeLength);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* incoming = chunk.getChannelPointer(channel);
+            const auto* old = outgoing.getChannelPointer(channel);
+
+            for (int i = 0; i < fadeSamples; ++i)
+            {
+                const auto gain = static_cast<SampleType>(done + i + 1) * step;
+                incoming[i] = old[i] + (incoming[i] - old[i]) * gain;
+            }
+        }
+
+        crossfadeRemaining -= fadeSamples;
+    }
+}
+
+void OloEQAudioProcessor::processParallel(Engine<double>& engine, const juce::dsp::AudioBlock<double>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto interval = controlInterval << activeOversamplingOrder;
+
+    // The same control-rate updates as processBiquad, but expanding the new
+    // designs is left to the designer. Until an expansion arrives, the last
+    // one keeps running, so it lags by a few milliseconds at most.
+    for (int start = 0; start < numSamples;)
+    {
+        if (samplesUntilControlUpdate == 0)
+        {
+            const auto settings = advanceSmoothing(interval);
+
+            if (settings != engine.designedSettings)
+            {
+                designPaths(engine, settings, true);
+                parallelRequestPending = true;
+            }
+
+            if (parallelRequestPending && parallelDesigner.requestExpansion(makeParallelRequest()))
+                parallelRequestPending = false;
+
+            ParallelDesigner::Result result;
+
+            if (parallelDesigner.takeResult(result) && result.generation == parallelGeneration)
+                loadParallelExpansions(result);
+
+            // The serial cascade takes over while any channel lacks a valid
+            // expansion. Whichever realisation takes over starts clean, as
+            // the two share no state.
+            if (parallelCascade.isValid() != parallelFormActive)
+            {
+                parallelFormActive = parallelCascade.isValid();
+
+                if (parallelFormActive)
+                    parallelCascade.reset();
+                else
+                    engine.cascade.reset();
+            }
+
+            samplesUntilControlUpdate = interval;
+        }
+
+        const auto length = juce::jmin(samplesUntilControlUpdate, numSamples - start);
+        const auto subBlock = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length));
+
+        if (parallelFormActive)
+            parallelCascade.process(subBlock);
+        else
+            processCascade(engine.cascade, subBlock);
+
+        start += length;
+        samplesUntilControlUpdate -= length;
+    }
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::processSvf(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto numChannels = static_cast<int>(block.getNumChannels());
+
+    // Retune every sample while ramping, otherwise run the rest in one go
+    for (int start = 0; start < numSamples;)
+    {
+        const auto length = isSmoothing() ? 1 : numSamples - start;
+        const auto settings = advanceSmoothing(length);
+        const auto subBlock = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length));
+
+        updateSvf(engine.svf, settings.a);
+
+        if (activeStereoMode == StereoMode_Stereo || numChannels < 2)
+        {
+            engine.svf.process(subBlock);
+        }
+        else
+        {
+            // One instance per parameter set, each on its own channel
+            updateSvf(engine.svfB, settings.b);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto path = getChannelPath(activeStereoMode, channel, numChannels);
+
+                if (path != ChannelPath::bypass)
+                    (path == ChannelPath::a ? engine.svf : engine.svfB)
+                        .process(subBlock.getSingleChannelBlock(static_cast<size_t>(channel)));
+            }
+        }
+
+        start += length;
+    }
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::processBands(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto numChannels = static_cast<int>(block.getNumChannels());
+    const auto interval = controlInterval << activeOversamplingOrder;
+
+    // Channels the stereo mode passes through are left out. The rest keep
+    // their order, so each stays on its own cascade lane until the stereo
+    // mode changes and selectEngine resets the engine.
+    std::array<SampleType*, maxBusChannels> channels{};
+    size_t numFiltered = 0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (getChannelPath(activeStereoMode, channel, numChannels) != ChannelPath::bypass)
+            channels[numFiltered++] = block.getChannelPointer(static_cast<size_t>(channel));
+
+    const juce::dsp::AudioBlock<SampleType> filtered(channels.data(), numFiltered, block.getNumSamples());
+
+    // The same control-rate updates as processBiquad, on their own count
+    for (int start = 0; start < numSamples;)
+    {
+        if (samplesUntilBandUpdate == 0)
+        {
+            updateBands(engine.bands, bandSmoother.skip(bandTargets, interval));
+            samplesUntilBandUpdate = interval;
+        }
+
+        auto length = juce::jmin(samplesUntilBandUpdate, numSamples - start);
+
+        if (! bandSmoother.isSmoothing())
+            length = numSamples - start;
+
+        if (engine.bands.getNumEnabledBands() > 0)
+            engine.bands.process(filtered.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length)));
+
+        start += length;
+        samplesUntilBandUpdate = ((samplesUntilBandUpdate - length) % interval + interval) % interval;
+    }
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::processFir(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    // Keep the ramps moving so another engine picks up where this one left off
+    advanceSmoothing(static_cast<int>(block.getNumSamples()));
+    bandSmoother.skip(bandTargets, static_cast<int>(block.getNumSamples()));
+
+    firEngine.setNonRealtime(isNonRealtime());
+    firEngineB.setNonRealtime(isNonRealtime());
+
+    // Kernel swaps are crossfaded, so the targets are designed directly. A
+    // request the designer could not take is retried on the next block.
+    // Offline, kernels are designed before the block runs, so a render does
+    // not start on the playback kernel.
+    const auto length = getFirLength(renderingAtHighQuality);
+    const auto phase = getFirPhase(activeMode);
+
+    if (targetSettings.a != firSettings || bandTargets != firBands || length != firLength || phase != firPhase)
+    {
+        if (firEngine.requestDesign(makeFirRequest(targetSettings.a, bandTargets, processingSampleRate, length, phase)))
+        {
+            firSettings = targetSettings.a;
+            firBands = bandTargets;
+            firLength = length;
+            firPhase = phase;
+
+            if (isNonRealtime())
+                firEngine.designPendingNow();
+        }
+    }
+
+    // The second engine follows the same length and phase even while it is
+    // idle, so both always restart onto the same latency
+    const auto flatB = ! usesSetB(activeStereoMode);
+
+    if (flatB != firFlatB || (! flatB && (targetSettings.b != firSettingsB || bandTargets != firBandsB))
+        || length != firLengthB || phase != firPhaseB)
+    {
+        if (firEngineB.requestDesign(flatB ? makeFlatFirRequest(length, phase)
+                                           : makeFirRequest(targetSettings.b, bandTargets, processingSampleRate, length, phase)))
+        {
+            firSettingsB = targetSettings.b;
+            firBandsB = bandTargets;
+            firFlatB = flatB;
+            firLengthB = length;
+            firPhaseB = phase;
+
+            if (isNonRealtime())
+                firEngineB.designPendingNow();
+        }
+    }
+
+    // A new length or phase moves the kernel's centre, so crossfading to it
+    // would overlap two delays. Both engines restart together instead, once
+    // each has its kernel, and the padding and reported latency follow.
+    if ((firEngine.isRestartPending() || firEngineB.isRestartPending())
+        && firEngine.getLatencyAfterRestart() == firEngineB.getLatencyAfterRestart())
+    {
+        firEngine.restart();
+        firEngineB.restart();
+        updateLatency();
+    }
+
+    const auto numChannels = static_cast<int>(block.getNumChannels());
+
+    if (activeStereoMode == StereoMode_Stereo || numChannels < 2)
+    {
+        firEngine.process(block);
+        return;
+    }
+
+    // Set A's channels keep their order, so each stays on its own convolver
+    // channel until the stereo mode changes and selectEngine resets both
+    std::array<SampleType*, maxBusChannels> channelsA{};
+    SampleType* channelB = nullptr;
+    size_t numChannelsA = 0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = block.getChannelPointer(static_cast<size_t>(channel));
+
+        if (getChannelPath(activeStereoMode, channel, numChannels) == ChannelPath::a)
+            channelsA[numChannelsA++] = samples;
+        else
+            channelB = samples;
+    }
+
+    firEngine.process(juce::dsp::AudioBlock<SampleType>(channelsA.data(), numChannelsA, block.getNumSamples()));
+    firEngineB.process(juce::dsp::AudioBlock<SampleType>(&channelB, 1, block.getNumSamples()));
+}
+
+//==============================================================================
+// Editor
+bool OloEQAudioProcessor::hasEditor() const { return true; }
+juce::AudioProcessorEditor* OloEQAudioProcessor::createEditor() { return new OloEQAudioProcessorEditor(*this); }
+
+//==============================================================================
+// State management
+void OloEQAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
+{
+    binaryState.write(destData);
+}
+
+void OloEQAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+    // A damaged binary state is ignored rather than parsed as a ValueTree
+    if (BinaryStateLayout::isBinaryState(data, sizeInBytes))
+    {
+        if (binaryState.read(data, sizeInBytes))
+            requestEngineSwitch();
+
+        return;
+    }
+
+    // Sessions saved before the binary format hold the parameter ValueTree
+    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    if (tree.isValid())
+    {
+        apvts.replaceState(tree);
+        requestEngineSwitch();
+    }
+}
+
+void OloEQAudioProcessor::loadPreset(const PresetSettings& settings)
+{
+    applyPresetSettings(apvts, settings);
+    requestEngineSwitch();
+}
+
+//==============================================================================
+// Crossfaded switches
+void OloEQAudioProcessor::requestEngineSwitch()
+{
+    // Nothing has played before the first prepare, so there is nothing to
+    // fade from
+    if (maxHostBlockSize == 0)
+    {
+        updateFilters();
+        return;
+    }
+
+    EngineSwitch incoming;
+    incoming.settings = getPathSettings(apvts);
+    incoming.sampleRate = getProcessingSampleRate();
+
+    designSets(incoming.settings, incoming.sampleRate, floatEngine.switchDesigns, incoming.floatA, incoming.floatB);
+    designSets(incoming.settings, incoming.sampleRate, doubleEngine.switchDesigns, incoming.doubleA, incoming.doubleB);
+
+    const juce::SpinLock::ScopedLockType lock(switchLock);
+    pendingSwitch = incoming;
+    switchPending = true;
+}
+
+void OloEQAudioProcessor::takeEngineSwitch()
+{
+    if (crossfadeRemaining > 0 || ! switchPending.load())
+        return;
+
+    // The loading thread only holds the lock to copy a switch in, if it
+    // has it now the switch is taken on the next block
+    const juce::SpinLock::ScopedTryLockType lock(switchLock);
+
+    if (! lock.isLocked())
+        return;
+
+    switchPending = false;
+    const auto& incoming = pendingSwitch;
+
+    // The other modes, and a cascade that runs at another rate than the
+    // switch was designed for, ramp to the new settings as the smoothers
+    // already do since beginBlock set them as the targets
+    if (activeMode != Mode_Biquad || incoming.sampleRate != processingSampleRate)
+        return;
+
+    // The crossfade takes the place of the ramp, anything set since the
+    // load still ramps from the loaded settings
+    resetSmoothing(incoming.settings);
+    setSmoothingTargets(targetSettings);
+
+    if (activePrecision == Precision_Double)
+        startCrossfade(doubleEngine, incoming.settings, incoming.doubleA, incoming.doubleB);
+    else
+        startCrossfade(floatEngine, incoming.settings, incoming.floatA, incoming.floatB);
+
+    crossfadeLength = juce::jmax(1, juce::roundToInt(crossfadeSeconds * processingSampleRate));
+    crossfadeRemaining = crossfadeLength;
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::startCrossfade(Engine<SampleType>& engine, const PathSettings& settings,
+                                         const CascadeDesign<SampleType>& designA, const CascadeDesign<SampleType>& designB)
+{
+    // The outgoing filter carries on from the cascade's state, and the
+    // cascade takes the new designs on that same state
+    engine.fadeCascade.copyFrom(engine.cascade);
+
+    engine.designedSettings = settings;
+    engine.designA = designA;
+    engine.designB = designB;
+    applyDesigns(engine);
+}
+
+//==============================================================================
+// Parameter helpers
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, ParameterSet set)
+{
+    auto load = [&apvts, set](const char* name) { return apvts.getRawParameterValue(getParameterId(name, set))->load(); };
+
+    ChainSettings settings;
+    settings.lowCutFreq = load("LowCut Freq");
+    settings.highCutFreq = load("HighCut Freq");
+    settings.peakFreq = load("Peak Freq");
+    settings.peakGainInDecibels = load("Peak Gain");
+    settings.peakQuality = load("Peak Quality");
+    settings.lowCutSlope = static_cast<Slope>(load("LowCut Slope"));
+    settings.highCutSlope = static_cast<Slope>(load("HighCut Slope"));
+
+    // The SVF bell is always the bilinear one, so only the biquad and FIR
+    // engines (and the curve drawn for them) use the matched design
+    if (static_cast<ProcessingMode>(apvts.getRawParameterValue("Processing Mode")->load()) != Mode_Svf)
+        settings.peakDesign = static_cast<PeakDesign>(apvts.getRawParameterValue("Peak Design")->load());
+
+    return settings;
+}
+
+PathSettings getPathSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    PathSettings settings;
+    settings.a = getChainSettings(apvts, ParameterSet_A);
+    settings.b = getChainSettings(apvts, ParameterSet_B);
+    settings.stereoMode = static_cast<StereoMode>(apvts.getRawParameterValue("Stereo Mode")->load());
+
+    auto isLinked = [&apvts](const char* name) { return apvts.getRawParameterValue(name)->load() > 0.5f; };
+
+    linkBands(settings, isLinked("LowCut Link"), isLinked("Peak Link"), isLinked("HighCut Link"));
+    return settings;
+}
+
+BandSettingsArray getBandSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    BandSettingsArray bands;
+
+    for (int band = 0; band < maxEngineBands; ++band)
+    {
+        auto load = [&apvts, band](const char* name)
+        {
+            return apvts.getRawParameterValue(getBandParameterId(band, name))->load();
+        };
+
+        auto& settings = bands[static_cast<size_t>(band)];
+        settings.enabled = load("On") > 0.5f;
+        settings.type = static_cast<BandType>(load("Type"));
+        settings.frequency = load("Freq");
+        settings.gainInDecibels = load("Gain");
+        settings.quality = load("Quality");
+        settings.order = static_cast<int>(load("Slope")) + 1;
+    }
+
+    return bands;
+}
+
+void linkBands(PathSettings& settings, bool lowCut, bool peak, bool highCut)
+{
+    if (lowCut)
+    {
+        settings.b.lowCutFreq = settings.a.lowCutFreq;
+        settings.b.lowCutSlope = settings.a.lowCutSlope;
+    }
+
+    if (peak)
+    {
+        settings.b.peakFreq = settings.a.peakFreq;
+        settings.b.peakGainInDecibels = settings.a.peakGainInDecibels;
+        settings.b.peakQuality = settings.a.peakQuality;
+    }
+
+    if (highCut)
+    {
+        settings.b.highCutFreq = settings.a.highCutFreq;
+        settings.b.highCutSlope = settings.a.highCutSlope;
+    }
+}
+
+Coefficients makePeakFilter(const ChainSettings& settings, double sampleRate)
+{
+    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(
+        sampleRate, settings.peakFreq, settings.peakQuality,
+        juce::Decibels::decibelsToGain(settings.peakGainInDecibels)
+    );
+}
+
+//==============================================================================
+// Cascade design
+template <typename SampleType>
+CascadeDesign<SampleType> makeCascadeDesign(const ChainSettings& settings, double sampleRate, CoefficientCache<SampleType>* cache,
+                                            const CoefficientTables<SampleType>* tables)
+{
+    CascadeDesign<SampleType> design;
+
+    for (auto band : cascadeBands)
+        designBand(design, band, settings, sampleRate, cache, tables);
+
+    return design;
+}
+
+template <typename SampleType>
+CascadeDesign<SampleType> deriveCascadeDesign(const ChainSettings& settings, double sampleRate,
+                                              const ChainSettings& reference, const CascadeDesign<SampleType>& referenceDesign,
+                                              CoefficientCache<SampleType>* cache, const CoefficientTables<SampleType>* tables)
+{
+    CascadeDesign<SampleType> design;
+
+    for (auto band : cascadeBands)
+    {
+        if (! isSameBand(band, settings, reference))
+        {
+            designBand(design, band, settings, sampleRate, cache, tables);
+            continue;
+        }
+
+        const auto [first, last] = getBandSlots(band);
+        std::copy(referenceDesign.sections.begin() + first, referenceDesign.sections.begin() + last, design.sections.begin() + first);
+        std::copy(referenceDesign.active.begin() + first, referenceDesign.active.begin() + last, design.active.begin() + first);
+    }
+
+    return design;
+}
+
+template <typename SampleType>
+void applyCascadeDesign(BiquadCascade<SampleType>& cascade, const CascadeDesign<SampleType>& design)
+{
+    for (int slot = 0; slot < NumCascadeSlots; ++slot)
+    {
+        if (design.active[static_cast<size_t>(slot)])
+            cascade.setSlot(slot, design.sections[static_cast<size_t>(slot)]);
+
+        cascade.setSlotActive(slot, design.active[static_cast<size_t>(slot)]);
+    }
+}
+
+template CascadeDesign<float> makeCascadeDesign<float>(const ChainSettings&, double, CoefficientCache<float>*,
+                                                      const CoefficientTables<float>*);
+template CascadeDesign<double> makeCascadeDesign<double>(const ChainSettings&, double, CoefficientCache<double>*,
+                                                        const CoefficientTables<double>*);
+template CascadeDesign<float> deriveCascadeDesign<float>(const ChainSettings&, double, const ChainSettings&, const CascadeDesign<float>&,
+                                                        CoefficientCache<float>*, const CoefficientTables<float>*);
+template CascadeDesign<double> deriveCascadeDesign<double>(const ChainSettings&, double, const ChainSettings&, const CascadeDesign<double>&,
+                                                          CoefficientCache<double>*, const CoefficientTables<double>*);
+template void applyCascadeDesign<float>(BiquadCascade<float>&, const CascadeDesign<float>&);
+template void applyCascadeDesign<double>(BiquadCascade<double>&, const CascadeDesign<double>&);
+
+void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+{
+    *old = *replacements;
+}
+
+//==============================================================================
+// Parameter smoothing
+void OloEQAudioProcessor::ChainSmoother::reset(double sampleRate)
+{
+    for (auto* smoother : { &peakFreq, &peakQuality, &lowCutFreq, &highCutFreq })
+        smoother->reset(sampleRate, smoothingTimeSeconds);
+
+    peakGain.reset(sampleRate, smoothingTimeSeconds);
+}
+
+void OloEQAudioProcessor::ChainSmoother::setCurrentAndTargetValues(const ChainSettings& settings)
+{
+    peakFreq.setCurrentAndTargetValue(settings.peakFreq);
+    peakGain.setCurrentAndTargetValue(settings.peakGainInDecibels);
+    peakQuality.setCurrentAndTargetValue(settings.peakQuality);
+    lowCutFreq.setCurrentAndTargetValue(settings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(settings.highCutFreq);
+}
+
+void OloEQAudioProcessor::ChainSmoother::setTargetValues(const ChainSettings& settings)
+{
+    peakFreq.setTargetValue(settings.peakFreq);
+    peakGain.setTargetValue(settings.peakGainInDecibels);
+    peakQuality.setTargetValue(settings.peakQuality);
+    lowCutFreq.setTargetValue(settings.lowCutFreq);
+    highCutFreq.setTargetValue(settings.highCutFreq);
+}
+
+ChainSettings OloEQAudioProcessor::ChainSmoother::skip(const ChainSettings& targets, int numSamples)
+{
+    auto settings = targets;
+    settings.peakFreq = peakFreq.skip(numSamples);
+    settings.peakGainInDecibels = peakGain.skip(numSamples);
+    settings.peakQuality = peakQuality.skip(numSamples);
+    settings.lowCutFreq = lowCutFreq.skip(numSamples);
+    settings.highCutFreq = highCutFreq.skip(numSamples);
+    return settings;
+}
+
+bool OloEQAudioProcessor::ChainSmoother::isSmoothing() const
+{
+    return peakFreq.isSmoothing() || peakGain.isSmoothing() || peakQuality.isSmoothing()
+        || lowCutFreq.isSmoothing() || highCutFreq.isSmoothing();
+}
+
+void OloEQAudioProcessor::BandSmoother::reset(double sampleRate)
+{
+    for (size_t i = 0; i < maxEngineBands; ++i)
+    {
+        frequency[i].reset(sampleRate, smoothingTimeSeconds);
+        quality[i].reset(sampleRate, smoothingTimeSeconds);
+        gain[i].reset(sampleRate, smoothingTimeSeconds);
+    }
+}
+
+void OloEQAudioProcessor::BandSmoother::setCurrentAndTargetValues(const BandSettingsArray& bands)
+{
+    for (size_t i = 0; i < maxEngineBands; ++i)
+    {
+        frequency[i].setCurrentAndTargetValue(bands[i].frequency);
+        quality[i].setCurrentAndTargetValue(bands[i].quality);
+        gain[i].setCurrentAndTargetValue(bands[i].gainInDecibels);
+    }
+}
+
+void OloEQAudioProcessor::BandSmoother::setTargetValues(const BandSettingsArray& bands)
+{
+    for (size_t i = 0; i < maxEngineBands; ++i)
+    {
+        if (bands[i].enabled)
+        {
+            frequency[i].setTargetValue(bands[i].frequency);
+            quality[i].setTargetValue(bands[i].quality);
+            gain[i].setTargetValue(bands[i].gainInDecibels);
+        }
+        else
+        {
+            frequency[i].setCurrentAndTargetValue(bands[i].frequency);
+            quality[i].setCurrentAndTargetValue(bands[i].quality);
+            gain[i].setCurrentAndTargetValue(bands[i].gainInDecibels);
+        }
+    }
+}
+
+BandSettingsArray OloEQAudioProcessor::BandSmoother::skip(const BandSettingsArray& targets, int numSamples)
+{
+    auto bands = targets;
+
+    for (size_t i = 0; i < maxEngineBands; ++i)
+    {
+        bands[i].frequency = frequency[i].skip(numSamples);
+        bands[i].quality = quality[i].skip(numSamples);
+        bands[i].gainInDecibels = gain[i].skip(numSamples);
+    }
+
+    return bands;
+}
+
+bool OloEQAudioProcessor::BandSmoother::isSmoothing() const
+{
+    for (size_t i = 0; i < maxEngineBands; ++i)
+        if (frequency[i].isSmoothing() || quality[i].isSmoothing() || gain[i].isSmoothing())
+            return true;
+
+    return false;
+}
+
+void OloEQAudioProcessor::resetSmoothing(const PathSettings& settings)
+{
+    smootherA.setCurrentAndTargetValues(settings.a);
+    smootherB.setCurrentAndTargetValues(settings.b);
+}
+
+bool OloEQAudioProcessor::isSmoothing() const
+{
+    return smootherA.isSmoothing() || smootherB.isSmoothing();
+}
+
+void OloEQAudioProcessor::setSmoothingTargets(const PathSettings& settings)
+{
+    smootherA.setTargetValues(settings.a);
+    smootherB.setTargetValues(settings.b);
+    targetSettings = settings;
+}
+
+PathSettings OloEQAudioProcessor::advanceSmoothing(int numSamples)
+{
+    auto settings = targetSettings;
+    settings.a = smootherA.skip(targetSettings.a, numSamples);
+    settings.b = smootherB.skip(targetSettings.b, numSamples);
+    return settings;
+}
+
+//==============================================================================
+// Filter updates
+void OloEQAudioProcessor::updateFilters()
+{
+    auto settings = getPathSettings(apvts);
+
+    resetSmoothing(settings);
+    samplesUntilControlUpdate = 0;
+
+    targetSettings = settings;
+    designEngine(floatEngine, settings);
+    designEngine(doubleEngine, settings);
+
+    bandTargets = getBandSettings(apvts);
+    bandSmoother.setCurrentAndTargetValues(bandTargets);
+    samplesUntilBandUpdate = 0;
+
+    updateBands(floatEngine.bands, bandTargets);
+    updateBands(doubleEngine.bands, bandTargets);
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::updateBands(BandEngine<SampleType>& bands, const BandSettingsArray& settings)
+{
+    // setBand skips the bands that did not move
+    for (int index = 0; index < maxEngineBands; ++index)
+        bands.setBand(index, settings[static_cast<size_t>(index)]);
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::designEngine(Engine<SampleType>& engine, const PathSettings& settings)
+{
+    // Also called off the audio thread, so the instance's cache is left to
+    // the control-rate updates and only the shared one is asked
+    designPaths(engine, settings, false);
+    updateSvf(engine.svf, settings.a);
+    updateSvf(engine.svfB, settings.b);
+
+    // Expanded on the spot so the parallel form runs from the first block.
+    // This supersedes anything the designer is still working on.
+    if constexpr (std::is_same_v<SampleType, double>)
+    {
+        if (activeMode == Mode_Parallel)
+        {
+            loadParallelExpansions(ParallelDesigner::expand(makeParallelRequest()));
+            parallelRequestPending = false;
+            parallelFormActive = parallelCascade.isValid();
+        }
+    }
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::updateFilters(Engine<SampleType>& engine, const PathSettings& settings)
+{
+    // Only redesign when something actually moved since the last update
+    if (settings == engine.designedSettings)
+        return;
+
+    designPaths(engine, settings, true);
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::designPaths(Engine<SampleType>& engine, const PathSettings& settings, bool useCache)
+{
+    auto* cache = useCache ? &engine.coefficientCache : &engine.sharedDesigns;
+    auto* tables = useCache && useCoefficientTables ? &engine.coefficientTables : nullptr;
+
+    engine.designedSettings = settings;
+    engine.designA = makeCascadeDesign(settings.a, processingSampleRate, cache, tables);
+
+    // Set B is only designed when a channel runs it, and then only the bands
+    // that differ from set A. Both sets still run in one pass, on their own
+    // coefficient lanes.
+    if (engine.cascade.getNumChannels() >= 2 && usesSetB(settings.stereoMode) && settings.b != settings.a)
+        engine.designB = deriveCascadeDesign(settings.b, processingSampleRate, settings.a, engine.designA, cache, tables);
+    else
+        engine.designB = engine.designA;
+
+    applyDesigns(engine);
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::applyDesigns(Engine<SampleType>& engine)
+{
+    if (engine.designedSettings.stereoMode == StereoMode_Stereo || engine.cascade.getNumChannels() < 2)
+        applyCascadeDesign(engine.cascade, engine.designA);
+    else
+        applyPathDesigns(engine.cascade, engine.designedSettings.stereoMode, engine.designA, engine.designB);
+}
+
+ParallelDesigner::Request OloEQAudioProcessor::makeParallelRequest()
+{
+    ParallelDesigner::Request request;
+    request.generation = ++parallelGeneration;
+
+    // Branches are tagged with their slot, so a band that moves keeps its
+    // branches' state
+    const std::array<const CascadeDesign<double>*, ParallelDesigner::numPaths> designs{ &doubleEngine.designA,
+                                                                                       &doubleEngine.designB };
+
+    for (size_t path = 0; path < designs.size(); ++path)
+    {
+        auto& numSections = request.numSections[path];
+
+        for (size_t slot = 0; slot < NumCascadeSlots; ++slot)
+        {
+            if (designs[path]->active[slot])
+            {
+                request.sections[path][static_cast<size_t>(numSections)] = designs[path]->sections[slot];
+                request.ids[path][static_cast<size_t>(numSections++)] = static_cast<int>(slot);
+            }
+        }
+    }
+
+    return request;
+}
+
+void OloEQAudioProcessor::loadParallelExpansions(const ParallelDesigner::Result& result)
+{
+    const auto numChannels = parallelCascade.getNumChannels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        switch (getChannelPath(doubleEngine.designedSettings.stereoMode, channel, numChannels))
+        {
+            case ChannelPath::a:      parallelCascade.setExpansion(channel, result.expansions[0]); break;
+            case ChannelPath::b:      parallelCascade.setExpansion(channel, result.expansions[1]); break;
+            case ChannelPath::bypass:
+            default:                  parallelCascade.setExpansion(channel, ParallelExpansion{}); break;
+        }
+    }
+}
+
+template <typename SampleType>
+void OloEQAudioProcessor::updateSvf(SvfEngine<SampleType>& svf, const ChainSettings& settings)
+{
+    svf.setLowCut(settings.lowCutFreq, 2 * settings.lowCutSlope + 1);
+    svf.setPeak(settings.peakFreq, settings.peakQuality, settings.peakGainInDecibels);
+    svf.setHighCut(settings.highCutFreq, 2 * settings.highCutSlope + 1);
+}
+
+//==============================================================================
+// Create parameter layout
+juce::AudioProcessorValueTreeState::ParameterLayout
+OloEQAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    juce::StringArray slopeChoices;
+    for (int i = 0; i < 4; ++i)
+        slopeChoices.add(juce::String(12 + i * 12) + " db/Oct");
+
+    // The same band parameters for both sets
+    for (auto set : { ParameterSet_A, ParameterSet_B })
+    {
+        auto addFloat = [&layout, set](const char* name, juce::NormalisableRange<float> range, float defaultValue)
+        {
+            const auto id = getParameterId(name, set);
+            layout.add(std::make_unique<juce::AudioParameterFloat>(id, id, range, defaultValue));
+        };
+
+        addFloat("LowCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f);
+        addFloat("HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f);
+        addFloat("Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f);
+        addFloat("Peak Gain", juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.f);
+        addFloat("Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f);
+
+        const auto lowCutSlope = getParameterId("LowCut Slope", set);
+        const auto highCutSlope = getParameterId("HighCut Slope", set);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(lowCutSlope, lowCutSlope, slopeChoices, 0));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(highCutSlope, highCutSlope, slopeChoices, 0));
+    }
+
+    // Linked bands of set B follow set A
+    for (auto* link : { "LowCut Link", "Peak Link", "HighCut Link" })
+        layout.add(std::make_unique<juce::AudioParameterBool>(link, link, true));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Stereo Mode", "Stereo Mode", juce::StringArray{ "Stereo", "Mid/Side", "Left Only", "Right Only", "Dual Mono" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Peak Design", "Peak Design", juce::StringArray{ "RBJ", "Matched" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Processing Mode", "Processing Mode", juce::StringArray{ "Biquad", "SVF", "Linear Phase", "Minimum Phase", "Parallel Biquad" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Precision", "Precision", juce::StringArray{ "Float", "Double" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Oversampling", "Oversampling", juce::StringArray{ "Off", "2x", "4x", "8x" }, 0));
+
+    juce::StringArray lengthChoices;
+    for (int length = FirEngine::minLength; length <= FirEngine::maxLength; length *= 2)
+        lengthChoices.add(juce::String(length) + " taps");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "FIR Length", "FIR Length", lengthChoices, 1));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Coefficient Tables", "Coefficient Tables", juce::StringArray{ "Off", "On" }, 0));
+
+    // Runs the biquad cascade through the time-blocked kernel, which is the
+    // faster one on mono and narrow buses
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Time Blocking", "Time Blocking", juce::StringArray{ "Off", "On" }, 0));
+
+    // Offline renders run in double with at least 4x oversampling and twice
+    // the FIR length. Whichever of playback and renders has less latency is
+    // delayed to match the other, so it is off by default and sessions keep
+    // the latency of the mode they run.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Render Quality", "Render Quality", juce::StringArray{ "Off", "On" }, 0));
+
+    // Shares the biquad cascade's channels out between cores on buses wide
+    // enough for it to pay off, narrower ones always stay on one thread
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "Channel Threads", "Channel Threads", juce::StringArray{ "Off", "Auto" }, 1));
+
+    // The band engine's bands, all off by default and spread evenly in log
+    // frequency across the audio range. Cut slopes go in 6 dB steps.
+    juce::StringArray bandTypeChoices{ "Peak", "Low Shelf", "High Shelf", "Notch", "Low Cut", "High Cut" };
+    juce::StringArray bandSlopeChoices;
+    for (int order = 1; order <= BandEngine<float>::maxCutOrder; ++order)
+        bandSlopeChoices.add(juce::String(order * 6) + " db/Oct");
+
+    for (int band = 0; band < maxEngineBands; ++band)
+    {
+        auto id = [band](const char* name) { return getBandParameterId(band, name); };
+        const auto frequency = 20.f * std::pow(1000.f, (static_cast<float>(band) + 0.5f) / static_cast<float>(maxEngineBands));
+
+        layout.add(std::make_unique<juce::AudioParameterBool>(id("On"), id("On"), false));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("Type"), id("Type"), bandTypeChoices, 0));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            id("Freq"), id("Freq"), juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), std::round(frequency)));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            id("Gain"), id("Gain"), juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            id("Quality"), id("Quality"), juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("Slope"), id("Slope"), bandSlopeChoices, 1));
+    }
 
     return layout;
 }
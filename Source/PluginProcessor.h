@@ -11,6 +11,17 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BiquadCascade.h"
+#include "CoefficientDesign.h"
+#include "CoefficientCache.h"
+#include "SharedCoefficientCache.h"
+#include "CoefficientTables.h"
+#include "BandEngine.h"
+#include "SvfEngine.h"
+#include "FirEngine.h"
+#include "ParallelCascade.h"
+#include "ChannelWorkerPool.h"
+#include "BinaryState.h"
 
 //==============================================================================
 // Filter slope options
@@ -22,6 +33,58 @@ enum Slope
     Slope_48
 };
 
+//==============================================================================
+// Processing engines. The parallel form of the biquad cascade always runs
+// in double, whatever the precision setting.
+enum ProcessingMode
+{
+    Mode_Biquad,
+    Mode_Svf,
+    Mode_LinearPhase,
+    Mode_MinimumPhase,
+    Mode_Parallel
+};
+
+//==============================================================================
+// Internal precision used for float host buffers. Double host buffers are
+// always processed in double.
+enum Precision
+{
+    Precision_Float,
+    Precision_Double
+};
+
+//==============================================================================
+// Peak band designs
+enum PeakDesign
+{
+    PeakDesign_Rbj,
+    PeakDesign_Matched
+};
+
+//==============================================================================
+// How the two parameter sets map onto a stereo pair. Mid/Side runs set A
+// on the mid and set B on the side channel, Dual Mono set A on the left and
+// set B on the right. The single-channel modes run set A on one side and
+// pass the other through.
+enum StereoMode
+{
+    StereoMode_Stereo,
+    StereoMode_MidSide,
+    StereoMode_LeftOnly,
+    StereoMode_RightOnly,
+    StereoMode_DualMono
+};
+
+// The main parameters and the second set, whose IDs end in " B"
+enum ParameterSet
+{
+    ParameterSet_A,
+    ParameterSet_B
+};
+
+juce::String getParameterId(const char* name, ParameterSet set);
+
 //==============================================================================
 // All chain settings
 struct ChainSettings
@@ -29,11 +92,49 @@ struct ChainSettings
     float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
     float lowCutFreq{ 0 }, highCutFreq{ 0 };
     Slope lowCutSlope{ Slope_12 }, highCutSlope{ Slope_12 };
+    PeakDesign peakDesign{ PeakDesign_Rbj };
+
+    bool operator==(const ChainSettings& other) const
+    {
+        return peakFreq == other.peakFreq && peakGainInDecibels == other.peakGainInDecibels
+            && peakQuality == other.peakQuality && lowCutFreq == other.lowCutFreq
+            && highCutFreq == other.highCutFreq && lowCutSlope == other.lowCutSlope
+            && highCutSlope == other.highCutSlope && peakDesign == other.peakDesign;
+    }
+
+    bool operator!=(const ChainSettings& other) const { return ! operator==(other); }
 };
 
 //==============================================================================
-// Retrieve current chain settings from the APVTS
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+// Settings of both parameter sets and how they map onto the channels
+struct PathSettings
+{
+    ChainSettings a, b;
+    StereoMode stereoMode{ StereoMode_Stereo };
+
+    bool operator==(const PathSettings& other) const
+    {
+        return a == other.a && b == other.b && stereoMode == other.stereoMode;
+    }
+
+    bool operator!=(const PathSettings& other) const { return ! operator==(other); }
+};
+
+//==============================================================================
+// Retrieve current chain settings from the APVTS. In the path settings,
+// bands whose Link parameter is on take their set B values from set A.
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, ParameterSet set = ParameterSet_A);
+PathSettings getPathSettings(juce::AudioProcessorValueTreeState& apvts);
+
+// Gives set B the set A values of the linked bands
+void linkBands(PathSettings& settings, bool lowCut, bool peak, bool highCut);
+
+//==============================================================================
+// The band engine's bands follow the main three on every channel the
+// stereo mode filters. Their parameter IDs are "Band <n> <name>", counting
+// from 1.
+juce::String getBandParameterId(int band, const char* name);
+BandSettingsArray getBandSettings(juce::AudioProcessorValueTreeState& apvts);
 
 //==============================================================================
 // Type aliases for DSP
@@ -100,9 +201,50 @@ inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleR
     );
 }
 
+//==============================================================================
+// Cascade slots used by the processing engine, laid out in MonoChain order
+enum CascadeSlots
+{
+    LowCutSlot      = 0,
+    PeakSlot        = 4,
+    HighCutSlot     = 5,
+    NumCascadeSlots = 9
+};
+
+// Every slot's coefficients and whether it is in use for a set of settings
+template <typename SampleType>
+struct CascadeDesign
+{
+    std::array<BiquadSection<SampleType>, NumCascadeSlots> sections;
+    std::array<bool, NumCascadeSlots> active{};
+};
+
+// Bands are looked up in the tables when given ones prepared for this
+// rate, otherwise taken from the cache when one is given, which quantises
+// their parameters first
+template <typename SampleType>
+CascadeDesign<SampleType> makeCascadeDesign(const ChainSettings& chainSettings, double sampleRate,
+                                            CoefficientCache<SampleType>* cache = nullptr,
+                                            const CoefficientTables<SampleType>* tables = nullptr);
+
+// As makeCascadeDesign, but bands set up the same as in the reference
+// settings are copied from the reference design rather than designed again
+template <typename SampleType>
+CascadeDesign<SampleType> deriveCascadeDesign(const ChainSettings& chainSettings, double sampleRate,
+                                              const ChainSettings& reference, const CascadeDesign<SampleType>& referenceDesign,
+                                              CoefficientCache<SampleType>* cache = nullptr,
+                                              const CoefficientTables<SampleType>* tables = nullptr);
+
+template <typename SampleType>
+void applyCascadeDesign(BiquadCascade<SampleType>& cascade, const CascadeDesign<SampleType>& design);
+
 //==============================================================================
 // Main processor class
-class OloEQAudioProcessor : public juce::AudioProcessor
+struct PresetSettings;
+
+class OloEQAudioProcessor : public juce::AudioProcessor,
+                            private juce::AudioProcessorValueTreeState::Listener,
+                            private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -118,6 +260,8 @@ public:
 #endif
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -142,19 +286,305 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
+    // Sets the preset's parameters and crossfades to it, as a state load
+    // does. Not for the audio thread.
+    void loadPreset(const PresetSettings& settings);
+
     //==============================================================================
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout() };
 
+    //==============================================================================
+    // Kernel selection is resolved in prepareToPlay. Forcing an instruction
+    // set the CPU does not support falls back to automatic selection.
+    void setForcedKernelIsa(std::optional<KernelIsa> isa) { forcedKernelIsa = isa; }
+    KernelIsa getActiveKernelIsa() const { return activeKernelIsa.load(); }
+
+    // Rate the filters are designed for, the host rate times the selected
+    // oversampling factor. The FIR modes always run at the host rate.
+    double getProcessingSampleRate() const;
+
+    static constexpr int maxOversamplingOrder = 3;
+
+    // Coefficient cache counters for the engine at the active precision
+    int getCoefficientCacheHits() const;
+    int getCoefficientCacheMisses() const;
+
+    // Groups the biquad cascade's channels are split into at the precision
+    // when Channel Threads is on, as resolved in prepareToPlay
+    int getNumChannelGroups(Precision precision) const noexcept { return numChannelGroups[static_cast<size_t>(precision)]; }
+
 private:
     //==============================================================================
-    MonoChain leftChain, rightChain;
+    // Saves and restores the parameters in the binary state format.
+    // Declared after apvts, whose parameters it collects.
+    BinaryStateLayout binaryState{ *this };
+
+    //==============================================================================
+    // Both engines at one sample type, with the settings last designed into
+    // the cascade and the designs of both sets for them, the bands designed
+    // so far, the coefficient tables and one oversampler per factor (2x, 4x,
+    // 8x). The SVF engine has one instance per parameter set. sharedDesigns
+    // is never prepared, so it keeps nothing and only goes through the
+    // shared cache, which is safe from any thread. switchDesigns is the same
+    // for the thread that designs crossfaded switches. During a crossfade
+    // the outgoing filter runs on in fadeCascade, on a copy of the input in
+    // fadeBuffer. The IIR modes run the band engine after the main bands.
+    template <typename SampleType>
+    struct Engine
+    {
+        BiquadCascade<SampleType> cascade, fadeCascade;
+        BandEngine<SampleType> bands;
+        juce::AudioBuffer<SampleType> fadeBuffer;
+        SvfEngine<SampleType> svf, svfB;
+        PathSettings designedSettings;
+        CascadeDesign<SampleType> designA, designB;
+        CoefficientCache<SampleType> coefficientCache, sharedDesigns, switchDesigns;
+        CoefficientTables<SampleType> coefficientTables;
+
+        std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, maxOversamplingOrder> oversamplers;
+    };
+
+    // Designed bands shared with every other instance in the process,
+    // declared first so it outlives the engines that point to it
+    juce::SharedResourcePointer<SharedCoefficientCaches> sharedCoefficientCaches;
+
+    Engine<float> floatEngine;
+    Engine<double> doubleEngine;
+
+    // Float host buffers are converted into this when running in double
+    juce::AudioBuffer<double> conversionBuffer;
+
+    // Delays host buffers of each type by the latency the active engine is
+    // short of the reported one
+    using PaddingDelay = juce::dsp::DelayLineInterpolationTypes::None;
+    juce::dsp::DelayLine<float, PaddingDelay> floatLatencyPadding;
+    juce::dsp::DelayLine<double, PaddingDelay> doubleLatencyPadding;
+    int latencyPadding = 0;
+
+    // The audio thread changes the latency, the message thread reports it
+    std::atomic<int> latencyToReport{ 0 };
+
+    ProcessingMode activeMode = Mode_Biquad;
+    Precision activePrecision = Precision_Float;
+    StereoMode activeStereoMode = StereoMode_Stereo;
+
+    int activeOversamplingOrder = 0;
+    bool useCoefficientTables = false;
+    double processingSampleRate = 44100.0;
+    int maxHostBlockSize = 0;
+
+    // With Render Quality on, offline renders run in double with more
+    // oversampling and longer FIR kernels than playback, and both report the
+    // larger of the two latencies
+    bool renderQualityEnabled = false;
+    bool renderingAtHighQuality = false;
+
+    // The FIR engines are shared by both precisions, with the settings,
+    // length and phase of the last kernel each accepted. The second one runs
+    // the channel of the stereo pair that takes set B, or a flat kernel on
+    // the channel the single-channel modes pass through, so that channel is
+    // delayed by the same latency. Both restart together on a new length or
+    // phase, which is when the latency changes.
+    FirEngine firEngine, firEngineB;
+    ChainSettings firSettings, firSettingsB;
+    BandSettingsArray firBands, firBandsB;
+    bool firFlatB = false;
+    int firLength = FirEngine::minLength, firLengthB = FirEngine::minLength;
+    FirPhase firPhase = FirPhase::linear, firPhaseB = FirPhase::linear;
+
+    // The parallel form of the double engine's cascade. Its expansions come
+    // from the designer, tagged with a generation so that stale ones are
+    // dropped, and the serial cascade stands in while they are invalid.
+    ParallelCascade parallelCascade;
+    ParallelDesigner parallelDesigner;
+    juce::uint32 parallelGeneration = 0;
+    bool parallelRequestPending = false;
+    bool parallelFormActive = false;
+
+    // The FIR engine and the parallel designer only run their threads while
+    // their mode is selected. Mode changes may arrive on the audio thread, so
+    // the threads are started and stopped from the message thread.
+    juce::CriticalSection backgroundThreadLock;
+    bool backgroundThreadsPrepared = false;
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    void updateBackgroundThreads();
+
+    // State loads and presets crossfade to the new settings rather than
+    // jumping or ramping through every setting in between. Both precisions
+    // are designed on the loading thread and handed over like the parallel
+    // expansions. Later loads replace one still pending, and wait for a
+    // running crossfade to finish.
+    struct EngineSwitch
+    {
+        PathSettings settings;
+        double sampleRate = 0.0;
+        CascadeDesign<float> floatA, floatB;
+        CascadeDesign<double> doubleA, doubleB;
+    };
+
+    static constexpr double crossfadeSeconds = 0.02;
+
+    juce::SpinLock switchLock;
+    EngineSwitch pendingSwitch;
+    std::atomic<bool> switchPending{ false };
+    int crossfadeLength = 0, crossfadeRemaining = 0;
+
+    void requestEngineSwitch();
+    void takeEngineSwitch();
+
+    template <typename SampleType>
+    void startCrossfade(Engine<SampleType>& engine, const PathSettings& pathSettings,
+                        const CascadeDesign<SampleType>& designA, const CascadeDesign<SampleType>& designB);
+
+    template <typename SampleType>
+    void processCrossfade(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block);
+
+    std::optional<KernelIsa> forcedKernelIsa;
+    std::atomic<KernelIsa> activeKernelIsa{ KernelIsa::scalar };
+
+    // Wide buses split the biquad cascade's channels into groups, one per
+    // core. Groups are whole channel group alignments of the cascade, which
+    // hold twice as many float channels as double ones, so the count is kept
+    // per precision. Workers are only started when there is more than one
+    // group at either precision.
+    ChannelWorkerPool channelWorkers;
+    std::array<int, 2> numChannelGroups{ 1, 1 };
+    bool useChannelWorkers = false;
+
+    //==============================================================================
+    // Parameter smoothing. Coefficients are redesigned every controlInterval
+    // samples while any value is still ramping, regardless of block size.
+    static constexpr int controlInterval = 32;
+    static constexpr int coefficientCacheCapacity = 4096;
+    static constexpr double smoothingTimeSeconds = 0.05;
+
+    // Oversampling order renders are raised to, and how many times longer
+    // their FIR kernels are, as a power of two
+    static constexpr int renderOversamplingOrder = 2;
+    static constexpr int renderFirLengthSteps = 1;
+
+    // Fewer channels per group than this and waking the workers costs more
+    // than it saves, so such buses stay on the audio thread
+    static constexpr int minChannelsPerGroup = 8;
+    static constexpr int maxBusChannels = 64;
+
+    using FrequencySmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    using LinearSmoother    = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+
+    // The smoothers of one parameter set. Slopes switch sections in or out,
+    // so they are taken from the targets as they are.
+    struct ChainSmoother
+    {
+        FrequencySmoother peakFreq, peakQuality, lowCutFreq, highCutFreq;
+        LinearSmoother peakGain;
+
+        void reset(double sampleRate);
+        void setCurrentAndTargetValues(const ChainSettings& chainSettings);
+        void setTargetValues(const ChainSettings& chainSettings);
+        ChainSettings skip(const ChainSettings& targets, int numSamples);
+        bool isSmoothing() const;
+    };
+
+    ChainSmoother smootherA, smootherB;
+
+    PathSettings targetSettings;
+    int samplesUntilControlUpdate = 0;
+
+    // The band engine's bands ramp the same way, on their own control-rate
+    // count. Disabled bands jump to their targets, so they only ramp from
+    // the moment they are switched on.
+    struct BandSmoother
+    {
+        std::array<FrequencySmoother, maxEngineBands> frequency, quality;
+        std::array<LinearSmoother, maxEngineBands> gain;
+
+        void reset(double sampleRate);
+        void setCurrentAndTargetValues(const BandSettingsArray& bands);
+        void setTargetValues(const BandSettingsArray& bands);
+        BandSettingsArray skip(const BandSettingsArray& targets, int numSamples);
+        bool isSmoothing() const;
+    };
+
+    BandSmoother bandSmoother;
+    BandSettingsArray bandTargets;
+    int samplesUntilBandUpdate = 0;
+
+    void resetSmoothing(const PathSettings& pathSettings);
+    void setSmoothingTargets(const PathSettings& pathSettings);
+    PathSettings advanceSmoothing(int numSamples);
+    bool isSmoothing() const;
 
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
     void updateFilters();
 
+    template <typename SampleType>
+    void designEngine(Engine<SampleType>& engine, const PathSettings& pathSettings);
+
+    template <typename SampleType>
+    void updateFilters(Engine<SampleType>& engine, const PathSettings& pathSettings);
+
+    template <typename SampleType>
+    void designPaths(Engine<SampleType>& engine, const PathSettings& pathSettings, bool useCache);
+
+    // Loads the engine's designs for its designed settings into its cascade
+    template <typename SampleType>
+    static void applyDesigns(Engine<SampleType>& engine);
+
+    template <typename SampleType>
+    static void updateSvf(SvfEngine<SampleType>& svf, const ChainSettings& chainSettings);
+
+    template <typename SampleType>
+    static void updateBands(BandEngine<SampleType>& bandEngine, const BandSettingsArray& bands);
+
+    ParallelDesigner::Request makeParallelRequest();
+    void loadParallelExpansions(const ParallelDesigner::Result& result);
+
+    //==============================================================================
+    template <typename SampleType>
+    void prepareOversamplers(Engine<SampleType>& engine, int numChannels, int maxBlockSize);
+    void setOversamplingOrder(int order);
+    // Pads the active engine and has the message thread report the latency
+    void updateLatency();
+
+    // Settings for playback, or for renders with Render Quality on
+    int getEffectiveOversamplingOrder(ProcessingMode mode, bool highQualityRender = false) const;
+    int getFirLength(bool highQualityRender = false) const;
+    int getEngineLatency(ProcessingMode mode, int oversamplingOrder, int firKernelLength, FirPhase firKernelPhase) const;
+
+    template <typename SampleType>
+    void applyLatencyPadding(juce::dsp::DelayLine<SampleType, PaddingDelay>& delay, juce::AudioBuffer<SampleType>& buffer);
+
+    //==============================================================================
+    template <typename SampleType>
+    void beginBlock(juce::AudioBuffer<SampleType>& buffer, Precision precision);
+    void selectEngine(ProcessingMode mode, Precision precision, StereoMode stereoMode, int oversamplingOrder);
+    void processWithDoubleState(juce::AudioBuffer<float>& buffer);
+
+    template <typename SampleType>
+    void processWithOversampling(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block);
+
+    template <typename SampleType>
+    void process(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block);
+
+    template <typename SampleType>
+    void processBiquad(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block);
+
+    template <typename SampleType>
+    void processCascade(BiquadCascade<SampleType>& cascade, const juce::dsp::AudioBlock<SampleType>& block);
+
+    void processParallel(Engine<double>& engine, const juce::dsp::AudioBlock<double>& block);
+
+    template <typename SampleType>
+    void processSvf(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block);
+
+    template <typename SampleType>
+    void processFir(const juce::dsp::AudioBlock<SampleType>& block);
+
+    template <typename SampleType>
+    void processBands(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block);
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OloEQAudioProcessor)
 };
@@ -0,0 +1,548 @@
+/*
+  ==============================================================================
+
+    PresetLibrary.cpp
+    Implements the memory-mapped preset library.
+
+  ==============================================================================
+*/
+
+#include "PresetLibrary.h"
+#include "BinaryState.h"
+
+namespace
+{
+    constexpr juce::uint32 libraryMagic = 'O' | ('L' << 8) | ('P' << 16) | ('L' << 24);
+
+    char toLowerAscii(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+    int compareIgnoringCase(const char* a, const char* b)
+    {
+        for (;; ++a, ++b)
+        {
+            const auto ca = static_cast<unsigned char>(toLowerAscii(*a));
+            const auto cb = static_cast<unsigned char>(toLowerAscii(*b));
+
+            if (ca != cb || ca == 0)
+                return static_cast<int>(ca) - static_cast<int>(cb);
+        }
+    }
+
+    bool startsWithIgnoringCase(const char* text, const char* prefix)
+    {
+        for (; *prefix != 0; ++text, ++prefix)
+            if (toLowerAscii(*text) != toLowerAscii(*prefix))
+                return false;
+
+        return true;
+    }
+
+    bool containsIgnoringCase(const char* text, const char* part)
+    {
+        if (*part == 0)
+            return true;
+
+        for (; *text != 0; ++text)
+            if (toLowerAscii(*text) == toLowerAscii(*part) && startsWithIgnoringCase(text, part))
+                return true;
+
+        return false;
+    }
+
+    // First index in [0, size) for which isBefore is false, where isBefore
+    // is true for some leading run of indices
+    template <typename Fn>
+    int partitionPoint(int size, Fn&& isBefore)
+    {
+        int first = 0;
+
+        while (size > 0)
+        {
+            const auto half = size / 2;
+
+            if (isBefore(first + half))
+            {
+                first += half + 1;
+                size -= half + 1;
+            }
+            else
+            {
+                size = half;
+            }
+        }
+
+        return first;
+    }
+
+    juce::uint32 toBits(float value)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float fromBits(juce::uint32 bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    //==============================================================================
+    // Settings are stored as one run of words per set, then the stereo mode
+    // and a bit per link
+    void encodeChain(const ChainSettings& chain, std::vector<juce::uint32>& words)
+    {
+        words.insert(words.end(), { toBits(chain.lowCutFreq), toBits(chain.highCutFreq), toBits(chain.peakFreq),
+                                    toBits(chain.peakGainInDecibels), toBits(chain.peakQuality),
+                                    static_cast<juce::uint32>(chain.lowCutSlope), static_cast<juce::uint32>(chain.highCutSlope),
+                                    static_cast<juce::uint32>(chain.peakDesign) });
+    }
+
+    template <typename ReadWord>
+    ChainSettings decodeChain(ReadWord&& word, int first)
+    {
+        ChainSettings chain;
+        chain.lowCutFreq = fromBits(word(first));
+        chain.highCutFreq = fromBits(word(first + 1));
+        chain.peakFreq = fromBits(word(first + 2));
+        chain.peakGainInDecibels = fromBits(word(first + 3));
+        chain.peakQuality = fromBits(word(first + 4));
+        chain.lowCutSlope = static_cast<Slope>(juce::jlimit(0, 3, static_cast<int>(word(first + 5))));
+        chain.highCutSlope = static_cast<Slope>(juce::jlimit(0, 3, static_cast<int>(word(first + 6))));
+        chain.peakDesign = static_cast<PeakDesign>(juce::jlimit(0, 1, static_cast<int>(word(first + 7))));
+        return chain;
+    }
+
+    constexpr int chainWords = 8;
+
+    // Each band is its type, order and on switch packed in one word, then
+    // its frequency, gain and quality
+    void encodeBands(const BandSettingsArray& bands, std::vector<juce::uint32>& words)
+    {
+        for (const auto& band : bands)
+            words.insert(words.end(), { static_cast<juce::uint32>(band.type)
+                                            | (static_cast<juce::uint32>(band.order) << 8)
+                                            | (band.enabled ? 1u << 16 : 0u),
+                                        toBits(band.frequency), toBits(band.gainInDecibels), toBits(band.quality) });
+    }
+
+    template <typename ReadWord>
+    BandSettingsArray decodeBands(ReadWord&& word, int first)
+    {
+        BandSettingsArray bands;
+
+        for (auto& band : bands)
+        {
+            const auto packed = word(first);
+            band.type = static_cast<BandType>(juce::jlimit(0, 5, static_cast<int>(packed & 0xff)));
+            band.order = juce::jlimit(1, BandEngine<float>::maxCutOrder, static_cast<int>((packed >> 8) & 0xff));
+            band.enabled = (packed & (1u << 16)) != 0;
+            band.frequency = fromBits(word(first + 1));
+            band.gainInDecibels = fromBits(word(first + 2));
+            band.quality = fromBits(word(first + 3));
+            first += 4;
+        }
+
+        return bands;
+    }
+}
+
+//==============================================================================
+PathSettings PresetSettings::getPathSettings() const
+{
+    PathSettings settings;
+    settings.a = a;
+    settings.b = b;
+    settings.b.peakDesign = a.peakDesign;
+    settings.stereoMode = stereoMode;
+
+    linkBands(settings, lowCutLink, peakLink, highCutLink);
+    return settings;
+}
+
+PresetSettings getPresetSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    auto load = [&apvts](const juce::String& id) { return apvts.getRawParameterValue(id)->load(); };
+
+    PresetSettings settings;
+
+    for (auto set : { ParameterSet_A, ParameterSet_B })
+    {
+        auto& chain = set == ParameterSet_A ? settings.a : settings.b;
+
+        chain.lowCutFreq = load(getParameterId("LowCut Freq", set));
+        chain.highCutFreq = load(getParameterId("HighCut Freq", set));
+        chain.peakFreq = load(getParameterId("Peak Freq", set));
+        chain.peakGainInDecibels = load(getParameterId("Peak Gain", set));
+        chain.peakQuality = load(getParameterId("Peak Quality", set));
+        chain.lowCutSlope = static_cast<Slope>(load(getParameterId("LowCut Slope", set)));
+        chain.highCutSlope = static_cast<Slope>(load(getParameterId("HighCut Slope", set)));
+        chain.peakDesign = static_cast<PeakDesign>(load("Peak Design"));
+    }
+
+    settings.stereoMode = static_cast<StereoMode>(load("Stereo Mode"));
+    settings.lowCutLink = load("LowCut Link") > 0.5f;
+    settings.peakLink = load("Peak Link") > 0.5f;
+    settings.highCutLink = load("HighCut Link") > 0.5f;
+    settings.bands = getBandSettings(apvts);
+    return settings;
+}
+
+void applyPresetSettings(juce::AudioProcessorValueTreeState& apvts, const PresetSettings& settings)
+{
+    auto store = [&apvts](const juce::String& id, float value)
+    {
+        if (auto* parameter = apvts.getParameter(id))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
+
+    for (auto set : { ParameterSet_A, ParameterSet_B })
+    {
+        const auto& chain = set == ParameterSet_A ? settings.a : settings.b;
+
+        store(getParameterId("LowCut Freq", set), chain.lowCutFreq);
+        store(getParameterId("HighCut Freq", set), chain.highCutFreq);
+        store(getParameterId("Peak Freq", set), chain.peakFreq);
+        store(getParameterId("Peak Gain", set), chain.peakGainInDecibels);
+        store(getParameterId("Peak Quality", set), chain.peakQuality);
+        store(getParameterId("LowCut Slope", set), static_cast<float>(chain.lowCutSlope));
+        store(getParameterId("HighCut Slope", set), static_cast<float>(chain.highCutSlope));
+    }
+
+    store("Peak Design", static_cast<float>(settings.a.peakDesign));
+    store("Stereo Mode", static_cast<float>(settings.stereoMode));
+    store("LowCut Link", settings.lowCutLink ? 1.f : 0.f);
+    store("Peak Link", settings.peakLink ? 1.f : 0.f);
+    store("HighCut Link", settings.highCutLink ? 1.f : 0.f);
+
+    for (int band = 0; band < maxEngineBands; ++band)
+    {
+        const auto& bandSettings = settings.bands[static_cast<size_t>(band)];
+
+        store(getBandParameterId(band, "On"), bandSettings.enabled ? 1.f : 0.f);
+        store(getBandParameterId(band, "Type"), static_cast<float>(bandSettings.type));
+        store(getBandParameterId(band, "Freq"), bandSettings.frequency);
+        store(getBandParameterId(band, "Gain"), bandSettings.gainInDecibels);
+        store(getBandParameterId(band, "Quality"), bandSettings.quality);
+        store(getBandParameterId(band, "Slope"), static_cast<float>(bandSettings.order - 1));
+    }
+}
+
+//==============================================================================
+bool PresetLibrary::write(const juce::File& file, const std::vector<Preset>& presets)
+{
+    const auto numPresets = presets.size();
+
+    std::vector<std::string> names, categories, tagLists;
+
+    for (const auto& preset : presets)
+    {
+        names.push_back(preset.name.toStdString());
+        categories.push_back(preset.category.toStdString());
+        tagLists.push_back(preset.tags.joinIntoString(",").toStdString());
+    }
+
+    std::vector<int> order(numPresets);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&names](int x, int y)
+    {
+        return compareIgnoringCase(names[static_cast<size_t>(x)].c_str(), names[static_cast<size_t>(y)].c_str()) < 0;
+    });
+
+    // Strings are stored once each. Names go first, in order, so a search
+    // through them reads one packed run.
+    std::vector<char> strings;
+    std::map<std::string, juce::uint32> stringOffsets;
+
+    auto addString = [&strings, &stringOffsets](const std::string& text)
+    {
+        const auto [it, added] = stringOffsets.emplace(text, static_cast<juce::uint32>(strings.size()));
+
+        if (added)
+            strings.insert(strings.end(), text.c_str(), text.c_str() + text.size() + 1);
+
+        return it->second;
+    };
+
+    for (auto index : order)
+        addString(names[static_cast<size_t>(index)]);
+
+    std::vector<juce::uint32> entryWords;
+
+    for (auto index : order)
+    {
+        const auto& settings = presets[static_cast<size_t>(index)].settings;
+
+        entryWords.push_back(addString(names[static_cast<size_t>(index)]));
+        entryWords.push_back(addString(categories[static_cast<size_t>(index)]));
+        entryWords.push_back(addString(tagLists[static_cast<size_t>(index)]));
+
+        encodeChain(settings.a, entryWords);
+        encodeChain(settings.b, entryWords);
+        entryWords.push_back(static_cast<juce::uint32>(settings.stereoMode));
+        entryWords.push_back((settings.lowCutLink ? 1u : 0u) | (settings.peakLink ? 2u : 0u) | (settings.highCutLink ? 4u : 0u));
+        encodeBands(settings.bands, entryWords);
+    }
+
+    jassert(entryWords.size() == numPresets * getPresetWords(formatVersion));
+
+    // Positions are indices into the name order from here on
+    std::vector<juce::uint32> categoryIndex(numPresets);
+    std::iota(categoryIndex.begin(), categoryIndex.end(), 0u);
+    std::stable_sort(categoryIndex.begin(), categoryIndex.end(), [&](juce::uint32 x, juce::uint32 y)
+    {
+        return compareIgnoringCase(categories[static_cast<size_t>(order[x])].c_str(), categories[static_cast<size_t>(order[y])].c_str()) < 0;
+    });
+
+    std::vector<std::pair<std::string, juce::uint32>> tagEntries;
+
+    for (juce::uint32 position = 0; position < numPresets; ++position)
+        for (const auto& tag : presets[static_cast<size_t>(order[position])].tags)
+            tagEntries.emplace_back(tag.toStdString(), position);
+
+    std::stable_sort(tagEntries.begin(), tagEntries.end(), [](const auto& x, const auto& y)
+    {
+        return compareIgnoringCase(x.first.c_str(), y.first.c_str()) < 0;
+    });
+
+    std::vector<juce::uint32> tagWords;
+
+    for (const auto& [tag, position] : tagEntries)
+    {
+        tagWords.push_back(addString(tag));
+        tagWords.push_back(position);
+    }
+
+    // The strings are padded so the file ends on a word and with a null,
+    // even when there are none
+    strings.resize((strings.size() + 4) & ~size_t(3), 0);
+
+    const auto categoryIndexOffset = static_cast<juce::uint32>((headerWords + entryWords.size()) * 4);
+    const auto tagIndexOffset = categoryIndexOffset + static_cast<juce::uint32>(numPresets * 4);
+    const auto stringsOffset = tagIndexOffset + static_cast<juce::uint32>(tagWords.size() * 4);
+
+    std::vector<juce::uint8> bytes(stringsOffset + strings.size());
+    size_t writePosition = headerWords * 4;
+
+    auto putWords = [&bytes, &writePosition](const std::vector<juce::uint32>& words)
+    {
+        for (auto word : words)
+        {
+            word = juce::ByteOrder::swapIfBigEndian(word);
+            std::memcpy(bytes.data() + writePosition, &word, sizeof(word));
+            writePosition += sizeof(word);
+        }
+    };
+
+    putWords(entryWords);
+    putWords(categoryIndex);
+    putWords(tagWords);
+    std::copy(strings.begin(), strings.end(), bytes.begin() + static_cast<std::ptrdiff_t>(stringsOffset));
+
+    const auto checksum = hashBytes(bytes.data() + headerWords * 4, bytes.size() - headerWords * 4);
+
+    writePosition = 0;
+    putWords({ libraryMagic, static_cast<juce::uint32>(formatVersion), static_cast<juce::uint32>(numPresets),
+               static_cast<juce::uint32>(tagEntries.size()), categoryIndexOffset, tagIndexOffset, stringsOffset,
+               static_cast<juce::uint32>(strings.size()), checksum, 0 });
+
+    return file.replaceWithData(bytes.data(), bytes.size());
+}
+
+//==============================================================================
+PresetLibrary::PresetLibrary() = default;
+PresetLibrary::~PresetLibrary() = default;
+
+bool PresetLibrary::open(const juce::File& file)
+{
+    close();
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto size = mapped->getSize();
+    data = static_cast<const juce::uint8*>(mapped->getData());
+
+    auto fail = [this]
+    {
+        close();
+        return false;
+    };
+
+    if (data == nullptr || size < static_cast<size_t>(headerWords * 4) || readWord(0) != libraryMagic)
+        return fail();
+
+    const auto version = readWord(4);
+    const size_t presetCount = readWord(8), tagCount = readWord(12);
+    categoryIndexOffset = readWord(16);
+    tagIndexOffset = readWord(20);
+    stringsOffset = readWord(24);
+    const size_t stringsSize = readWord(28);
+
+    // The sections follow each other in a fixed order, so their offsets
+    // follow from the counts
+    presetWords = getPresetWords(version);
+
+    if (version == 0 || version > static_cast<juce::uint32>(formatVersion)
+        || categoryIndexOffset != (headerWords + presetCount * presetWords) * 4
+        || tagIndexOffset != categoryIndexOffset + presetCount * 4
+        || stringsOffset != tagIndexOffset + tagCount * 8
+        || stringsOffset + stringsSize != size || stringsSize == 0 || data[size - 1] != 0)
+        return fail();
+
+    if (hashBytes(data + headerWords * 4, size - headerWords * 4) != readWord(32))
+        return fail();
+
+    // Every reference must land inside the file, so reads never need to
+    // check again
+    for (size_t i = 0; i < presetCount; ++i)
+    {
+        const auto entry = (headerWords + i * presetWords) * 4;
+
+        for (size_t word = 0; word < 3; ++word)
+            if (readWord(entry + word * 4) >= stringsSize)
+                return fail();
+
+        if (readWord(categoryIndexOffset + i * 4) >= presetCount)
+            return fail();
+    }
+
+    for (size_t i = 0; i < tagCount; ++i)
+        if (readWord(tagIndexOffset + i * 8) >= stringsSize || readWord(tagIndexOffset + i * 8 + 4) >= presetCount)
+            return fail();
+
+    mappedFile = std::move(mapped);
+    numPresets = static_cast<int>(presetCount);
+    numTagEntries = static_cast<int>(tagCount);
+    return true;
+}
+
+void PresetLibrary::close()
+{
+    mappedFile.reset();
+    data = nullptr;
+    numPresets = numTagEntries = 0;
+    presetWords = 0;
+    categoryIndexOffset = tagIndexOffset = stringsOffset = 0;
+}
+
+//==============================================================================
+size_t PresetLibrary::getPresetWords(juce::uint32 version) noexcept
+{
+    return static_cast<size_t>(3 + chainSettingsWords + (version >= 2 ? bandWords : 0));
+}
+
+juce::uint32 PresetLibrary::readWord(size_t offset) const noexcept
+{
+    return juce::ByteOrder::littleEndianInt(data + offset);
+}
+
+const char* PresetLibrary::getString(juce::uint32 offset) const noexcept
+{
+    return reinterpret_cast<const char*>(data + stringsOffset + offset);
+}
+
+const char* PresetLibrary::getTagString(int entry) const noexcept
+{
+    return getString(readWord(tagIndexOffset + static_cast<size_t>(entry) * 8));
+}
+
+int PresetLibrary::getTagPreset(int entry) const noexcept
+{
+    return static_cast<int>(readWord(tagIndexOffset + static_cast<size_t>(entry) * 8 + 4));
+}
+
+juce::CharPointer_UTF8 PresetLibrary::getName(int index) const
+{
+    jassert(juce::isPositiveAndBelow(index, numPresets));
+    return juce::CharPointer_UTF8(getString(readWord((headerWords + static_cast<size_t>(index) * presetWords) * 4)));
+}
+
+juce::CharPointer_UTF8 PresetLibrary::getCategory(int index) const
+{
+    jassert(juce::isPositiveAndBelow(index, numPresets));
+    return juce::CharPointer_UTF8(getString(readWord((headerWords + static_cast<size_t>(index) * presetWords + 1) * 4)));
+}
+
+juce::CharPointer_UTF8 PresetLibrary::getTags(int index) const
+{
+    jassert(juce::isPositiveAndBelow(index, numPresets));
+    return juce::CharPointer_UTF8(getString(readWord((headerWords + static_cast<size_t>(index) * presetWords + 2) * 4)));
+}
+
+PresetSettings PresetLibrary::getSettings(int index) const
+{
+    jassert(juce::isPositiveAndBelow(index, numPresets));
+
+    const auto first = (headerWords + static_cast<size_t>(index) * presetWords + 3) * 4;
+    auto word = [this, first](int i) { return readWord(first + static_cast<size_t>(i) * 4); };
+
+    PresetSettings settings;
+    settings.a = decodeChain(word, 0);
+    settings.b = decodeChain(word, chainWords);
+    settings.stereoMode = static_cast<StereoMode>(juce::jlimit(0, 4, static_cast<int>(word(2 * chainWords))));
+
+    const auto links = word(2 * chainWords + 1);
+    settings.lowCutLink = (links & 1) != 0;
+    settings.peakLink = (links & 2) != 0;
+    settings.highCutLink = (links & 4) != 0;
+
+    // Older libraries end here, and leave every band off
+    if (presetWords > getPresetWords(1))
+        settings.bands = decodeBands(word, chainSettingsWords);
+
+    return settings;
+}
+
+//==============================================================================
+int PresetLibrary::findName(const juce::String& name) const
+{
+    const auto* text = name.toRawUTF8();
+    const auto index = partitionPoint(numPresets, [&](int i) { return compareIgnoringCase(getName(i).getAddress(), text) < 0; });
+
+    return index < numPresets && compareIgnoringCase(getName(index).getAddress(), text) == 0 ? index : -1;
+}
+
+juce::Range<int> PresetLibrary::findNamePrefix(const juce::String& prefix) const
+{
+    const auto* text = prefix.toRawUTF8();
+
+    // Names with the prefix follow straight on from the ones before it
+    const auto start = partitionPoint(numPresets, [&](int i) { return compareIgnoringCase(getName(i).getAddress(), text) < 0; });
+    const auto length = partitionPoint(numPresets - start, [&](int i) { return startsWithIgnoringCase(getName(start + i).getAddress(), text); });
+
+    return { start, start + length };
+}
+
+void PresetLibrary::findCategory(const juce::String& category, std::vector<int>& results) const
+{
+    const auto* text = category.toRawUTF8();
+    auto getPreset = [this](int i) { return static_cast<int>(readWord(categoryIndexOffset + static_cast<size_t>(i) * 4)); };
+    auto compareAt = [&](int i) { return compareIgnoringCase(getCategory(getPreset(i)).getAddress(), text); };
+
+    results.clear();
+
+    for (auto i = partitionPoint(numPresets, [&](int j) { return compareAt(j) < 0; }); i < numPresets && compareAt(i) == 0; ++i)
+        results.push_back(getPreset(i));
+}
+
+void PresetLibrary::findTag(const juce::String& tag, std::vector<int>& results) const
+{
+    const auto* text = tag.toRawUTF8();
+
+    results.clear();
+
+    for (auto i = partitionPoint(numTagEntries, [&](int j) { return compareIgnoringCase(getTagString(j), text) < 0; });
+         i < numTagEntries && compareIgnoringCase(getTagString(i), text) == 0; ++i)
+        results.push_back(getTagPreset(i));
+}
+
+void PresetLibrary::searchNames(const juce::String& text, std::vector<int>& results) const
+{
+    const auto* part = text.toRawUTF8();
+
+    results.clear();
+
+    for (int i = 0; i < numPresets; ++i)
+        if (containsIgnoringCase(getName(i).getAddress(), part))
+            results.push_back(i);
+}
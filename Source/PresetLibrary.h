@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    PresetLibrary.h
+    A library of presets in one memory-mapped file. Opening it maps the
+    file and checks it once; after that, browsing, searching and loading
+    read straight from the mapping, with no per-preset files, directory
+    scans or XML.
+
+    Layout, all little endian 32 bit words at 4 byte aligned offsets:
+
+        header      magic ("OLPL"), version, preset and tag entry counts,
+                    offsets of the indices and strings, checksum (FNV-1a of
+                    everything after the header)
+        presets     one fixed size entry per preset, sorted by name: the
+                    offsets of its name, category and tags in the strings,
+                    then its settings
+        categories  preset indices sorted by category, then name
+        tags        (tag, preset index) pairs sorted by tag, then preset
+        strings     null-terminated UTF-8
+
+    Names, categories and tags compare without case for ASCII letters. A
+    name is found by binary search, a category or tag by binary search for
+    its range in the index. Tags are stored once each, and a preset's tags
+    as one comma separated string.
+
+    Libraries are rebuilt as a whole, which for tens of thousands of
+    presets takes milliseconds. Version 2 added the band engine's bands to
+    the end of each preset's settings; version 1 libraries still open, with
+    every band off.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+// What a preset holds: both sets' band parameters, the stereo mode, the
+// band links and the band engine's bands. Set B keeps its own values for
+// linked bands, as the parameters do. The peak design is global and taken
+// from set A.
+struct PresetSettings
+{
+    ChainSettings a, b;
+    StereoMode stereoMode{ StereoMode_Stereo };
+    bool lowCutLink = true, peakLink = true, highCutLink = true;
+    BandSettingsArray bands;
+
+    // The settings the processor would run, with the links applied
+    PathSettings getPathSettings() const;
+};
+
+PresetSettings getPresetSettings(juce::AudioProcessorValueTreeState& apvts);
+
+// Sets the parameters, notifying the host. Not for the audio thread.
+void applyPresetSettings(juce::AudioProcessorValueTreeState& apvts, const PresetSettings& settings);
+
+//==============================================================================
+class PresetLibrary
+{
+public:
+    //==============================================================================
+    static constexpr int formatVersion = 2;
+
+    struct Preset
+    {
+        juce::String name, category;
+        juce::StringArray tags;
+        PresetSettings settings;
+    };
+
+    // Writes a library of the presets to the file, replacing it. Names
+    // should be unique, the first of several with the same name is the one
+    // found by name.
+    static bool write(const juce::File& file, const std::vector<Preset>& presets);
+
+    //==============================================================================
+    PresetLibrary();
+    ~PresetLibrary();
+
+    // Maps the file and checks its header, offsets and checksum. Returns
+    // false, leaving the library empty, if any of them is wrong.
+    bool open(const juce::File& file);
+    void close();
+
+    int getNumPresets() const noexcept { return numPresets; }
+
+    //==============================================================================
+    // Presets are numbered in name order. The strings point into the
+    // mapping and stay valid until the library is closed.
+    juce::CharPointer_UTF8 getName(int index) const;
+    juce::CharPointer_UTF8 getCategory(int index) const;
+    juce::CharPointer_UTF8 getTags(int index) const;
+
+    // Decodes the preset's settings straight from the mapping
+    PresetSettings getSettings(int index) const;
+
+    //==============================================================================
+    // The preset with this name, or -1
+    int findName(const juce::String& name) const;
+
+    // The presets whose names start with the prefix, as a range of indices
+    juce::Range<int> findNamePrefix(const juce::String& prefix) const;
+
+    // Replace the results with the presets in the category, or with the
+    // tag, in name order
+    void findCategory(const juce::String& category, std::vector<int>& results) const;
+    void findTag(const juce::String& tag, std::vector<int>& results) const;
+
+    // Replaces the results with the presets whose names contain the text,
+    // in name order. Scans every name, which are packed together, so it
+    // stays fast at thousands of presets.
+    void searchNames(const juce::String& text, std::vector<int>& results) const;
+
+private:
+    //==============================================================================
+    static constexpr int headerWords = 10;
+    static constexpr int chainSettingsWords = 18;
+    static constexpr int bandWords = 4 * maxEngineBands;
+
+    // Words per preset entry in a library of the version
+    static size_t getPresetWords(juce::uint32 version) noexcept;
+
+    juce::uint32 readWord(size_t offset) const noexcept;
+    const char* getString(juce::uint32 offset) const noexcept;
+    const char* getTagString(int entry) const noexcept;
+    int getTagPreset(int entry) const noexcept;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const juce::uint8* data = nullptr;
+    int numPresets = 0, numTagEntries = 0;
+    size_t presetWords = 0;
+    size_t categoryIndexOffset = 0, tagIndexOffset = 0, stringsOffset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetLibrary)
+};
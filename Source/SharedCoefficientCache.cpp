@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    SharedCoefficientCache.cpp
+    Implements the process-wide coefficient cache and its publishing thread.
+
+  ==============================================================================
+*/
+
+#include "SharedCoefficientCache.h"
+
+namespace
+{
+    // How soon the thread looks again while replaced designs wait for their
+    // readers, and how long it sleeps otherwise should a wake-up be missed
+    constexpr int reclaimIntervalMs = 5;
+    constexpr int idleIntervalMs = 1000;
+}
+
+//==============================================================================
+template <typename SampleType>
+SharedCoefficientCache<SampleType>::SharedCoefficientCache(juce::Thread& thread)
+    : serviceThread(thread), owned(numSlots)
+{
+    for (auto& slot : slots)
+        slot.store(nullptr, std::memory_order_relaxed);
+
+    for (auto& readers : activeReaders)
+        readers.store(0, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < queue.size(); ++i)
+        queue[i].sequence.store(static_cast<juce::uint32>(i), std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+bool SharedCoefficientCache<SampleType>::lookup(const CoefficientKey& key, CoefficientSet<SampleType>& set) const
+{
+    // Announced before any slot is read, under an epoch that was still
+    // current afterwards, so the service thread can tell when no lookup can
+    // still hold a design it has replaced
+    auto readEpoch = epoch.load();
+
+    for (;;)
+    {
+        activeReaders[readEpoch & 1].fetch_add(1);
+
+        const auto current = epoch.load();
+
+        if (current == readEpoch)
+            break;
+
+        activeReaders[readEpoch & 1].fetch_sub(1);
+        readEpoch = current;
+    }
+
+    const auto first = static_cast<int>(key.getHash() & (numSlots - 1));
+    auto found = false;
+
+    for (int probe = 0; probe < numProbes && ! found; ++probe)
+    {
+        if (const auto* design = slots[static_cast<size_t>((first + probe) & (numSlots - 1))].load())
+        {
+            if (design->key == key)
+            {
+                set = design->set;
+                found = true;
+            }
+        }
+    }
+
+    activeReaders[readEpoch & 1].fetch_sub(1);
+    return found;
+}
+
+template <typename SampleType>
+bool SharedCoefficientCache<SampleType>::publish(const CoefficientKey& key, const CoefficientSet<SampleType>& set)
+{
+    auto position = enqueuePosition.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& pending = queue[position & (queueSize - 1)];
+        const auto sequence = pending.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<juce::int32>(sequence - position);
+
+        // Behind means the consumer has not freed the slot yet, so the queue
+        // is full. Ahead means another producer took it, so try again from
+        // the new end.
+        if (difference < 0)
+            return false;
+
+        if (difference > 0)
+        {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+            pending.design = { key, set };
+            pending.sequence.store(position + 1, std::memory_order_release);
+
+            // Only the first design of a pass wakes the thread
+            if (! serviceRequested.exchange(true))
+                serviceThread.notify();
+
+            return true;
+        }
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+bool SharedCoefficientCache<SampleType>::takePending(Design& design)
+{
+    auto& pending = queue[dequeuePosition & (queueSize - 1)];
+
+    if (pending.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+        return false;
+
+    design = pending.design;
+    pending.sequence.store(dequeuePosition + queueSize, std::memory_order_release);
+    ++dequeuePosition;
+    return true;
+}
+
+template <typename SampleType>
+void SharedCoefficientCache<SampleType>::insert(const Design& design)
+{
+    const auto first = static_cast<int>(design.key.getHash() & (numSlots - 1));
+    auto index = -1;
+
+    for (int probe = 0; probe < numProbes && index < 0; ++probe)
+    {
+        const auto slot = (first + probe) & (numSlots - 1);
+
+        if (owned[static_cast<size_t>(slot)] == nullptr)
+            index = slot;
+    }
+
+    if (index < 0)
+    {
+        index = (first + nextVictim) & (numSlots - 1);
+        nextVictim = (nextVictim + 1) % numProbes;
+    }
+    else
+    {
+        numDesigns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto& slot = owned[static_cast<size_t>(index)];
+    auto replacement = std::make_unique<const Design>(design);
+
+    slots[static_cast<size_t>(index)].store(replacement.get());
+
+    if (slot != nullptr)
+        retired.push_back(std::move(slot));
+
+    slot = std::move(replacement);
+}
+
+template <typename SampleType>
+bool SharedCoefficientCache<SampleType>::service()
+{
+    // Cleared first, so a design queued during the pass wakes the next one
+    serviceRequested = false;
+
+    Design design;
+    CoefficientSet<SampleType> existing;
+
+    // Instances loading the same settings queue the same designs, only the
+    // first of each is kept
+    while (takePending(design))
+        if (! lookup(design.key, existing))
+            insert(design);
+
+    // The last batch was retired when the epoch before this one ended. Only
+    // lookups that started in it can still read its designs, and no new
+    // lookup counts there.
+    if (! reclaiming.empty() && activeReaders[(epoch.load() - 1) & 1].load() == 0)
+        reclaiming.clear();
+
+    // Every design retired this pass is out of the table, so a lookup that
+    // could still read one started in the current epoch. Ending it makes
+    // them the next batch. The epoch only moves once the last batch is
+    // freed, so a counter never holds lookups of two epochs it waits on.
+    if (reclaiming.empty() && ! retired.empty())
+    {
+        std::swap(reclaiming, retired);
+        epoch.fetch_add(1);
+    }
+
+    return ! reclaiming.empty();
+}
+
+//==============================================================================
+SharedCoefficientCaches::SharedCoefficientCaches()
+    : juce::Thread("OloEQ Coefficient Sharing"), floatCache(*this), doubleCache(*this)
+{
+    startThread(juce::Thread::Priority::low);
+}
+
+SharedCoefficientCaches::~SharedCoefficientCaches()
+{
+    stopThread(1000);
+}
+
+void SharedCoefficientCaches::run()
+{
+    // Sleeps until a design is queued, but checks back soon while replaced
+    // designs wait for lookups that could still read them
+    while (! threadShouldExit())
+    {
+        const auto floatReclaiming = floatCache.service();
+        const auto doubleReclaiming = doubleCache.service();
+
+        wait(floatReclaiming || doubleReclaiming ? reclaimIntervalMs : idleIntervalMs);
+    }
+}
+
+//==============================================================================
+template class SharedCoefficientCache<float>;
+template class SharedCoefficientCache<double>;
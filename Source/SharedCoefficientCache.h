@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    SharedCoefficientCache.h
+    Designed bands shared by every plugin instance in the process. A
+    session that loads the same settings on hundreds of tracks then designs
+    each band once, and the per-instance caches fall back on it when they
+    miss.
+
+    The cache is an open addressed table of pointers to immutable designs.
+    Lookups copy a design out and are lock and allocation free on any
+    thread. New designs go through a bounded lock-free queue to one
+    background thread, the only one that writes the table, allocates
+    designs or frees them. The first publish after each pass wakes it, so
+    it sleeps while nothing is queued.
+
+    A design it replaces may still be read by a lookup that started
+    earlier, so replaced designs are freed a batch at a time, by epoch.
+    Lookups announce themselves on the counter of the epoch they start in,
+    rather than counting references on each design, so hits never write to
+    the designs all instances share. A batch is retired by moving on to the
+    next epoch and freed once the counter of the one before drains, which
+    it does however busy the cache is, as new lookups count on the other.
+
+    SharedCoefficientCaches holds the caches for both sample types and
+    their thread. Plugin instances reach it through a
+    juce::SharedResourcePointer, which creates it for the first instance and
+    deletes it with the last, never on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientCache.h"
+
+//==============================================================================
+template <typename SampleType>
+class SharedCoefficientCache
+{
+public:
+    //==============================================================================
+    // The thread is notified when designs are queued, and has to call
+    // service()
+    explicit SharedCoefficientCache(juce::Thread& serviceThread);
+
+    // Copies the design for the key into set and returns true if the cache
+    // has it. Lock and allocation free.
+    bool lookup(const CoefficientKey& key, CoefficientSet<SampleType>& set) const;
+
+    // Queues a design to be published. Allocation free, and only takes the
+    // service thread's event lock for the first design after each pass.
+    // Returns false when the queue is full, in which case the design is not
+    // shared.
+    bool publish(const CoefficientKey& key, const CoefficientSet<SampleType>& set);
+
+    // Publishes the queued designs and frees the ones they replaced once it
+    // is safe to. Returns true while replaced designs are still waiting to
+    // be freed. Only for the service thread.
+    bool service();
+
+    int getNumDesigns() const noexcept { return numDesigns.load(std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    struct Design
+    {
+        CoefficientKey key;
+        CoefficientSet<SampleType> set;
+    };
+
+    // A queue slot is free for the producer whose position matches its
+    // sequence, and ready for the consumer once the sequence is one past
+    struct Pending
+    {
+        std::atomic<juce::uint32> sequence{ 0 };
+        Design design;
+    };
+
+    // A design can be found in any of the numProbes slots from its hash,
+    // and replaces one of them in turn once all are taken
+    static constexpr int numSlots = 8192;
+    static constexpr int numProbes = 8;
+    static constexpr int queueSize = 256;
+
+    bool takePending(Design& design);
+    void insert(const Design& design);
+
+    std::array<std::atomic<const Design*>, numSlots> slots;
+    std::atomic<int> numDesigns{ 0 };
+
+    // Lookups running, counted by the parity of the epoch they started in
+    std::atomic<juce::uint32> epoch{ 0 };
+    mutable std::array<std::atomic<int>, 2> activeReaders;
+
+    std::array<Pending, queueSize> queue;
+    std::atomic<juce::uint32> enqueuePosition{ 0 };
+
+    juce::Thread& serviceThread;
+    std::atomic<bool> serviceRequested{ false };
+
+    // Only touched by the service thread. Replaced designs are retired
+    // during a pass, and reclaimed once the epoch they were retired in ends.
+    std::vector<std::unique_ptr<const Design>> owned, retired, reclaiming;
+    juce::uint32 dequeuePosition = 0;
+    int nextVictim = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedCoefficientCache)
+};
+
+//==============================================================================
+class SharedCoefficientCaches : private juce::Thread
+{
+public:
+    //==============================================================================
+    SharedCoefficientCaches();
+    ~SharedCoefficientCaches() override;
+
+    template <typename SampleType>
+    SharedCoefficientCache<SampleType>& get() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleCache;
+        else
+            return floatCache;
+    }
+
+private:
+    //==============================================================================
+    void run() override;
+
+    SharedCoefficientCache<float> floatCache;
+    SharedCoefficientCache<double> doubleCache;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedCoefficientCaches)
+};
@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    SvfEngine.cpp
+    Implements the state-variable filter engine. See "Linear Trapezoidal
+    Integrated SVF" (A. Simper) for the update equations.
+
+  ==============================================================================
+*/
+
+#include "SvfEngine.h"
+#include "CoefficientDesign.h"
+
+//==============================================================================
+template <typename SampleType>
+void SvfEngine<SampleType>::prepare(double newSampleRate, int newNumChannels)
+{
+    numChannels = newNumChannels;
+    state.calloc(static_cast<size_t>(numSections * numChannels * 2));
+
+    setSampleRate(newSampleRate);
+}
+
+template <typename SampleType>
+void SvfEngine<SampleType>::setSampleRate(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    // Force the next set calls to retune at the new rate
+    lowCutTuning = {};
+    highCutTuning = {};
+    peakTuning = {};
+}
+
+template <typename SampleType>
+void SvfEngine<SampleType>::reset()
+{
+    juce::FloatVectorOperations::clear(state.get(), numSections * numChannels * 2);
+}
+
+//==============================================================================
+template <typename SampleType>
+SampleType SvfEngine<SampleType>::prewarp(SampleType frequency) const
+{
+    // Keep clear of Nyquist where tan() diverges
+    const auto rate = static_cast<SampleType>(sampleRate);
+    const auto limit = rate * SampleType(0.49);
+    return std::tan(juce::MathConstants<SampleType>::pi * juce::jlimit(SampleType(2), limit, frequency) / rate);
+}
+
+template <typename SampleType>
+void SvfEngine<SampleType>::setSvfGain(Section& section, SampleType g, SampleType k)
+{
+    section.k  = k;
+    section.a1 = SampleType(1) / (SampleType(1) + g * (g + k));
+    section.a2 = g * section.a1;
+    section.a3 = g * section.a2;
+}
+
+template <typename SampleType>
+void SvfEngine<SampleType>::setPeak(SampleType frequency, SampleType quality, SampleType gainInDecibels)
+{
+    if (frequency == peakTuning.frequency && quality == peakTuning.quality && gainInDecibels == peakTuning.gainInDecibels)
+        return;
+
+    peakTuning = { frequency, quality, gainInDecibels };
+
+    // Bell: k = 1 / (Q * A), out = in + k * (A^2 - 1) * band
+    const auto A = std::pow(SampleType(10), gainInDecibels / SampleType(40));
+    auto& section = sections[peakSection];
+
+    section.type = SectionType::bell;
+    setSvfGain(section, prewarp(frequency), SampleType(1) / (quality * A));
+    section.m1 = section.k * (A * A - SampleType(1));
+    section.active = true;
+}
+
+template <typename SampleType>
+void SvfEngine<SampleType>::setLowCut(SampleType frequency, int order)
+{
+    setCut(0, lowCutTuning, frequency, order, true);
+}
+
+template <typename SampleType>
+void SvfEngine<SampleType>::setHighCut(SampleType frequency, int order)
+{
+    setCut(peakSection + 1, highCutTuning, frequency, order, false);
+}
+
+template <typename SampleType>
+void SvfEngine<SampleType>::setCut(int firstSection, CutTuning& tuning, SampleType frequency, int order, bool isHighPass)
+{
+    if (frequency == tuning.frequency && order == tuning.order)
+        return;
+
+    jassert(order > 0 && (order + 1) / 2 <= maxCutSections);
+
+    tuning = { frequency, order };
+
+    // Same section split as the Butterworth biquad design, sharing one tan()
+    const auto g = prewarp(frequency);
+    auto index = firstSection;
+
+    if (order % 2 == 1)
+    {
+        auto& section = sections[static_cast<size_t>(index++)];
+        section.type = isHighPass ? SectionType::onePoleHighPass : SectionType::onePoleLowPass;
+        section.a1 = g / (SampleType(1) + g);
+        section.active = true;
+    }
+
+    for (int i = 0; i < order / 2; ++i)
+    {
+        auto& section = sections[static_cast<size_t>(index++)];
+        section.type = isHighPass ? SectionType::highPass : SectionType::lowPass;
+        setSvfGain(section, g, static_cast<SampleType>(getButterworthInverseQuality(order, i)));
+        section.active = true;
+    }
+
+    for (; index < firstSection + maxCutSections; ++index)
+        sections[static_cast<size_t>(index)].active = false;
+}
+
+//==============================================================================
+template <typename SampleType>
+void SvfEngine<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto channelsToProcess = juce::jmin(numChannels, static_cast<int>(block.getNumChannels()));
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        if (! sections[static_cast<size_t>(i)].active)
+            continue;
+
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+            processSection(sections[static_cast<size_t>(i)], state + (i * numChannels + channel) * 2,
+                           block.getChannelPointer(static_cast<size_t>(channel)), numSamples);
+    }
+}
+
+template <typename SampleType>
+void SvfEngine<SampleType>::processSection(const Section& section, SampleType* sectionState, SampleType* samples, int numSamples) const
+{
+    auto ic1eq = sectionState[0];
+    auto ic2eq = sectionState[1];
+
+    const auto k = section.k, a1 = section.a1, a2 = section.a2, a3 = section.a3, m1 = section.m1;
+
+    auto runSvf = [&](auto&& output)
+    {
+        for (int n = 0; n < numSamples; ++n)
+        {
+            const auto v0 = samples[n];
+            const auto v3 = v0 - ic2eq;
+            const auto v1 = a1 * ic1eq + a2 * v3;
+            const auto v2 = ic2eq + a2 * ic1eq + a3 * v3;
+
+            ic1eq = SampleType(2) * v1 - ic1eq;
+            ic2eq = SampleType(2) * v2 - ic2eq;
+
+            samples[n] = output(v0, v1, v2);
+        }
+    };
+
+    auto runOnePole = [&](bool isHighPass)
+    {
+        for (int n = 0; n < numSamples; ++n)
+        {
+            const auto v = (samples[n] - ic1eq) * a1;
+            const auto lowPass = v + ic1eq;
+            ic1eq = lowPass + v;
+
+            samples[n] = isHighPass ? samples[n] - lowPass : lowPass;
+        }
+    };
+
+    switch (section.type)
+    {
+        case SectionType::onePoleHighPass: runOnePole(true);  break;
+        case SectionType::onePoleLowPass:  runOnePole(false); break;
+        case SectionType::highPass:        runSvf([k](SampleType v0, SampleType v1, SampleType v2) { return v0 - k * v1 - v2; }); break;
+        case SectionType::lowPass:         runSvf([](SampleType, SampleType, SampleType v2) { return v2; }); break;
+        case SectionType::bell:            runSvf([m1](SampleType v0, SampleType v1, SampleType) { return v0 + m1 * v1; }); break;
+    }
+
+    sectionState[0] = ic1eq;
+    sectionState[1] = ic2eq;
+}
+
+//==============================================================================
+template class SvfEngine<float>;
+template class SvfEngine<double>;
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    SvfEngine.h
+    Alternative processing engine built from topology-preserving transform
+    (Cytomic / Zavalishin) state-variable filters. Each band is tuned by a
+    single tan() plus a few arithmetic operations and stays stable under
+    per-sample modulation, unlike direct form biquads.
+
+    The engine mirrors the cascade layout: up to four low cut sections, the
+    peak band, then up to four high cut sections. Instantiated for float
+    and double.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+template <typename SampleType>
+class SvfEngine
+{
+public:
+    //==============================================================================
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+
+    // Changes the rate without reallocating, e.g. when switching the
+    // oversampling factor. Bands retune on the next set calls.
+    void setSampleRate(double sampleRate);
+
+    //==============================================================================
+    // Retune a band. Unchanged values return early, so these are cheap enough
+    // to call every sample while parameters are being smoothed.
+    void setPeak(SampleType frequency, SampleType quality, SampleType gainInDecibels);
+    void setLowCut(SampleType frequency, int order);
+    void setHighCut(SampleType frequency, int order);
+
+    //==============================================================================
+    void process(const juce::dsp::AudioBlock<SampleType>& block);
+
+private:
+    //==============================================================================
+    enum class SectionType
+    {
+        onePoleHighPass,
+        onePoleLowPass,
+        highPass,
+        lowPass,
+        bell
+    };
+
+    // One-pole sections only use a1 (g / (1 + g))
+    struct Section
+    {
+        SectionType type = SectionType::bell;
+        SampleType k{}, a1{}, a2{}, a3{}, m1{};
+        bool active = false;
+    };
+
+    static constexpr int maxCutSections = 4;
+    static constexpr int peakSection    = maxCutSections;
+    static constexpr int numSections    = 2 * maxCutSections + 1;
+
+    struct CutTuning { SampleType frequency{ -1 }; int order = 0; };
+    struct PeakTuning { SampleType frequency{ -1 }, quality{}, gainInDecibels{}; };
+
+    SampleType prewarp(SampleType frequency) const;
+    void setCut(int firstSection, CutTuning& tuning, SampleType frequency, int order, bool isHighPass);
+    static void setSvfGain(Section& section, SampleType g, SampleType k);
+    void processSection(const Section& section, SampleType* state, SampleType* samples, int numSamples) const;
+
+    std::array<Section, numSections> sections;
+    CutTuning lowCutTuning, highCutTuning;
+    PeakTuning peakTuning;
+
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+
+    // Two state values per section per channel
+    juce::HeapBlock<SampleType> state;
+
+    JUCE_LEAK_DETECTOR(SvfEngine)
+};
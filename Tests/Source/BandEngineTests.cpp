@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    BandEngineTests.cpp
+    Checks the band engine's bands against their designs: the gain of each
+    band type at the frequencies that define it, that disabled bands leave
+    the signal untouched, and that the bands survive the preset library
+    and the processor state.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BandEngine.h"
+#include "PresetLibrary.h"
+
+namespace
+{
+    constexpr double testSampleRate = 48000.0;
+    constexpr int testBlockSize = 512;
+    constexpr int testLength = 96000;   // half settles, half is measured
+
+    constexpr double gainToleranceDb = 0.1;
+
+    // Gain in dB of the settings, as the only band on, for a sine at the
+    // frequency. Whole cycles fit in the measured half at any even
+    // frequency in Hz.
+    double measureGainDb(const BandSettings& settings, double frequency)
+    {
+        BandEngine<double> engine;
+        engine.prepare(testSampleRate, 1, testBlockSize, KernelIsa::scalar);
+        engine.setBand(0, settings);
+
+        juce::AudioBuffer<double> buffer(1, testLength);
+
+        for (int n = 0; n < testLength; ++n)
+            buffer.setSample(0, n, std::sin(juce::MathConstants<double>::twoPi * frequency * n / testSampleRate));
+
+        juce::dsp::AudioBlock<double> block(buffer);
+
+        for (int start = 0; start < testLength; start += testBlockSize)
+        {
+            const auto length = juce::jmin(testBlockSize, testLength - start);
+            engine.process(block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length)));
+        }
+
+        const auto rms = buffer.getRMSLevel(0, testLength / 2, testLength / 2);
+        return juce::Decibels::gainToDecibels(rms * juce::MathConstants<double>::sqrt2, -200.0);
+    }
+
+    BandSettings makeBand(BandType type, float frequency, float gain = 0.f, float quality = 1.f, int order = 2)
+    {
+        BandSettings settings;
+        settings.enabled = true;
+        settings.type = type;
+        settings.frequency = frequency;
+        settings.gainInDecibels = gain;
+        settings.quality = quality;
+        settings.order = order;
+        return settings;
+    }
+
+    void setParameter(OloEQAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+}
+
+//==============================================================================
+class BandEngineTests : public juce::UnitTest
+{
+public:
+    BandEngineTests() : juce::UnitTest("Band engine", "OloEQ") {}
+
+    void runTest() override
+    {
+        beginTest("Band types");
+
+        expectWithinAbsoluteError(measureGainDb(makeBand(BandType::peak, 1000.f, 6.f), 1000.0), 6.0, gainToleranceDb);
+        expectWithinAbsoluteError(measureGainDb(makeBand(BandType::lowShelf, 2000.f, 6.f, 0.707f), 20.0), 6.0, gainToleranceDb);
+        expectWithinAbsoluteError(measureGainDb(makeBand(BandType::highShelf, 500.f, -6.f, 0.707f), 20000.0), -6.0, gainToleranceDb);
+        expectLessThan(measureGainDb(makeBand(BandType::notch, 1000.f, 0.f, 2.f), 1000.0), -40.0);
+
+        for (int order = 1; order <= BandEngine<double>::maxCutOrder; ++order)
+        {
+            const juce::String name(" at order " + juce::String(order));
+
+            expectWithinAbsoluteError(measureGainDb(makeBand(BandType::lowCut, 1000.f, 0.f, 1.f, order), 1000.0),
+                                      -3.01, gainToleranceDb, "Low cut" + name);
+            expectWithinAbsoluteError(measureGainDb(makeBand(BandType::highCut, 1000.f, 0.f, 1.f, order), 1000.0),
+                                      -3.01, gainToleranceDb, "High cut" + name);
+        }
+
+        beginTest("Disabled bands pass through");
+        {
+            BandEngine<float> engine;
+            engine.prepare(testSampleRate, 2, testBlockSize, KernelIsa::scalar);
+
+            for (int band = 0; band < BandEngine<float>::maxBands; ++band)
+            {
+                auto settings = makeBand(BandType::peak, 1000.f, 12.f);
+                engine.setBand(band, settings);
+                settings.enabled = false;
+                engine.setBand(band, settings);
+            }
+
+            expectEquals(engine.getNumEnabledBands(), 0);
+
+            juce::AudioBuffer<float> input(2, testBlockSize);
+            juce::Random random(0x0BA2);
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int n = 0; n < testBlockSize; ++n)
+                    input.setSample(channel, n, random.nextFloat() * 2.f - 1.f);
+
+            juce::AudioBuffer<float> output(input);
+            engine.process(juce::dsp::AudioBlock<float>(output));
+
+            auto identical = true;
+
+            for (int channel = 0; channel < 2; ++channel)
+                identical = identical && std::memcmp(input.getReadPointer(channel), output.getReadPointer(channel),
+                                                     sizeof(float) * testBlockSize) == 0;
+
+            expect(identical, "The output differs from the input");
+        }
+
+        beginTest("Preset library round trip");
+        {
+            PresetLibrary::Preset preset;
+            preset.name = "Bands";
+            preset.settings.bands[0] = makeBand(BandType::lowShelf, 120.f, 3.f, 0.7f);
+            preset.settings.bands[7] = makeBand(BandType::highCut, 9000.f, 0.f, 1.f, 5);
+            preset.settings.bands[23] = makeBand(BandType::notch, 60.f, 0.f, 8.f);
+
+            juce::TemporaryFile file(".olopresets");
+            PresetLibrary library;
+
+            expect(PresetLibrary::write(file.getFile(), { preset }));
+            expect(library.open(file.getFile()));
+            expect(library.getNumPresets() == 1 && library.getSettings(0).bands == preset.settings.bands,
+                   "The bands did not load back unchanged");
+        }
+
+        beginTest("Processor state round trip");
+        {
+            OloEQAudioProcessor source, destination;
+
+            setParameter(source, getBandParameterId(2, "On"), 1.f);
+            setParameter(source, getBandParameterId(2, "Type"), static_cast<float>(BandType::highShelf));
+            setParameter(source, getBandParameterId(2, "Freq"), 4000.f);
+            setParameter(source, getBandParameterId(2, "Gain"), -4.5f);
+            setParameter(source, getBandParameterId(2, "Slope"), 5.f);
+
+            juce::MemoryBlock state;
+            source.getStateInformation(state);
+            destination.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+            const auto bands = getBandSettings(destination.apvts);
+
+            expect(bands == getBandSettings(source.apvts), "The bands did not restore unchanged");
+            expect(bands[2].enabled && bands[2].type == BandType::highShelf && bands[2].order == 6);
+        }
+    }
+};
+
+static BandEngineTests bandEngineTests;
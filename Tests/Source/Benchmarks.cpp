@@ -0,0 +1,1268 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+    Implements the benchmark runner.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "PluginProcessor.h"
+#include "ParallelCascade.h"
+#include "OfflineRenderer.h"
+#include "PresetLibrary.h"
+#include "BinaryState.h"
+#include "NonUniformConvolver.h"
+#include "FirEngine.h"
+#include "BandEngine.h"
+#include "SvfEngine.h"
+#include "CoefficientCache.h"
+
+namespace
+{
+    constexpr double benchmarkSampleRate = 48000.0;
+    constexpr int benchmarkBlockSize = 256;
+    constexpr int benchmarkBlocks = 4096;   // about 22 seconds of audio at 48 kHz
+
+    // Written with results that would otherwise be optimised away
+    volatile double benchmarkSink = 0.0;
+
+    // The full cascade: 48 dB/oct cuts either side of a boosted peak
+    ChainSettings getBenchmarkSettings()
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 60.f;
+        settings.highCutFreq = 12000.f;
+        settings.peakFreq = 1000.f;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakQuality = 1.f;
+        settings.lowCutSlope = Slope_48;
+        settings.highCutSlope = Slope_48;
+        return settings;
+    }
+
+    template <typename SampleType>
+    std::vector<BiquadSection<SampleType>> getBenchmarkSections()
+    {
+        const auto design = makeCascadeDesign<SampleType>(getBenchmarkSettings(), benchmarkSampleRate);
+        std::vector<BiquadSection<SampleType>> sections;
+
+        for (size_t slot = 0; slot < design.sections.size(); ++slot)
+            if (design.active[slot])
+                sections.push_back(design.sections[slot]);
+
+        return sections;
+    }
+
+    void printHeading(const juce::String& heading)
+    {
+        std::cout << std::endl << heading << std::endl;
+    }
+
+    void printRow(const juce::String& label, const juce::String& value)
+    {
+        std::cout << "  " << label.paddedRight(' ', 32) << value << std::endl;
+    }
+
+    juce::String formatNanoseconds(double nanoseconds)
+    {
+        return juce::String(nanoseconds, 2) + " ns/frame";
+    }
+
+    //==============================================================================
+    void setParameter(OloEQAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Nanoseconds per sample frame of the processor on noise. beforeBlock
+    // runs ahead of every block, outside the time, and every block includes
+    // the same copy.
+    template <typename Callback>
+    double measureProcessor(OloEQAudioProcessor& processor, int blockSize, int numBlocks, Callback&& beforeBlock)
+    {
+        const auto numChannels = processor.getTotalNumOutputChannels();
+        juce::AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(0x01E0);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < blockSize; ++n)
+                noise.setSample(channel, n, random.nextFloat() * 2.f - 1.f);
+
+        auto seconds = 0.0;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            beforeBlock(i);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.copyFrom(channel, 0, noise, channel, 0, blockSize);
+
+            processor.processBlock(buffer, midi);
+            seconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        }
+
+        return seconds * 1.0e9 / (static_cast<double>(numBlocks) * blockSize);
+    }
+
+    // Processing cost in nanoseconds per sample frame of a stereo processor
+    // in the biquad mode, first with static settings and then with all three
+    // bands swept continuously, so every control interval redesigns the
+    // cascade from the smoothed values
+    std::pair<double, double> benchmarkParameterSweep(Precision precision, int blockSize, int numBlocks)
+    {
+        constexpr double sweepSeconds = 2.0;   // one cycle, far slower than the smoothing
+
+        OloEQAudioProcessor processor;
+
+        setParameter(processor, "Precision", static_cast<float>(precision));
+        setParameter(processor, getParameterId("LowCut Slope", ParameterSet_A), static_cast<float>(Slope_24));
+        setParameter(processor, getParameterId("HighCut Slope", ParameterSet_A), static_cast<float>(Slope_24));
+        setParameter(processor, getParameterId("Peak Gain", ParameterSet_A), 6.f);
+
+        processor.prepareToPlay(benchmarkSampleRate, blockSize);
+
+        // The sweep moves every band's frequency across its range, and the
+        // peak gain and quality with it, so the smoothers never settle
+        auto sweep = [&processor, blockSize](int block)
+        {
+            const auto phase = juce::MathConstants<double>::twoPi * block * blockSize / (benchmarkSampleRate * sweepSeconds);
+            const auto position = static_cast<float>(0.5 + 0.5 * std::sin(phase));
+
+            setParameter(processor, getParameterId("LowCut Freq", ParameterSet_A), 20.f * std::pow(10.f, position));
+            setParameter(processor, getParameterId("Peak Freq", ParameterSet_A), 100.f * std::pow(100.f, position));
+            setParameter(processor, getParameterId("HighCut Freq", ParameterSet_A), 2000.f * std::pow(10.f, position));
+            setParameter(processor, getParameterId("Peak Gain", ParameterSet_A), 24.f * position - 12.f);
+            setParameter(processor, getParameterId("Peak Quality", ParameterSet_A), 0.5f + 4.f * position);
+        };
+
+        auto noChange = [](int) {};
+
+        // Let the settings above finish ramping before timing the static case
+        measureProcessor(processor, blockSize, numBlocks, noChange);
+
+        const auto staticCost = measureProcessor(processor, blockSize, numBlocks, noChange);
+        const auto sweepCost = measureProcessor(processor, blockSize, numBlocks, sweep);
+
+        processor.releaseResources();
+
+        return { staticCost, sweepCost };
+    }
+
+    // The same oversampler as the processor's, up and straight back down
+    template <typename SampleType>
+    double measureResampling(int order, int numChannels, int blockSize, int numBlocks)
+    {
+        juce::dsp::Oversampling<SampleType> oversampler(static_cast<size_t>(numChannels), static_cast<size_t>(order),
+                                                        juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                                                        true, true);
+        oversampler.initProcessing(static_cast<size_t>(blockSize));
+
+        juce::AudioBuffer<SampleType> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        juce::Random random(0x01E0);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < blockSize; ++n)
+                noise.setSample(channel, n, static_cast<SampleType>(random.nextFloat() * 2.f - 1.f));
+
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.copyFrom(channel, 0, noise, channel, 0, blockSize);
+
+            juce::dsp::AudioBlock<SampleType> block(buffer);
+            oversampler.processSamplesUp(block);
+            oversampler.processSamplesDown(block);
+        }
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / (static_cast<double>(numBlocks) * blockSize);
+    }
+
+    // Processing cost in nanoseconds per host sample frame of a stereo
+    // processor running the full biquad cascade at every oversampling
+    // factor, from off to 8x, and of the juce::dsp::Oversampling stages
+    // alone, up and straight back down
+    struct OversamplingBenchmarkStats
+    {
+        std::array<double, OloEQAudioProcessor::maxOversamplingOrder + 1> processorCost{}, resamplingCost{};
+    };
+
+    OversamplingBenchmarkStats benchmarkOversampling(Precision precision, int blockSize, int numBlocks)
+    {
+        OloEQAudioProcessor processor;
+
+        setParameter(processor, "Precision", static_cast<float>(precision));
+        setParameter(processor, getParameterId("LowCut Freq", ParameterSet_A), 60.f);
+        setParameter(processor, getParameterId("LowCut Slope", ParameterSet_A), static_cast<float>(Slope_48));
+        setParameter(processor, getParameterId("HighCut Freq", ParameterSet_A), 12000.f);
+        setParameter(processor, getParameterId("HighCut Slope", ParameterSet_A), static_cast<float>(Slope_48));
+        setParameter(processor, getParameterId("Peak Gain", ParameterSet_A), 6.f);
+
+        processor.prepareToPlay(benchmarkSampleRate, blockSize);
+
+        const auto numChannels = processor.getTotalNumOutputChannels();
+        auto noChange = [](int) {};
+
+        OversamplingBenchmarkStats stats;
+
+        for (int order = 0; order <= OloEQAudioProcessor::maxOversamplingOrder; ++order)
+        {
+            setParameter(processor, "Oversampling", static_cast<float>(order));
+
+            // The factor switch and the smoothing settle before the timed run
+            measureProcessor(processor, blockSize, juce::jmax(1, numBlocks / 8), noChange);
+
+            const auto index = static_cast<size_t>(order);
+            stats.processorCost[index] = measureProcessor(processor, blockSize, numBlocks, noChange);
+
+            if (order > 0)
+                stats.resamplingCost[index] = precision == Precision_Double
+                                                  ? measureResampling<double>(order, numChannels, blockSize, numBlocks)
+                                                  : measureResampling<float>(order, numChannels, blockSize, numBlocks);
+        }
+
+        processor.releaseResources();
+
+        return stats;
+    }
+
+    // Processing cost in nanoseconds per sample frame of the cascade run
+    // interleaved on the scalar kernel and run time blocked on the given one,
+    // for the given sections on every channel
+    template <typename SampleType>
+    std::pair<double, double> benchmarkTimeBlocking(KernelIsa blockedIsa, const BiquadSection<SampleType>* sections, int numSections,
+                                                    int numChannels, int blockSize, int numBlocks)
+    {
+        juce::AudioBuffer<SampleType> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        juce::Random random(0x01E0);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < blockSize; ++n)
+                noise.setSample(channel, n, static_cast<SampleType>(random.nextFloat() * 2.f - 1.f));
+
+        BiquadCascade<SampleType> cascade;
+        cascade.prepare(numChannels, blockSize, numSections, KernelIsa::scalar, blockedIsa);
+
+        for (int slot = 0; slot < numSections; ++slot)
+        {
+            cascade.setSlot(slot, sections[slot]);
+            cascade.setSlotActive(slot, true);
+        }
+
+        // Every block starts from the same noise, so both figures include the
+        // same copy
+        auto measure = [&]
+        {
+            cascade.reset();
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.copyFrom(channel, 0, noise, channel, 0, blockSize);
+
+                cascade.process(juce::dsp::AudioBlock<SampleType>(buffer));
+            }
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            return seconds * 1.0e9 / (static_cast<double>(numBlocks) * blockSize);
+        };
+
+        const auto interleavedCost = measure();
+        cascade.setTimeBlocked(true);
+        const auto blockedCost = measure();
+
+        return { interleavedCost, blockedCost };
+    }
+
+    struct ConvolverBenchmarkStats
+    {
+        // Audio thread cost in nanoseconds per sample frame, and the slowest
+        // block in microseconds
+        double uniformCost = 0.0, nonUniformCost = 0.0;
+        double uniformWorstBlock = 0.0, nonUniformWorstBlock = 0.0;
+        int deadlineMisses = 0;
+    };
+
+    // Runs noise through a kernel of kernelLength taps on a uniformly
+    // partitioned convolver and on a non-uniform one whose head partitions are
+    // the same size, so both add the same latency. The non-uniform run is paced
+    // in real time at sampleRate, so its worker gets the time it would get in a
+    // host.
+    ConvolverBenchmarkStats benchmarkConvolvers(int numChannels, int kernelLength, int partitionSize, int blockSize,
+                                                int numBlocks, double sampleRate)
+    {
+        juce::Random random(0x01E0);
+
+        // Decaying noise, so every partition of the kernel carries signal
+        std::vector<float> kernel(static_cast<size_t>(kernelLength));
+
+        for (size_t n = 0; n < kernel.size(); ++n)
+            kernel[n] = (random.nextFloat() * 2.f - 1.f) * std::exp(-4.f * static_cast<float>(n) / static_cast<float>(kernelLength));
+
+        juce::AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < blockSize; ++n)
+                noise.setSample(channel, n, random.nextFloat() * 2.f - 1.f);
+
+        // Every block starts from the same noise, so both figures include the
+        // same copy. Returns the total and the slowest block, in seconds.
+        auto measure = [&](auto& convolver, bool paced)
+        {
+            const auto blockPeriod = std::chrono::duration<double>(blockSize / sampleRate);
+            auto deadline = std::chrono::steady_clock::now();
+            auto total = 0.0, worst = 0.0;
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                if (paced)
+                {
+                    deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(blockPeriod);
+                    std::this_thread::sleep_until(deadline);
+                }
+
+                const auto start = juce::Time::getHighResolutionTicks();
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.copyFrom(channel, 0, noise, channel, 0, blockSize);
+
+                convolver.process(juce::dsp::AudioBlock<float>(buffer));
+
+                const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+                total += seconds;
+                worst = juce::jmax(worst, seconds);
+            }
+
+            return std::make_pair(total, worst);
+        };
+
+        const auto numFrames = static_cast<double>(numBlocks) * blockSize;
+        ConvolverBenchmarkStats stats;
+
+        {
+            PartitionedConvolver uniform;
+            uniform.prepare(numChannels, partitionSize, kernelLength);
+            uniform.loadKernel(kernel.data(), kernelLength, 0);
+
+            const auto times = measure(uniform, false);
+            stats.uniformCost = times.first * 1.0e9 / numFrames;
+            stats.uniformWorstBlock = times.second * 1.0e6;
+        }
+
+        {
+            NonUniformConvolver nonUniform;
+            nonUniform.prepare(numChannels, partitionSize, kernelLength);
+            nonUniform.loadKernel(kernel.data(), kernelLength, 0);
+            nonUniform.start();
+
+            const auto times = measure(nonUniform, true);
+            stats.nonUniformCost = times.first * 1.0e9 / numFrames;
+            stats.nonUniformWorstBlock = times.second * 1.0e6;
+            stats.deadlineMisses = nonUniform.getDeadlineMisses();
+
+            nonUniform.stop();
+        }
+
+        return stats;
+    }
+
+    struct FirDesignBenchmarkStats
+    {
+        // Averages in milliseconds, both including the partition transforms
+        double missMilliseconds = 0.0, hitMilliseconds = 0.0;
+    };
+
+    // Loads the request's kernel numRuns times under new keys, so each one is
+    // designed, and once more under each key, so it comes from the cache. Runs
+    // on the calling thread through designPendingNow, with the designer stopped.
+    FirDesignBenchmarkStats benchmarkFirDesign(const FirEngine::DesignRequest& request, int numRuns)
+    {
+        FirEngine engine;
+        engine.prepare(2, KernelIsa::scalar, request);
+
+        // The designer is left stopped, so every request is taken up here
+        auto timeLoad = [&engine](const FirEngine::DesignRequest& newRequest)
+        {
+            const auto accepted = engine.requestDesign(newRequest);
+            jassert(accepted);
+            juce::ignoreUnused(accepted);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            engine.designPendingNow();
+            return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0;
+        };
+
+        FirDesignBenchmarkStats stats;
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            auto fresh = request;
+            fresh.key[0] += run + 1;
+
+            stats.missMilliseconds += timeLoad(fresh);
+            stats.hitMilliseconds += timeLoad(fresh);
+        }
+
+        stats.missMilliseconds /= numRuns;
+        stats.hitMilliseconds /= numRuns;
+
+        return stats;
+    }
+
+    // Processing cost in nanoseconds per sample frame of the serial cascade and
+    // of its parallel form, for the given sections on every channel
+    std::pair<double, double> benchmarkParallelCascade(KernelIsa isa, const BiquadSection<double>* sections, int numSections,
+                                                       int numChannels, int blockSize, int numBlocks)
+    {
+        juce::AudioBuffer<double> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        juce::Random random(0x01E0);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < blockSize; ++n)
+                noise.setSample(channel, n, random.nextDouble() * 2.0 - 1.0);
+
+        std::array<int, ParallelExpansion::maxBranches> ids;
+        std::iota(ids.begin(), ids.end(), 0);
+
+        BiquadCascade<double> serial;
+        serial.prepare(numChannels, blockSize, numSections, isa);
+
+        for (int k = 0; k < numSections; ++k)
+        {
+            serial.setSlot(k, sections[k]);
+            serial.setSlotActive(k, true);
+        }
+
+        ParallelCascade parallel;
+        parallel.prepare(numChannels, blockSize, isa);
+
+        const auto expansion = expandCascade(sections, ids.data(), numSections);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            parallel.setExpansion(channel, expansion);
+
+        // Every block starts from the same noise, so both figures include the
+        // same copy
+        auto measure = [&](auto&& process)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.copyFrom(channel, 0, noise, channel, 0, blockSize);
+
+                process(juce::dsp::AudioBlock<double>(buffer));
+            }
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            return seconds * 1.0e9 / (static_cast<double>(numBlocks) * blockSize);
+        };
+
+        const auto serialCost = measure([&serial](const juce::dsp::AudioBlock<double>& block) { serial.process(block); });
+        const auto parallelCost = measure([&parallel](const juce::dsp::AudioBlock<double>& block) { parallel.process(block); });
+
+        return { serialCost, parallelCost };
+    }
+
+    struct OfflineRenderStats
+    {
+        double sequentialSeconds = 0.0, parallelSeconds = 0.0;
+        double maxDeviation = 0.0;   // largest sample difference between the two
+    };
+
+    // Renders noise through the sections once with one thread per channel, as
+    // sequential processing would, and once with renderCascadeOffline on
+    // numThreads threads
+    template <typename SampleType>
+    OfflineRenderStats benchmarkOfflineRender(const BiquadSection<SampleType>* sections, int numSections, int numChannels,
+                                              int numSamples, int numThreads)
+    {
+        juce::AudioBuffer<SampleType> sequential(numChannels, numSamples), parallel(numChannels, numSamples);
+        juce::Random random(0x01E0);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < numSamples; ++n)
+                sequential.setSample(channel, n, static_cast<SampleType>(random.nextFloat() * 2.f - 1.f));
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            parallel.copyFrom(channel, 0, sequential, channel, 0, numSamples);
+
+        const auto isa = getWidestKernelIsa<SampleType>();
+
+        OfflineRenderStats stats;
+
+        // With a thread per channel every channel is a single chunk, filtered
+        // sequentially
+        auto start = juce::Time::getHighResolutionTicks();
+        renderCascadeOffline(sections, numSections, sequential, isa, numChannels);
+
+        stats.sequentialSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        start = juce::Time::getHighResolutionTicks();
+
+        renderCascadeOffline(sections, numSections, parallel, isa, numThreads);
+
+        stats.parallelSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < numSamples; ++n)
+                stats.maxDeviation = juce::jmax(stats.maxDeviation, std::abs(static_cast<double>(parallel.getSample(channel, n))
+                                                                             - static_cast<double>(sequential.getSample(channel, n))));
+
+        return stats;
+    }
+
+    struct StateBenchmarkStats
+    {
+        double valueTreeSaveSeconds = 0.0, valueTreeRestoreSeconds = 0.0;
+        double binarySaveSeconds = 0.0, binaryRestoreSeconds = 0.0;
+        size_t valueTreeBytes = 0, binaryBytes = 0;   // per instance
+        bool statesMatch = true;                       // both formats restored the same values
+    };
+
+    template <typename Fn>
+    void forEachParameter(OloEQAudioProcessor& processor, Fn&& fn)
+    {
+        for (auto* parameter : processor.getParameters())
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+                fn(*ranged);
+    }
+
+    // Saves and restores the state of numInstances processors with random
+    // settings, in both formats, and times each step across all of them. The
+    // restores include the filter updates that follow them.
+    StateBenchmarkStats benchmarkStateRestore(int numInstances)
+    {
+        std::vector<std::unique_ptr<OloEQAudioProcessor>> processors;
+        juce::Random random(0x01E0);
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            processors.push_back(std::make_unique<OloEQAudioProcessor>());
+
+            forEachParameter(*processors.back(), [&random](juce::RangedAudioParameter& parameter)
+            {
+                parameter.setValueNotifyingHost(random.nextFloat());
+            });
+        }
+
+        auto resetAll = [&processors]
+        {
+            for (auto& processor : processors)
+                forEachParameter(*processor, [](juce::RangedAudioParameter& parameter)
+                {
+                    parameter.setValueNotifyingHost(parameter.getDefaultValue());
+                });
+        };
+
+        StateBenchmarkStats stats;
+        std::vector<juce::MemoryBlock> valueTreeStates(processors.size()), binaryStates(processors.size());
+
+        // The ValueTree format as it was saved before the binary one
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (size_t i = 0; i < processors.size(); ++i)
+        {
+            juce::MemoryOutputStream stream(valueTreeStates[i], false);
+            processors[i]->apvts.copyState().writeToStream(stream);
+        }
+
+        stats.valueTreeSaveSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        start = juce::Time::getHighResolutionTicks();
+
+        for (size_t i = 0; i < processors.size(); ++i)
+            processors[i]->getStateInformation(binaryStates[i]);
+
+        stats.binarySaveSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        // Every restore starts from the defaults, so every value changes
+        resetAll();
+        start = juce::Time::getHighResolutionTicks();
+
+        for (size_t i = 0; i < processors.size(); ++i)
+            processors[i]->setStateInformation(valueTreeStates[i].getData(), static_cast<int>(valueTreeStates[i].getSize()));
+
+        stats.valueTreeRestoreSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        std::vector<float> restoredValues;
+
+        for (auto& processor : processors)
+            forEachParameter(*processor, [&restoredValues](juce::RangedAudioParameter& parameter)
+            {
+                restoredValues.push_back(parameter.getValue());
+            });
+
+        resetAll();
+        start = juce::Time::getHighResolutionTicks();
+
+        for (size_t i = 0; i < processors.size(); ++i)
+            processors[i]->setStateInformation(binaryStates[i].getData(), static_cast<int>(binaryStates[i].getSize()));
+
+        stats.binaryRestoreSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        size_t next = 0;
+
+        for (auto& processor : processors)
+            forEachParameter(*processor, [&](juce::RangedAudioParameter& parameter)
+            {
+                stats.statesMatch = stats.statesMatch && parameter.getValue() == restoredValues[next++];
+            });
+
+        if (! processors.empty())
+        {
+            stats.valueTreeBytes = valueTreeStates.front().getSize();
+            stats.binaryBytes = binaryStates.front().getSize();
+        }
+
+        return stats;
+    }
+
+    struct PresetBenchmarkStats
+    {
+        double writeSeconds = 0.0, openSeconds = 0.0;
+        double findNameMicroseconds = 0.0, findPrefixMicroseconds = 0.0;
+        double findCategoryMicroseconds = 0.0, findTagMicroseconds = 0.0;
+        double searchNamesMicroseconds = 0.0, loadMicroseconds = 0.0;   // averages per call
+        size_t fileBytes = 0;
+        bool allFound = true;   // every preset was found by name and loaded back unchanged
+    };
+
+    // Writes a library of numPresets random presets to the file, opens it and
+    // times lookups and loads
+    PresetBenchmarkStats benchmarkPresetLibrary(const juce::File& file, int numPresets)
+    {
+        static const char* const adjectives[] = { "Warm", "Bright", "Airy", "Tight", "Smooth", "Crisp", "Dark", "Open" };
+        static const char* const sources[] = { "Vocal", "Kick", "Snare", "Bass", "Guitar", "Piano", "Strings", "Master" };
+        static const char* const categories[] = { "Drums", "Vocals", "Bass", "Guitars", "Keys", "Mix Bus", "Mastering", "FX" };
+        static const char* const tags[] = { "house", "gentle", "surgical", "broad", "low end", "presence", "de-mud", "air" };
+
+        juce::Random random(0x01E0);
+        std::vector<PresetLibrary::Preset> presets(static_cast<size_t>(numPresets));
+
+        auto randomChain = [&random]
+        {
+            ChainSettings chain;
+            chain.lowCutFreq = 20.f * std::pow(1000.f, random.nextFloat());
+            chain.highCutFreq = 20.f * std::pow(1000.f, random.nextFloat());
+            chain.peakFreq = 20.f * std::pow(1000.f, random.nextFloat());
+            chain.peakGainInDecibels = random.nextFloat() * 48.f - 24.f;
+            chain.peakQuality = 0.1f + random.nextFloat() * 9.9f;
+            chain.lowCutSlope = static_cast<Slope>(random.nextInt(4));
+            chain.highCutSlope = static_cast<Slope>(random.nextInt(4));
+            return chain;
+        };
+
+        for (int i = 0; i < numPresets; ++i)
+        {
+            auto& preset = presets[static_cast<size_t>(i)];
+            preset.name = juce::String(adjectives[random.nextInt(8)]) + " " + sources[random.nextInt(8)] + " " + juce::String(i);
+            preset.category = categories[random.nextInt(8)];
+
+            for (int tag = random.nextInt(3); tag >= 0; --tag)
+                preset.tags.addIfNotAlreadyThere(tags[random.nextInt(8)]);
+
+            preset.settings.a = randomChain();
+            preset.settings.b = randomChain();
+            preset.settings.b.peakDesign = preset.settings.a.peakDesign = static_cast<PeakDesign>(random.nextInt(2));
+            preset.settings.stereoMode = static_cast<StereoMode>(random.nextInt(5));
+            preset.settings.peakLink = random.nextBool();
+
+            for (auto& band : preset.settings.bands)
+            {
+                band.enabled = random.nextBool();
+                band.type = static_cast<BandType>(random.nextInt(6));
+                band.frequency = 20.f * std::pow(1000.f, random.nextFloat());
+                band.gainInDecibels = random.nextFloat() * 48.f - 24.f;
+                band.quality = 0.1f + random.nextFloat() * 9.9f;
+                band.order = 1 + random.nextInt(BandEngine<float>::maxCutOrder);
+            }
+        }
+
+        PresetBenchmarkStats stats;
+
+        auto secondsSince = [](juce::int64 start)
+        {
+            return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        };
+
+        auto start = juce::Time::getHighResolutionTicks();
+        PresetLibrary::write(file, presets);
+        stats.writeSeconds = secondsSince(start);
+        stats.fileBytes = static_cast<size_t>(file.getSize());
+
+        PresetLibrary library;
+        start = juce::Time::getHighResolutionTicks();
+        stats.allFound = library.open(file);
+        stats.openSeconds = secondsSince(start);
+
+        // Every preset is found by name and loaded once, then checked
+        std::vector<int> found(presets.size());
+        std::vector<PresetSettings> loaded(presets.size());
+
+        start = juce::Time::getHighResolutionTicks();
+
+        for (size_t i = 0; i < presets.size(); ++i)
+            found[i] = library.findName(presets[i].name);
+
+        stats.findNameMicroseconds = secondsSince(start) * 1.0e6 / juce::jmax(1, numPresets);
+        start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < library.getNumPresets(); ++i)
+            loaded[static_cast<size_t>(i)] = library.getSettings(i);
+
+        stats.loadMicroseconds = secondsSince(start) * 1.0e6 / juce::jmax(1, numPresets);
+
+        for (size_t i = 0; i < presets.size(); ++i)
+            stats.allFound = stats.allFound && found[i] >= 0
+                          && loaded[static_cast<size_t>(found[i])].getPathSettings() == presets[i].settings.getPathSettings()
+                          && loaded[static_cast<size_t>(found[i])].bands == presets[i].settings.bands;
+
+        // Queries cycle through every adjective, source, category and tag
+        constexpr int numQueries = 1000;
+        std::vector<int> results;
+        juce::StringArray adjectiveQueries(adjectives, 8), sourceQueries(sources, 8);
+        juce::StringArray categoryQueries(categories, 8), tagQueries(tags, 8);
+
+        auto timeQueries = [&secondsSince](auto&& query)
+        {
+            const auto begin = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numQueries; ++i)
+                query(i % 8);
+
+            return secondsSince(begin) * 1.0e6 / numQueries;
+        };
+
+        stats.findPrefixMicroseconds = timeQueries([&](int i) { library.findNamePrefix(adjectiveQueries[i]); });
+        stats.findCategoryMicroseconds = timeQueries([&](int i) { library.findCategory(categoryQueries[i], results); });
+        stats.findTagMicroseconds = timeQueries([&](int i) { library.findTag(tagQueries[i], results); });
+        stats.searchNamesMicroseconds = timeQueries([&](int i) { library.searchNames(sourceQueries[i], results); });
+
+        return stats;
+    }
+
+    //==============================================================================
+    void benchmarkSweeps()
+    {
+        printHeading("Parameter sweep, stereo biquad mode, " + juce::String(benchmarkBlockSize) + " sample blocks");
+
+        for (auto precision : { Precision_Float, Precision_Double })
+        {
+            const auto costs = benchmarkParameterSweep(precision, benchmarkBlockSize, benchmarkBlocks);
+            const juce::String name(precision == Precision_Float ? "float" : "double");
+
+            printRow(name + ", static", formatNanoseconds(costs.first));
+            printRow(name + ", all bands swept", formatNanoseconds(costs.second));
+        }
+    }
+
+    // Settings for the sample a sweep of all three bands has reached, one
+    // cycle every two seconds
+    ChainSettings getSweptSettings(int sample)
+    {
+        const auto phase = juce::MathConstants<double>::twoPi * sample / (2.0 * benchmarkSampleRate);
+        const auto position = static_cast<float>(0.5 + 0.5 * std::sin(phase));
+
+        auto settings = getBenchmarkSettings();
+        settings.lowCutFreq = 20.f * std::pow(10.f, position);
+        settings.peakFreq = 100.f * std::pow(100.f, position);
+        settings.highCutFreq = 2000.f * std::pow(10.f, position);
+        settings.peakGainInDecibels = 24.f * position - 12.f;
+        settings.peakQuality = 0.5f + 4.f * position;
+        return settings;
+    }
+
+    template <typename SampleType>
+    void tuneSvf(SvfEngine<SampleType>& svf, const ChainSettings& settings)
+    {
+        svf.setLowCut(static_cast<SampleType>(settings.lowCutFreq), 2 * settings.lowCutSlope + 1);
+        svf.setPeak(static_cast<SampleType>(settings.peakFreq), static_cast<SampleType>(settings.peakQuality),
+                    static_cast<SampleType>(settings.peakGainInDecibels));
+        svf.setHighCut(static_cast<SampleType>(settings.highCutFreq), 2 * settings.highCutSlope + 1);
+    }
+
+    // Nanoseconds per frame of the full cascade, stereo, as SVFs or biquads.
+    // Swept, every band is retuned every sample, as the processor does
+    // while its smoothers ramp.
+    template <typename SampleType>
+    double measureSvfOrBiquads(bool useSvf, bool swept)
+    {
+        constexpr int numChannels = 2;
+        constexpr int numBlocks = benchmarkBlocks / 4;
+
+        SvfEngine<SampleType> svf;
+        svf.prepare(benchmarkSampleRate, numChannels);
+        tuneSvf(svf, getBenchmarkSettings());
+
+        BiquadCascade<SampleType> cascade;
+        cascade.prepare(numChannels, benchmarkBlockSize, NumCascadeSlots, getBestKernelIsa<SampleType>(numChannels));
+        applyCascadeDesign(cascade, makeCascadeDesign<SampleType>(getBenchmarkSettings(), benchmarkSampleRate));
+
+        juce::AudioBuffer<SampleType> buffer(numChannels, benchmarkBlockSize);
+        juce::Random random(0x05F0);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < benchmarkBlockSize; ++n)
+                buffer.setSample(channel, n, static_cast<SampleType>(random.nextFloat() * 2.f - 1.f));
+
+        // Runs on its own output, which the cuts keep bounded
+        juce::dsp::AudioBlock<SampleType> block(buffer);
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            if (! swept)
+            {
+                if (useSvf)
+                    svf.process(block);
+                else
+                    cascade.process(block);
+
+                continue;
+            }
+
+            for (int n = 0; n < benchmarkBlockSize; ++n)
+            {
+                const auto settings = getSweptSettings(b * benchmarkBlockSize + n);
+                const auto sample = block.getSubBlock(static_cast<size_t>(n), 1);
+
+                if (useSvf)
+                {
+                    tuneSvf(svf, settings);
+                    svf.process(sample);
+                }
+                else
+                {
+                    applyCascadeDesign(cascade, makeCascadeDesign<SampleType>(settings, benchmarkSampleRate));
+                    cascade.process(sample);
+                }
+            }
+        }
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / (static_cast<double>(numBlocks) * benchmarkBlockSize);
+    }
+
+    void benchmarkSvf()
+    {
+        printHeading("SVF engine / biquad cascade, stereo, full cascade");
+
+        for (auto precision : { Precision_Float, Precision_Double })
+        {
+            const juce::String name(precision == Precision_Float ? "float" : "double");
+
+            for (auto swept : { false, true })
+            {
+                const auto svfCost = precision == Precision_Float ? measureSvfOrBiquads<float>(true, swept)
+                                                                  : measureSvfOrBiquads<double>(true, swept);
+                const auto biquadCost = precision == Precision_Float ? measureSvfOrBiquads<float>(false, swept)
+                                                                     : measureSvfOrBiquads<double>(false, swept);
+
+                printRow(name + (swept ? ", swept every sample" : ", static"),
+                         formatNanoseconds(svfCost) + " / " + formatNanoseconds(biquadCost));
+            }
+        }
+    }
+
+    // One control-rate update of a looped automation curve: a peak and two
+    // order 8 cuts, every band moving, designed through the cache or not
+    struct AutomationCacheStats
+    {
+        double cachedNanoseconds = 0.0, uncachedNanoseconds = 0.0;
+        int hits = 0, misses = 0;
+    };
+
+    template <typename SampleType>
+    AutomationCacheStats measureAutomationCache()
+    {
+        // One second of updates every 64 samples, looped. Each loop
+        // asks for 2250 bands, fewer once quantised, which fit the 4096 the
+        // processor allocates.
+        constexpr int numUpdatesPerLoop = static_cast<int>(benchmarkSampleRate) / 64;
+        constexpr int numLoops = 16;
+        constexpr int cutOrder = 8;
+        constexpr int cacheCapacity = 4096;
+
+        struct Update { SampleType peakFrequency, quality, gain, lowCutFrequency, highCutFrequency; };
+        std::vector<Update> curve;
+
+        for (int i = 0; i < numUpdatesPerLoop; ++i)
+        {
+            const auto position = static_cast<SampleType>(0.5 + 0.5 * std::sin(juce::MathConstants<double>::twoPi * i / numUpdatesPerLoop));
+
+            curve.push_back({ static_cast<SampleType>(100.0 * std::pow(100.0, position)),
+                              static_cast<SampleType>(0.5 + 4.0 * position),
+                              static_cast<SampleType>(24.0 * position - 12.0),
+                              static_cast<SampleType>(20.0 * std::pow(10.0, position)),
+                              static_cast<SampleType>(2000.0 * std::pow(10.0, position)) });
+        }
+
+        CoefficientCache<SampleType> cache;
+        cache.prepare(cacheCapacity);
+
+        std::array<BiquadSection<SampleType>, cutOrder / 2> sections;
+        auto sink = SampleType{};
+
+        auto measure = [&](auto&& update)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int loop = 0; loop < numLoops; ++loop)
+                for (const auto& point : curve)
+                    update(point);
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            return seconds * 1.0e9 / (static_cast<double>(numLoops) * numUpdatesPerLoop);
+        };
+
+        AutomationCacheStats stats;
+
+        stats.cachedNanoseconds = measure([&](const Update& point)
+        {
+            sink += cache.designPeak(benchmarkSampleRate, point.peakFrequency, point.quality, point.gain, false).b0;
+            cache.designHighPass(benchmarkSampleRate, point.lowCutFrequency, cutOrder, sections.data());
+            sink += sections[0].b0;
+            cache.designLowPass(benchmarkSampleRate, point.highCutFrequency, cutOrder, sections.data());
+            sink += sections[0].b0;
+        });
+
+        stats.uncachedNanoseconds = measure([&](const Update& point)
+        {
+            sink += designPeakSection(benchmarkSampleRate, point.peakFrequency, point.quality, point.gain).b0;
+            designButterworthHighPass(benchmarkSampleRate, point.lowCutFrequency, cutOrder, sections.data());
+            sink += sections[0].b0;
+            designButterworthLowPass(benchmarkSampleRate, point.highCutFrequency, cutOrder, sections.data());
+            sink += sections[0].b0;
+        });
+
+        stats.hits = cache.getHits();
+        stats.misses = cache.getMisses();
+
+        benchmarkSink = static_cast<double>(sink);
+        return stats;
+    }
+
+    void benchmarkCoefficientCache()
+    {
+        printHeading("Coefficient cache, looped automation of a peak and two order 8 cuts, cached / uncached");
+
+        for (auto precision : { Precision_Float, Precision_Double })
+        {
+            const auto stats = precision == Precision_Float ? measureAutomationCache<float>()
+                                                            : measureAutomationCache<double>();
+            const juce::String name(precision == Precision_Float ? "float" : "double");
+
+            printRow(name, juce::String(stats.cachedNanoseconds, 1) + " / "
+                           + juce::String(stats.uncachedNanoseconds, 1) + " ns/update");
+            printRow(name + ", hits / misses", juce::String(stats.hits) + " / " + juce::String(stats.misses));
+        }
+    }
+
+    // Nanoseconds per design of a Butterworth high pass of each order,
+    // through the in-tree designer and through FilterDesign
+    template <typename SampleType>
+    std::pair<double, double> measureButterworthDesign(int order)
+    {
+        constexpr int numDesigns = 20000;
+
+        BiquadSection<SampleType> sections[maxTabulatedButterworthOrder / 2];
+        auto sink = SampleType{};
+
+        auto measure = [&](auto&& design)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            // Sweeps the frequency so no two designs are the same
+            for (int i = 0; i < numDesigns; ++i)
+                design(static_cast<SampleType>(20.0 + 0.5 * i));
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            return seconds * 1.0e9 / numDesigns;
+        };
+
+        const auto inTree = measure([&](SampleType frequency)
+        {
+            designButterworthHighPass(benchmarkSampleRate, frequency, order, sections);
+            sink += sections[0].b0;
+        });
+
+        const auto filterDesign = measure([&](SampleType frequency)
+        {
+            const auto design = juce::dsp::FilterDesign<SampleType>::designIIRHighpassHighOrderButterworthMethod(frequency, benchmarkSampleRate, order);
+            sink += design[0]->coefficients[0];
+        });
+
+        benchmarkSink = static_cast<double>(sink);
+        return { inTree, filterDesign };
+    }
+
+    void benchmarkButterworthDesign()
+    {
+        printHeading("Butterworth high pass design, in-tree / FilterDesign, float and double");
+
+        for (int order = 1; order <= maxTabulatedButterworthOrder; ++order)
+        {
+            const auto floatCosts = measureButterworthDesign<float>(order);
+            const auto doubleCosts = measureButterworthDesign<double>(order);
+
+            printRow("order " + juce::String(order),
+                     juce::String(floatCosts.first, 1) + " / " + juce::String(floatCosts.second, 1) + " ns, "
+                         + juce::String(doubleCosts.first, 1) + " / " + juce::String(doubleCosts.second, 1) + " ns");
+        }
+    }
+
+    void benchmarkOversamplingFactors()
+    {
+        static const char* const factorNames[] = { "off", "2x", "4x", "8x" };
+
+        for (auto precision : { Precision_Float, Precision_Double })
+        {
+            printHeading(juce::String("Oversampling, ") + (precision == Precision_Float ? "float" : "double")
+                         + ", stereo, full cascade, processor / resampling alone");
+
+            const auto stats = benchmarkOversampling(precision, benchmarkBlockSize, benchmarkBlocks);
+
+            for (size_t order = 0; order < stats.processorCost.size(); ++order)
+                printRow(factorNames[order], formatNanoseconds(stats.processorCost[order]) + " / "
+                                             + formatNanoseconds(stats.resamplingCost[order]));
+        }
+    }
+
+    template <typename SampleType>
+    void benchmarkKernels(const char* precisionName)
+    {
+        const auto sections = getBenchmarkSections<SampleType>();
+        const auto numSections = static_cast<int>(sections.size());
+
+        printHeading(juce::String("Time blocking, ") + precisionName + ", " + juce::String(numSections) + " sections, mono");
+
+        for (auto isa : { KernelIsa::scalar, KernelIsa::sse2, KernelIsa::avx2, KernelIsa::avx512, KernelIsa::neon })
+        {
+            if (! isKernelIsaSupported(isa))
+                continue;
+
+            const auto costs = benchmarkTimeBlocking(isa, sections.data(), numSections, 1, benchmarkBlockSize, benchmarkBlocks);
+            printRow(juce::String(getKernelIsaName(isa)) + ", interleaved / blocked",
+                     formatNanoseconds(costs.first) + " / " + formatNanoseconds(costs.second));
+        }
+    }
+
+    void benchmarkParallel()
+    {
+        const auto sections = getBenchmarkSections<double>();
+        const auto numSections = static_cast<int>(sections.size());
+        const auto isa = getBestKernelIsa<double>(2);
+
+        printHeading("Parallel form, double, " + juce::String(numSections) + " sections, stereo, "
+                     + getKernelIsaName(isa));
+
+        const auto costs = benchmarkParallelCascade(isa, sections.data(), numSections, 2, benchmarkBlockSize, benchmarkBlocks);
+        printRow("serial", formatNanoseconds(costs.first));
+        printRow("parallel", formatNanoseconds(costs.second));
+    }
+
+    void benchmarkOffline()
+    {
+        const auto sections = getBenchmarkSections<double>();
+        const auto numThreads = juce::SystemStats::getNumCpus();
+
+        printHeading("Offline render, double, 8 channels, 60 seconds, " + juce::String(numThreads) + " threads");
+
+        const auto stats = benchmarkOfflineRender(sections.data(), static_cast<int>(sections.size()), 8,
+                                                  static_cast<int>(60.0 * benchmarkSampleRate), numThreads);
+        printRow("sequential", juce::String(stats.sequentialSeconds * 1000.0, 1) + " ms");
+        printRow("parallel", juce::String(stats.parallelSeconds * 1000.0, 1) + " ms");
+        printRow("largest difference", juce::String(stats.maxDeviation));
+    }
+
+    void benchmarkPresets()
+    {
+        constexpr int numPresets = 10000;
+        juce::TemporaryFile file(".olopresets");
+
+        printHeading("Preset library, " + juce::String(numPresets) + " presets");
+
+        const auto stats = benchmarkPresetLibrary(file.getFile(), numPresets);
+        printRow("write / open", juce::String(stats.writeSeconds * 1000.0, 1) + " ms / "
+                                 + juce::String(stats.openSeconds * 1000.0, 2) + " ms");
+        printRow("find name / prefix", juce::String(stats.findNameMicroseconds, 2) + " us / "
+                                       + juce::String(stats.findPrefixMicroseconds, 2) + " us");
+        printRow("find category / tag", juce::String(stats.findCategoryMicroseconds, 2) + " us / "
+                                        + juce::String(stats.findTagMicroseconds, 2) + " us");
+        printRow("search names / load", juce::String(stats.searchNamesMicroseconds, 2) + " us / "
+                                        + juce::String(stats.loadMicroseconds, 2) + " us");
+        printRow("file size", juce::String(static_cast<juce::int64>(stats.fileBytes)) + " bytes");
+        printRow("all found", stats.allFound ? "yes" : "NO");
+    }
+
+    void benchmarkConvolution()
+    {
+        constexpr int kernelLength = 65536;
+        constexpr int hostBlockSize = 128;
+        constexpr int numBlocks = 1500;   // 4 seconds, paced in real time
+
+        printHeading("Convolution, " + juce::String(kernelLength) + " taps, stereo, " + juce::String(hostBlockSize)
+                     + " sample blocks, audio thread cost (slowest block)");
+
+        for (auto partitionSize : { 128, 512 })
+        {
+            const auto stats = benchmarkConvolvers(2, kernelLength, partitionSize, hostBlockSize, numBlocks, benchmarkSampleRate);
+            const juce::String size(partitionSize);
+
+            printRow("uniform " + size, formatNanoseconds(stats.uniformCost)
+                                        + " (" + juce::String(stats.uniformWorstBlock, 0) + " us)");
+            printRow("non-uniform, head " + size, formatNanoseconds(stats.nonUniformCost)
+                                                  + " (" + juce::String(stats.nonUniformWorstBlock, 0) + " us), "
+                                                  + juce::String(stats.deadlineMisses) + " misses");
+        }
+    }
+
+    void benchmarkFirLengths()
+    {
+        constexpr int partitionSize = 512;
+        constexpr int numBlocks = 375;   // 4 seconds, paced in real time
+
+        printHeading("FIR length, stereo, " + juce::String(partitionSize)
+                     + " sample partitions and blocks, uniform / non-uniform audio thread cost");
+
+        for (int length = FirEngine::minLength; length <= FirEngine::maxLength; length *= 2)
+        {
+            const auto stats = benchmarkConvolvers(2, length, partitionSize, partitionSize, numBlocks, benchmarkSampleRate);
+            printRow(juce::String(length) + " taps", formatNanoseconds(stats.uniformCost) + " / "
+                                                     + formatNanoseconds(stats.nonUniformCost));
+        }
+    }
+
+    void benchmarkFirDesigns()
+    {
+        constexpr int numRuns = 8;
+
+        FirEngine::DesignRequest request;
+
+        for (const auto& section : getBenchmarkSections<double>())
+            request.sections[static_cast<size_t>(request.numSections++)] = section;
+
+        printHeading("FIR design, full cascade, designed / from the cache");
+
+        for (auto phase : { FirPhase::linear, FirPhase::minimum })
+        {
+            for (int length = FirEngine::minLength; length <= FirEngine::maxLength; length *= 4)
+            {
+                request.length = length;
+                request.phase = phase;
+
+                const auto stats = benchmarkFirDesign(request, numRuns);
+                printRow(juce::String(phase == FirPhase::linear ? "linear " : "minimum ") + juce::String(length) + " taps",
+                         juce::String(stats.missMilliseconds, 2) + " ms / " + juce::String(stats.hitMilliseconds, 2) + " ms");
+            }
+        }
+    }
+
+    // Nanoseconds per frame of a stereo band engine with the first numBands
+    // bands on as peaks spread across the range
+    template <typename SampleType>
+    double measureBandEngine(KernelIsa isa, int numBands)
+    {
+        constexpr int numChannels = 2;
+
+        BandEngine<SampleType> engine;
+        engine.prepare(benchmarkSampleRate, numChannels, benchmarkBlockSize, isa);
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            BandSettings settings;
+            settings.enabled = true;
+            settings.frequency = 20.f * std::pow(1000.f, (static_cast<float>(band) + 0.5f) / static_cast<float>(numBands));
+            settings.gainInDecibels = band % 2 == 0 ? 3.f : -3.f;
+            engine.setBand(band, settings);
+        }
+
+        juce::AudioBuffer<SampleType> buffer(numChannels, benchmarkBlockSize);
+        juce::Random random(0x01E0);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < benchmarkBlockSize; ++n)
+                buffer.setSample(channel, n, static_cast<SampleType>(random.nextFloat() * 2.f - 1.f));
+
+        // Runs on its own output, which the small alternating gains keep bounded
+        juce::dsp::AudioBlock<SampleType> block(buffer);
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < benchmarkBlocks; ++i)
+            engine.process(block);
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / (static_cast<double>(benchmarkBlocks) * benchmarkBlockSize);
+    }
+
+    void benchmarkBandCounts()
+    {
+        printHeading("Band engine, stereo peaks, float / double");
+
+        for (auto isa : { KernelIsa::scalar, KernelIsa::sse2, KernelIsa::avx2, KernelIsa::avx512, KernelIsa::neon })
+        {
+            if (! isKernelIsaSupported(isa))
+                continue;
+
+            for (auto numBands : { 0, 1, 3, 6, 12, 24 })
+                printRow(juce::String(getKernelIsaName(isa)) + ", " + juce::String(numBands) + " bands",
+                         formatNanoseconds(measureBandEngine<float>(isa, numBands)) + " / "
+                             + formatNanoseconds(measureBandEngine<double>(isa, numBands)));
+        }
+    }
+
+    void benchmarkState()
+    {
+        constexpr int numInstances = 1000;
+
+        printHeading("State save / restore, " + juce::String(numInstances) + " instances");
+
+        const auto stats = benchmarkStateRestore(numInstances);
+        auto formatMilliseconds = [](double seconds) { return juce::String(seconds * 1000.0, 1) + " ms"; };
+
+        printRow("ValueTree save / restore", formatMilliseconds(stats.valueTreeSaveSeconds) + " / "
+                                             + formatMilliseconds(stats.valueTreeRestoreSeconds));
+        printRow("binary save / restore", formatMilliseconds(stats.binarySaveSeconds) + " / "
+                                          + formatMilliseconds(stats.binaryRestoreSeconds));
+        printRow("ValueTree / binary size", juce::String(static_cast<juce::int64>(stats.valueTreeBytes)) + " / "
+                                            + juce::String(static_cast<juce::int64>(stats.binaryBytes)) + " bytes");
+        printRow("states match", stats.statesMatch ? "yes" : "NO");
+    }
+}
+
+//==============================================================================
+int runBenchmarks()
+{
+    std::cout << juce::SystemStats::getCpuModel() << ", " << juce::SystemStats::getNumCpus() << " cores" << std::endl;
+
+   #if JUCE_DEBUG
+    std::cout << "Debug build, the figures are not representative" << std::endl;
+   #endif
+
+    benchmarkSweeps();
+    benchmarkSvf();
+    benchmarkCoefficientCache();
+    benchmarkButterworthDesign();
+    benchmarkOversamplingFactors();
+    benchmarkKernels<float>("float");
+    benchmarkKernels<double>("double");
+    benchmarkBandCounts();
+    benchmarkParallel();
+    benchmarkOffline();
+    benchmarkConvolution();
+    benchmarkFirLengths();
+    benchmarkFirDesigns();
+    benchmarkPresets();
+    benchmarkState();
+
+    return 0;
+}
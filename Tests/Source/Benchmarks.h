@@ -0,0 +1,17 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+    Runs the benchmarks, which drive the plugin's classes through their
+    public interfaces, and prints their figures. Timings depend on the machine and the build, so
+    only Release builds give figures worth quoting.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Prints the results to stdout, returns the exit code
+int runBenchmarks();
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    ButterworthDesignTests.cpp
+    Checks the Butterworth cut designers against FilterDesign, which they
+    replace: the same sections in the same order, coefficient by
+    coefficient, for every order the cuts use, across the audible range
+    and the usual sample rates, in float and double.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+namespace
+{
+    const double testSampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const double testFrequencies[] = { 20.0, 30.0, 100.0, 440.0, 1000.0, 3000.0, 8000.0, 15000.0, 20000.0 };
+
+    // Both evaluate the same formulas, rearranged, so only rounding differs
+    constexpr float floatTolerance = 1.0e-6f;
+    constexpr double doubleTolerance = 1.0e-12;
+}
+
+//==============================================================================
+class ButterworthDesignTests : public juce::UnitTest
+{
+public:
+    ButterworthDesignTests() : juce::UnitTest("Butterworth design", "OloEQ") {}
+
+    void runTest() override
+    {
+        runPrecision<float>("float");
+        runPrecision<double>("double");
+    }
+
+private:
+    template <typename SampleType>
+    void runPrecision(const juce::String& precisionName)
+    {
+        using Design = juce::dsp::FilterDesign<SampleType>;
+
+        for (auto highPass : { true, false })
+        {
+            beginTest(juce::String(highPass ? "High pass" : "Low pass") + " against FilterDesign, " + precisionName);
+
+            for (int order = 1; order <= maxTabulatedButterworthOrder; ++order)
+            {
+                for (auto sampleRate : testSampleRates)
+                {
+                    for (auto testFrequency : testFrequencies)
+                    {
+                        const auto frequency = static_cast<SampleType>(testFrequency);
+                        const auto reference = highPass ? Design::designIIRHighpassHighOrderButterworthMethod(frequency, sampleRate, order)
+                                                        : Design::designIIRLowpassHighOrderButterworthMethod(frequency, sampleRate, order);
+
+                        compareDesign(highPass, frequency, sampleRate, order, reference);
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename SampleType>
+    void compareDesign(bool highPass, SampleType frequency, double sampleRate, int order,
+                       const juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<SampleType>>& reference)
+    {
+        const juce::String name("order " + juce::String(order) + " at " + juce::String(frequency) + " Hz, "
+                                + juce::String(sampleRate) + " Hz");
+
+        BiquadSection<SampleType> sections[maxTabulatedButterworthOrder / 2];
+        const auto numSections = highPass ? designButterworthHighPass(sampleRate, frequency, order, sections)
+                                          : designButterworthLowPass(sampleRate, frequency, order, sections);
+
+        expectEquals(numSections, reference.size(), "Section count, " + name);
+
+        for (int i = 0; i < juce::jmin(numSections, reference.size()); ++i)
+        {
+            const auto& section = sections[i];
+            const auto& coefficients = reference[i]->coefficients;
+
+            // FilterDesign keeps b0, b1, a1 for first order sections and
+            // b0, b1, b2, a1, a2 for second order ones, all over a0
+            const auto firstOrder = coefficients.size() == 3;
+            const SampleType designed[] = { section.b0, section.b1, section.b2, section.a1, section.a2 };
+            const SampleType expected[] = { coefficients[0], coefficients[1], firstOrder ? SampleType() : coefficients[2],
+                                            coefficients[firstOrder ? 2 : 3], firstOrder ? SampleType() : coefficients[4] };
+
+            for (size_t c = 0; c < std::size(designed); ++c)
+                expectWithinAbsoluteError(designed[c], expected[c], static_cast<SampleType>(std::is_same<SampleType, float>::value ? floatTolerance : doubleTolerance),
+                                          "Coefficient " + juce::String(static_cast<int>(c)) + " of section "
+                                              + juce::String(i) + ", " + name);
+        }
+    }
+};
+
+static ButterworthDesignTests butterworthDesignTests;
@@ -0,0 +1,458 @@
+/*
+  ==============================================================================
+
+    FilterKernelTests.cpp
+    Regression tests for the DSP kernels. Renders fixed signals through a
+    grid of chain settings and checks:
+     - the scalar kernel against the stored golden outputs, bit for bit,
+       and the designers against the stored coefficients,
+     - the scalar kernel against MonoChain on the same coefficients,
+       exactly, signed zeros aside,
+     - SIMD kernels within -80 dB of the scalar output, in float and double,
+     - the time-blocked kernels within twice the scalar kernel's error
+       against the double output, and within -80 dB of it in double,
+     - the parallel form, wherever a design has one, within the same
+       -80 dB of the scalar double output,
+     - the rendered magnitude and the response curve kernels against
+       getMagnitudeForFrequency on the JUCE-designed coefficients.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "GoldenData.h"
+#include "ParallelCascade.h"
+
+namespace
+{
+    constexpr double testSampleRate = KernelGoldenData::sampleRate;
+    constexpr int impulseLength = 32768;   // long enough for 20 Hz, high-Q tails to decay
+
+    constexpr float simdToleranceDb      = -80.f;
+    constexpr float magnitudeToleranceDb = 0.05f;
+    constexpr float curveToleranceDb     = 0.1f;
+    constexpr float magnitudeFloorDb     = -30.f;
+
+    // The designers run in float, so allow for a different libm
+    constexpr float designTolerance = 1.0e-5f;
+
+    const float testFrequencies[] = { 30.f, 100.f, 440.f, 1000.f, 3000.f, 8000.f, 15000.f };
+
+    const KernelIsa simdIsas[] = { KernelIsa::sse2, KernelIsa::avx2, KernelIsa::avx512, KernelIsa::neon };
+    const KernelIsa allIsas[] = { KernelIsa::scalar, KernelIsa::sse2, KernelIsa::avx2, KernelIsa::avx512, KernelIsa::neon };
+
+    //==============================================================================
+    template <int Index>
+    void loadCutFilter(CutFilter& cutFilter, const CascadeDesign<float>& design, int firstSlot)
+    {
+        const auto slot = static_cast<size_t>(firstSlot + Index);
+        const auto& section = design.sections[slot];
+
+        if (design.active[slot])
+            updateCoefficients(cutFilter.template get<Index>().coefficients,
+                               new juce::dsp::IIR::Coefficients<float>(section.b0, section.b1, section.b2,
+                                                                       1.f, section.a1, section.a2));
+
+        cutFilter.template setBypassed<Index>(! design.active[slot]);
+    }
+
+    // The reference chain runs the same coefficients through JUCE's own
+    // IIR::Filter, so this isolates the kernels from the designers
+    std::vector<float> renderMonoChain(const CascadeDesign<float>& design, const std::vector<float>& input)
+    {
+        const auto& peak = design.sections[PeakSlot];
+
+        MonoChain chain;
+
+        updateCoefficients(chain.get<ChainPositions::Peak>().coefficients,
+                           new juce::dsp::IIR::Coefficients<float>(peak.b0, peak.b1, peak.b2, 1.f, peak.a1, peak.a2));
+
+        auto& lowCut = chain.get<ChainPositions::LowCut>();
+        loadCutFilter<0>(lowCut, design, LowCutSlot);
+        loadCutFilter<1>(lowCut, design, LowCutSlot);
+        loadCutFilter<2>(lowCut, design, LowCutSlot);
+        loadCutFilter<3>(lowCut, design, LowCutSlot);
+
+        auto& highCut = chain.get<ChainPositions::HighCut>();
+        loadCutFilter<0>(highCut, design, HighCutSlot);
+        loadCutFilter<1>(highCut, design, HighCutSlot);
+        loadCutFilter<2>(highCut, design, HighCutSlot);
+        loadCutFilter<3>(highCut, design, HighCutSlot);
+
+        chain.prepare({ testSampleRate, static_cast<juce::uint32>(input.size()), 1 });
+
+        auto output = input;
+        float* channels[] = { output.data() };
+        juce::dsp::AudioBlock<float> block(channels, 1, output.size());
+        chain.process(juce::dsp::ProcessContextReplacing<float>(block));
+
+        return output;
+    }
+
+    // Renders the input on every lane of the kernel and returns all lanes
+    template <typename SampleType>
+    std::vector<std::vector<SampleType>> renderKernel(const ChainSettings& settings, const std::vector<float>& input, KernelIsa isa)
+    {
+        const auto numChannels = getFilterKernels<SampleType>(isa).laneWidth;
+        std::vector<std::vector<SampleType>> outputs(static_cast<size_t>(numChannels),
+                                                     std::vector<SampleType>(input.begin(), input.end()));
+
+        BiquadCascade<SampleType> cascade;
+        cascade.prepare(numChannels, static_cast<int>(input.size()), NumCascadeSlots, isa);
+        applyCascadeDesign(cascade, makeCascadeDesign<SampleType>(settings, testSampleRate));
+
+        std::vector<SampleType*> channels;
+        for (auto& output : outputs)
+            channels.push_back(output.data());
+
+        cascade.process(juce::dsp::AudioBlock<SampleType>(channels.data(), channels.size(), input.size()));
+
+        return outputs;
+    }
+
+    // Renders the input on one channel of a time-blocked cascade
+    template <typename SampleType>
+    std::vector<SampleType> renderBlocked(const ChainSettings& settings, const std::vector<float>& input, KernelIsa isa)
+    {
+        std::vector<SampleType> output(input.begin(), input.end());
+        SampleType* channels[] = { output.data() };
+
+        BiquadCascade<SampleType> cascade;
+        cascade.prepare(1, static_cast<int>(input.size()), NumCascadeSlots, KernelIsa::scalar, isa);
+        cascade.setTimeBlocked(true);
+        applyCascadeDesign(cascade, makeCascadeDesign<SampleType>(settings, testSampleRate));
+        cascade.process(juce::dsp::AudioBlock<SampleType>(channels, 1, output.size()));
+
+        return output;
+    }
+
+    // Renders the input through the parallel form of the double design, or
+    // returns nothing when the design has no valid expansion
+    std::vector<double> renderParallel(const ChainSettings& settings, const std::vector<float>& input, KernelIsa isa)
+    {
+        const auto design = makeCascadeDesign<double>(settings, testSampleRate);
+
+        std::array<BiquadSection<double>, NumCascadeSlots> sections;
+        std::array<int, NumCascadeSlots> ids;
+        int numSections = 0;
+
+        for (size_t slot = 0; slot < design.sections.size(); ++slot)
+        {
+            if (design.active[slot])
+            {
+                sections[static_cast<size_t>(numSections)] = design.sections[slot];
+                ids[static_cast<size_t>(numSections++)] = static_cast<int>(slot);
+            }
+        }
+
+        const auto expansion = expandCascade(sections.data(), ids.data(), numSections);
+
+        if (! expansion.valid)
+            return {};
+
+        std::vector<double> output(input.begin(), input.end());
+        double* channels[] = { output.data() };
+
+        ParallelCascade parallel;
+        parallel.prepare(1, static_cast<int>(input.size()), isa);
+        parallel.setExpansion(0, expansion);
+        parallel.process(juce::dsp::AudioBlock<double>(channels, 1, output.size()));
+
+        return output;
+    }
+
+    //==============================================================================
+    template <typename SampleType>
+    double getMaxError(const std::vector<SampleType>& output, const std::vector<double>& reference)
+    {
+        auto error = 0.0;
+
+        for (size_t n = 0; n < output.size(); ++n)
+            error = juce::jmax(error, std::abs(static_cast<double>(output[n]) - reference[n]));
+
+        return error;
+    }
+
+    template <typename SampleType>
+    bool isWithin(const std::vector<SampleType>& output, const std::vector<SampleType>& reference, double tolerance)
+    {
+        for (size_t n = 0; n < output.size(); ++n)
+            if (std::abs(static_cast<double>(output[n] - reference[n])) > tolerance)
+                return false;
+
+        return true;
+    }
+
+    // Same bits, so a NaN in both still matches and signed zeros do not
+    bool isBitExact(const std::vector<float>& output, const std::vector<float>& reference)
+    {
+        return output.size() == reference.size()
+            && std::memcmp(output.data(), reference.data(), output.size() * sizeof(float)) == 0;
+    }
+
+    bool isSameDesign(const CascadeDesign<float>& design, const CascadeDesign<float>& stored)
+    {
+        for (size_t slot = 0; slot < design.sections.size(); ++slot)
+        {
+            if (design.active[slot] != stored.active[slot])
+                return false;
+
+            if (! design.active[slot])
+                continue;
+
+            const auto& a = design.sections[slot];
+            const auto& b = stored.sections[slot];
+
+            auto differs = [](float x, float y) { return std::abs(x - y) > designTolerance * juce::jmax(1.f, std::abs(y)); };
+
+            if (differs(a.b0, b.b0) || differs(a.b1, b.b1) || differs(a.b2, b.b2) || differs(a.a1, b.a1) || differs(a.a2, b.a2))
+                return false;
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    double getExpectedMagnitude(const ChainSettings& settings, float freq)
+    {
+        auto magnitude = makePeakFilter(settings, testSampleRate)->getMagnitudeForFrequency(freq, testSampleRate);
+
+        auto lowCut = makeLowCutFilter(settings, testSampleRate);
+        auto highCut = makeHighCutFilter(settings, testSampleRate);
+
+        for (int i = 0; i <= settings.lowCutSlope; ++i)
+            magnitude *= lowCut[i]->getMagnitudeForFrequency(freq, testSampleRate);
+
+        for (int i = 0; i <= settings.highCutSlope; ++i)
+            magnitude *= highCut[i]->getMagnitudeForFrequency(freq, testSampleRate);
+
+        return magnitude;
+    }
+
+    // Single-bin DFT of a rendered impulse response
+    double getRenderedMagnitude(const std::vector<float>& impulseResponse, float freq)
+    {
+        const auto w = juce::MathConstants<double>::twoPi * freq / testSampleRate;
+        const auto rotation = std::polar(1.0, -w);
+
+        std::complex<double> phasor(1.0, 0.0), sum(0.0, 0.0);
+
+        for (auto sample : impulseResponse)
+        {
+            sum += static_cast<double>(sample) * phasor;
+            phasor *= rotation;
+        }
+
+        return std::abs(sum);
+    }
+
+    float toDb(double gain) { return juce::Decibels::gainToDecibels(static_cast<float>(gain), -200.f); }
+
+    juce::String describe(const ChainSettings& settings)
+    {
+        return "peak " + juce::String(settings.peakFreq) + " Hz / " + juce::String(settings.peakGainInDecibels)
+             + " dB, slope " + juce::String(static_cast<int>(settings.lowCutSlope));
+    }
+}
+
+//==============================================================================
+class FilterKernelTests : public juce::UnitTest
+{
+public:
+    FilterKernelTests() : juce::UnitTest("Filter kernels", "OloEQ") {}
+
+    void runTest() override
+    {
+        const auto grid = makeKernelTestGrid();
+
+        KernelGoldenData golden;
+        const auto goldenRead = golden.read(BinaryData::FilterKernels_golden,
+                                             static_cast<size_t>(BinaryData::FilterKernels_goldenSize));
+
+        beginTest("Scalar kernel against the golden outputs");
+        expect(goldenRead, "Golden file is missing or malformed");
+        expectEquals(static_cast<int>(golden.entries.size()), static_cast<int>(grid.size()), "Golden file is for another grid");
+
+        if (goldenRead && golden.entries.size() == grid.size())
+        {
+            for (size_t i = 0; i < grid.size(); ++i)
+            {
+                const auto& entry = golden.entries[i];
+
+                expect(isSameDesign(makeCascadeDesign<float>(grid[i], testSampleRate), entry.design),
+                       "Design moved from the stored coefficients at " + describe(grid[i]));
+
+                for (size_t s = 0; s < golden.signals.size(); ++s)
+                    expect(isBitExact(renderScalarKernel(entry.design, golden.signals[s]), entry.outputs[s]),
+                           "Scalar output moved at " + describe(grid[i]) + ", signal " + juce::String(static_cast<int>(s)));
+            }
+        }
+
+        // The golden signals, with the impulse long enough for the
+        // magnitude checks
+        auto signals = golden.signals;
+
+        if (signals.empty())
+            signals.resize(1);
+
+        signals[0].assign(static_cast<size_t>(impulseLength), 0.f);
+        signals[0][0] = 1.f;
+
+        beginTest("Scalar kernel against MonoChain");
+
+        for (const auto& settings : grid)
+        {
+            const auto design = makeCascadeDesign<float>(settings, testSampleRate);
+
+            // Exact match, signed zeros aside
+            for (const auto& signal : signals)
+            {
+                const auto scalar = renderScalarKernel(design, signal);
+                const auto reference = renderMonoChain(design, signal);
+
+                expect(std::equal(reference.begin(), reference.end(), scalar.begin()),
+                       "Scalar kernel differs from MonoChain at " + describe(settings));
+            }
+        }
+
+        beginTest("SIMD kernels against the scalar kernel");
+
+        for (const auto& settings : grid)
+        {
+            for (const auto& signal : signals)
+            {
+                const auto scalar = renderKernel<float>(settings, signal, KernelIsa::scalar).front();
+                const auto scalarDouble = renderKernel<double>(settings, signal, KernelIsa::scalar).front();
+                const auto tolerance = getTolerance(scalar);
+
+                for (auto isa : simdIsas)
+                {
+                    if (! isKernelIsaSupported(isa))
+                        continue;
+
+                    for (const auto& lane : renderKernel<float>(settings, signal, isa))
+                        expect(isWithin(lane, scalar, tolerance), juce::String(getKernelIsaName(isa)) + " at " + describe(settings));
+
+                    for (const auto& lane : renderKernel<double>(settings, signal, isa))
+                        expect(isWithin(lane, scalarDouble, tolerance),
+                               juce::String(getKernelIsaName(isa)) + ", double, at " + describe(settings));
+                }
+            }
+        }
+
+        beginTest("Time-blocked kernels");
+
+        for (const auto& settings : grid)
+        {
+            for (const auto& signal : signals)
+            {
+                const auto scalar = renderKernel<float>(settings, signal, KernelIsa::scalar).front();
+                const auto scalarDouble = renderKernel<double>(settings, signal, KernelIsa::scalar).front();
+                const auto tolerance = getTolerance(scalar);
+
+                // The blocked kernel sums in another order, so in float it is
+                // held to the scalar kernel's own error against double rather
+                // than to its exact output
+                const auto scalarError = getMaxError(scalar, scalarDouble);
+
+                for (auto isa : allIsas)
+                {
+                    if (! isKernelIsaSupported(isa))
+                        continue;
+
+                    expect(getMaxError(renderBlocked<float>(settings, signal, isa), scalarDouble) <= 2.0 * scalarError + tolerance,
+                           juce::String("Blocked ") + getKernelIsaName(isa) + " at " + describe(settings));
+
+                    expect(getMaxError(renderBlocked<double>(settings, signal, isa), scalarDouble) <= tolerance,
+                           juce::String("Blocked ") + getKernelIsaName(isa) + ", double, at " + describe(settings));
+                }
+            }
+        }
+
+        beginTest("Parallel form against the serial cascade");
+
+        for (const auto& settings : grid)
+        {
+            for (const auto& signal : signals)
+            {
+                const auto scalar = renderKernel<float>(settings, signal, KernelIsa::scalar).front();
+                const auto scalarDouble = renderKernel<double>(settings, signal, KernelIsa::scalar).front();
+
+                for (auto isa : allIsas)
+                    if (isKernelIsaSupported(isa))
+                        expect(isWithin(renderParallel(settings, signal, isa), scalarDouble, getTolerance(scalar)),
+                               juce::String("Parallel form ") + getKernelIsaName(isa) + " at " + describe(settings));
+            }
+        }
+
+        beginTest("Rendered magnitude");
+
+        for (const auto& settings : grid)
+        {
+            const auto impulseResponse = renderScalarKernel(makeCascadeDesign<float>(settings, testSampleRate), signals[0]);
+
+            for (auto freq : testFrequencies)
+            {
+                const auto expectedDb = toDb(getExpectedMagnitude(settings, freq));
+
+                if (expectedDb > magnitudeFloorDb)
+                    expectWithinAbsoluteError(toDb(getRenderedMagnitude(impulseResponse, freq)), expectedDb, magnitudeToleranceDb,
+                                              "at " + juce::String(freq) + " Hz, " + describe(settings));
+            }
+        }
+
+        beginTest("Response curve kernels");
+
+        for (const auto& settings : grid)
+            checkResponseCurve(settings);
+    }
+
+private:
+    static double getTolerance(const std::vector<float>& reference)
+    {
+        auto peak = 0.f;
+
+        for (auto sample : reference)
+            peak = juce::jmax(peak, std::abs(sample));
+
+        return peak * juce::Decibels::decibelsToGain(simdToleranceDb);
+    }
+
+    void checkResponseCurve(const ChainSettings& settings)
+    {
+        const auto design = makeCascadeDesign<float>(settings, testSampleRate);
+
+        std::vector<BiquadSection<float>> sections;
+        for (size_t slot = 0; slot < design.sections.size(); ++slot)
+            if (design.active[slot])
+                sections.push_back(design.sections[slot]);
+
+        std::vector<float> phi, magnitudes(std::size(testFrequencies));
+        for (auto freq : testFrequencies)
+        {
+            const auto sine = std::sin(juce::MathConstants<double>::pi * freq / testSampleRate);
+            phi.push_back(static_cast<float>(sine * sine));
+        }
+
+        for (auto isa : allIsas)
+        {
+            if (! isKernelIsaSupported(isa))
+                continue;
+
+            getFilterKernels<float>(isa).evaluateMagnitude(sections.data(), static_cast<int>(sections.size()),
+                                                           phi.data(), magnitudes.data(), static_cast<int>(phi.size()));
+
+            for (size_t i = 0; i < phi.size(); ++i)
+            {
+                const auto expectedDb = toDb(getExpectedMagnitude(settings, testFrequencies[i]));
+
+                if (expectedDb > magnitudeFloorDb)
+                    expectWithinAbsoluteError(toDb(magnitudes[i]), expectedDb, curveToleranceDb,
+                                              juce::String(getKernelIsaName(isa)) + " at " + juce::String(testFrequencies[i])
+                                                  + " Hz, " + describe(settings));
+            }
+        }
+    }
+};
+
+static FilterKernelTests filterKernelTests;
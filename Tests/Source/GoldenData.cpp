@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    GoldenData.cpp
+    Implements the settings grid, the scalar render and the golden file
+    format.
+
+  ==============================================================================
+*/
+
+#include "GoldenData.h"
+
+namespace
+{
+    constexpr int goldenMagic = 'O' | ('L' << 8) | ('G' << 16) | ('K' << 24);
+
+    std::vector<std::vector<float>> makeSignals()
+    {
+        constexpr auto length = KernelGoldenData::signalLength;
+        std::vector<std::vector<float>> signals(3, std::vector<float>(static_cast<size_t>(length), 0.f));
+
+        // Impulse
+        signals[0][0] = 1.f;
+
+        // Exponential sweep, 20 Hz to 20 kHz
+        const auto rate = std::log(20000.0 / 20.0) / length;
+        auto phase = 0.0;
+
+        for (int n = 0; n < length; ++n)
+        {
+            signals[1][static_cast<size_t>(n)] = static_cast<float>(0.5 * std::sin(phase));
+            phase += juce::MathConstants<double>::twoPi * 20.0 * std::exp(rate * n) / KernelGoldenData::sampleRate;
+        }
+
+        // Fixed-seed white noise
+        juce::Random random(0x01E0);
+
+        for (auto& sample : signals[2])
+            sample = random.nextFloat() * 2.f - 1.f;
+
+        return signals;
+    }
+}
+
+//==============================================================================
+std::vector<ChainSettings> makeKernelTestGrid()
+{
+    std::vector<ChainSettings> grid;
+
+    for (auto slope : { Slope_12, Slope_24, Slope_36, Slope_48 })
+        for (auto freq : { 40.f, 400.f, 4000.f, 16000.f })
+            for (auto gain : { -24.f, 0.f, 24.f })
+            {
+                ChainSettings settings;
+                settings.peakFreq = freq;
+                settings.peakGainInDecibels = gain;
+                settings.peakQuality = gain < 0.f ? 0.5f : 5.f;
+                settings.lowCutFreq = juce::jmax(20.f, freq / 4.f);
+                settings.highCutFreq = juce::jmin(20000.f, freq * 4.f);
+                settings.lowCutSlope = slope;
+                settings.highCutSlope = slope;
+                grid.push_back(settings);
+            }
+
+    return grid;
+}
+
+template <typename SampleType>
+std::vector<SampleType> renderScalarKernel(const CascadeDesign<SampleType>& design, const std::vector<float>& input)
+{
+    std::vector<SampleType> output(input.begin(), input.end());
+    SampleType* channels[] = { output.data() };
+
+    BiquadCascade<SampleType> cascade;
+    cascade.prepare(1, static_cast<int>(input.size()), NumCascadeSlots, KernelIsa::scalar);
+    applyCascadeDesign(cascade, design);
+    cascade.process(juce::dsp::AudioBlock<SampleType>(channels, 1, output.size()));
+
+    return output;
+}
+
+template std::vector<float> renderScalarKernel<float>(const CascadeDesign<float>&, const std::vector<float>&);
+template std::vector<double> renderScalarKernel<double>(const CascadeDesign<double>&, const std::vector<float>&);
+
+//==============================================================================
+KernelGoldenData KernelGoldenData::render()
+{
+    KernelGoldenData golden;
+    golden.signals = makeSignals();
+
+    for (const auto& settings : makeKernelTestGrid())
+    {
+        Entry entry;
+        entry.design = makeCascadeDesign<float>(settings, sampleRate);
+
+        for (const auto& signal : golden.signals)
+            entry.outputs.push_back(renderScalarKernel(entry.design, signal));
+
+        golden.entries.push_back(std::move(entry));
+    }
+
+    return golden;
+}
+
+void KernelGoldenData::write(juce::OutputStream& stream) const
+{
+    stream.writeInt(goldenMagic);
+    stream.writeInt(formatVersion);
+    stream.writeInt(static_cast<int>(entries.size()));
+    stream.writeInt(static_cast<int>(signals.size()));
+    stream.writeInt(signalLength);
+    stream.writeInt(NumCascadeSlots);
+
+    auto writeFloats = [&stream](const std::vector<float>& values)
+    {
+        for (auto value : values)
+            stream.writeFloat(value);
+    };
+
+    for (const auto& signal : signals)
+        writeFloats(signal);
+
+    for (const auto& entry : entries)
+    {
+        int mask = 0;
+
+        for (int slot = 0; slot < NumCascadeSlots; ++slot)
+            if (entry.design.active[static_cast<size_t>(slot)])
+                mask |= 1 << slot;
+
+        stream.writeInt(mask);
+
+        for (const auto& section : entry.design.sections)
+            for (auto coefficient : { section.b0, section.b1, section.b2, section.a1, section.a2 })
+                stream.writeFloat(coefficient);
+
+        for (const auto& output : entry.outputs)
+            writeFloats(output);
+    }
+}
+
+bool KernelGoldenData::read(const void* data, size_t sizeInBytes)
+{
+    juce::MemoryInputStream stream(data, sizeInBytes, false);
+
+    if (stream.readInt() != goldenMagic || stream.readInt() != formatVersion)
+        return false;
+
+    const auto numEntries = stream.readInt();
+    const auto numSignals = stream.readInt();
+
+    if (stream.readInt() != signalLength || stream.readInt() != NumCascadeSlots || numEntries < 0 || numSignals < 0)
+        return false;
+
+    const auto expectedSize = 24 + 4 * (static_cast<juce::int64>(numSignals) * signalLength
+                                        + static_cast<juce::int64>(numEntries) * (1 + NumCascadeSlots * 5 + numSignals * signalLength));
+
+    if (static_cast<juce::int64>(sizeInBytes) != expectedSize)
+        return false;
+
+    auto readFloats = [&stream]
+    {
+        std::vector<float> values(static_cast<size_t>(signalLength));
+
+        for (auto& value : values)
+            value = stream.readFloat();
+
+        return values;
+    };
+
+    signals.clear();
+    entries.clear();
+
+    for (int i = 0; i < numSignals; ++i)
+        signals.push_back(readFloats());
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        Entry entry;
+        const auto mask = stream.readInt();
+
+        for (int slot = 0; slot < NumCascadeSlots; ++slot)
+        {
+            auto& section = entry.design.sections[static_cast<size_t>(slot)];
+            entry.design.active[static_cast<size_t>(slot)] = (mask & (1 << slot)) != 0;
+
+            section.b0 = stream.readFloat();
+            section.b1 = stream.readFloat();
+            section.b2 = stream.readFloat();
+            section.a1 = stream.readFloat();
+            section.a2 = stream.readFloat();
+        }
+
+        for (int s = 0; s < numSignals; ++s)
+            entry.outputs.push_back(readFloats());
+
+        entries.push_back(std::move(entry));
+    }
+
+    return true;
+}
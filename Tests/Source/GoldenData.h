@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    GoldenData.h
+    Stored outputs of the scalar cascade kernel, which the kernel tests hold
+    it to bit for bit. Each entry is one point of the settings grid: its
+    float cascade design and the scalar kernel's output for every test
+    signal. The signals and coefficients are stored along with the outputs,
+    so the outputs only move when the kernel does, not with the math
+    library, juce::Random or the designers.
+
+    Layout, all little endian:
+
+        uint32  magic ("OLGK"), format version, number of entries, number
+                of signals, signal length, number of slots
+        float   the signals (impulse, sweep, noise)
+        entries uint32 mask of the active slots, float coefficients of
+                every slot (b0, b1, b2, a1, a2), float output per signal
+
+    Regenerate with "OloEQTests --update-golden=Tests/Data" after a change
+    that is meant to alter the scalar output, and say so in the commit.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+// Slopes, peak frequencies and gains, with cut frequencies either side of
+// the peak, in the order the golden entries are stored
+std::vector<ChainSettings> makeKernelTestGrid();
+
+// Runs the input through a single channel scalar cascade with the design
+template <typename SampleType>
+std::vector<SampleType> renderScalarKernel(const CascadeDesign<SampleType>& design, const std::vector<float>& input);
+
+//==============================================================================
+struct KernelGoldenData
+{
+    static constexpr int formatVersion = 1;
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int signalLength = 4096;
+
+    struct Entry
+    {
+        CascadeDesign<float> design;
+        std::vector<std::vector<float>> outputs;   // one per signal
+    };
+
+    std::vector<std::vector<float>> signals;
+    std::vector<Entry> entries;
+
+    // Designs every grid point and renders the signals through the scalar
+    // kernel, which is what the golden file holds
+    static KernelGoldenData render();
+
+    void write(juce::OutputStream& stream) const;
+
+    // Returns false if the data is not a golden file of this version
+    bool read(const void* data, size_t sizeInBytes);
+};
@@ -0,0 +1,18 @@
+/*
+  ==============================================================================
+
+    JucePluginDefines.h
+    The plugin wrapper generates this header for the plugin build. The test
+    app builds the plugin's sources without the wrapper, so it defines the
+    values the processor reads itself.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#define JucePlugin_Name                 "OloEQ"
+#define JucePlugin_IsSynth              0
+#define JucePlugin_WantsMidiInput       0
+#define JucePlugin_ProducesMidiOutput   0
+#define JucePlugin_IsMidiEffect         0
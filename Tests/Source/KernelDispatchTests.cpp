@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    KernelDispatchTests.cpp
+    Runs the whole processor with each supported kernel ISA forced through
+    setForcedKernelIsa and checks that it dispatches to that ISA and stays
+    within -80 dB of the processor forced to the scalar kernels, in both
+    precisions, with time blocking off and on. Also checks that wide buses
+    are split into channel groups on the cascade's alignment, which is a
+    cache line: 16 float or 8 double channels.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    constexpr double testSampleRate = 48000.0;
+    constexpr int testBlockSize = 512;
+    constexpr int numTestBlocks = 16;
+
+    constexpr float toleranceDb = -80.f;
+
+    const KernelIsa allIsas[] = { KernelIsa::scalar, KernelIsa::sse2, KernelIsa::avx2, KernelIsa::avx512, KernelIsa::neon };
+
+    void setParameter(OloEQAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Renders fixed-seed noise through a processor forced to the ISA, with
+    // all three bands engaged. Returns the active ISA alongside the output.
+    std::pair<KernelIsa, juce::AudioBuffer<float>> renderProcessor(KernelIsa isa, int precision, bool timeBlocked)
+    {
+        OloEQAudioProcessor processor;
+
+        setParameter(processor, getParameterId("LowCut Freq", ParameterSet_A), 80.f);
+        setParameter(processor, getParameterId("LowCut Slope", ParameterSet_A), static_cast<float>(Slope_48));
+        setParameter(processor, getParameterId("HighCut Freq", ParameterSet_A), 9000.f);
+        setParameter(processor, getParameterId("HighCut Slope", ParameterSet_A), static_cast<float>(Slope_24));
+        setParameter(processor, getParameterId("Peak Freq", ParameterSet_A), 1200.f);
+        setParameter(processor, getParameterId("Peak Gain", ParameterSet_A), 9.f);
+        setParameter(processor, getParameterId("Peak Quality", ParameterSet_A), 2.f);
+        setParameter(processor, "Precision", static_cast<float>(precision));
+        setParameter(processor, "Time Blocking", timeBlocked ? 1.f : 0.f);
+
+        processor.setForcedKernelIsa(isa);
+        processor.prepareToPlay(testSampleRate, testBlockSize);
+
+        const auto numChannels = processor.getTotalNumOutputChannels();
+        juce::AudioBuffer<float> output(numChannels, testBlockSize * numTestBlocks);
+        juce::AudioBuffer<float> block(numChannels, testBlockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(0x0D15);
+
+        for (int b = 0; b < numTestBlocks; ++b)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int n = 0; n < testBlockSize; ++n)
+                    block.setSample(channel, n, random.nextFloat() * 2.f - 1.f);
+
+            processor.processBlock(block, midi);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                output.copyFrom(channel, b * testBlockSize, block, channel, 0, testBlockSize);
+        }
+
+        processor.releaseResources();
+
+        return { processor.getActiveKernelIsa(), std::move(output) };
+    }
+
+    float getMaxErrorDb(const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& reference)
+    {
+        auto error = 0.f;
+
+        for (int channel = 0; channel < reference.getNumChannels(); ++channel)
+            for (int n = 0; n < reference.getNumSamples(); ++n)
+                error = juce::jmax(error, std::abs(output.getSample(channel, n) - reference.getSample(channel, n)));
+
+        const auto peak = reference.getMagnitude(0, reference.getNumSamples());
+
+        return juce::Decibels::gainToDecibels(error / juce::jmax(peak, 1.0e-6f), -200.f);
+    }
+}
+
+//==============================================================================
+class KernelDispatchTests : public juce::UnitTest
+{
+public:
+    KernelDispatchTests() : juce::UnitTest("Kernel dispatch", "OloEQ") {}
+
+    void runTest() override
+    {
+        for (int precision : { 0, 1 })
+        {
+            for (bool timeBlocked : { false, true })
+            {
+                const auto context = juce::String(precision == 0 ? "float" : "double")
+                                   + (timeBlocked ? ", time blocked" : "");
+
+                beginTest("Forced ISAs against the scalar kernels, " + context);
+
+                const auto scalar = renderProcessor(KernelIsa::scalar, precision, timeBlocked);
+                expect(scalar.first == KernelIsa::scalar, "Forcing the scalar kernels did not take");
+
+                for (auto isa : allIsas)
+                {
+                    if (isa == KernelIsa::scalar || ! isKernelIsaSupported(isa))
+                        continue;
+
+                    const auto forced = renderProcessor(isa, precision, timeBlocked);
+                    const juce::String name(getKernelIsaName(isa));
+
+                    expect(forced.first == isa, name + " was forced but not used");
+                    expect(getMaxErrorDb(forced.second, scalar.second) <= toleranceDb,
+                           name + " is more than " + juce::String(toleranceDb) + " dB from the scalar kernels, " + context);
+                }
+            }
+        }
+
+        beginTest("Unsupported ISAs fall back");
+
+        for (auto isa : allIsas)
+            if (! isKernelIsaSupported(isa))
+                expect(renderProcessor(isa, 0, false).first != isa,
+                       juce::String(getKernelIsaName(isa)) + " is not supported but was used");
+
+        beginTest("Channel groups start on the cascade's alignment");
+
+        for (auto isa : allIsas)
+        {
+            if (! isKernelIsaSupported(isa))
+                continue;
+
+            for (auto numChannels : { 16, 32, 64 })
+            {
+                OloEQAudioProcessor processor;
+
+                juce::AudioProcessor::BusesLayout layout;
+                layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+                layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+                expect(processor.setBusesLayout(layout), "The layout was refused");
+
+                processor.setForcedKernelIsa(isa);
+                processor.prepareToPlay(testSampleRate, testBlockSize);
+
+                const auto numCpus = juce::SystemStats::getNumCpus();
+                const auto context = juce::String(numChannels) + " channels, " + getKernelIsaName(isa);
+
+                expectEquals(processor.getNumChannelGroups(Precision_Float), juce::jlimit(1, numCpus, numChannels / 16),
+                             "Float groups, " + context);
+                expectEquals(processor.getNumChannelGroups(Precision_Double), juce::jlimit(1, numCpus, numChannels / 8),
+                             "Double groups, " + context);
+
+                processor.releaseResources();
+            }
+        }
+    }
+};
+
+static KernelDispatchTests kernelDispatchTests;
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    LatencyTests.cpp
+    Checks that the latency the processor reports is the one its output
+    has. An impulse through the linear phase mode, whose flat kernel peaks
+    on its middle tap, has to come out exactly the reported latency later,
+    also when a host switches to offline rendering with Render Quality on
+    without preparing again, and after FIR Length changes mid-stream.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    constexpr double testSampleRate = 48000.0;
+    constexpr int testBlockSize = 512;
+    constexpr int numTestBlocks = 48;   // past the longest render kernel's latency
+
+    void setParameter(OloEQAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Runs an impulse on every channel through the processor and returns
+    // where the output of the first channel peaks. The default cuts take a
+    // little off the top and bottom, but leave the peak on the middle tap.
+    int findImpulse(OloEQAudioProcessor& processor, float& peak)
+    {
+        juce::AudioBuffer<float> buffer(processor.getTotalNumOutputChannels(), testBlockSize * numTestBlocks);
+        juce::MidiBuffer midi;
+
+        buffer.clear();
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            buffer.setSample(channel, 0, 1.f);
+
+        for (int b = 0; b < numTestBlocks; ++b)
+        {
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                           b * testBlockSize, testBlockSize);
+            processor.processBlock(block, midi);
+        }
+
+        const auto* samples = buffer.getReadPointer(0);
+        const auto* largest = std::max_element(samples, samples + buffer.getNumSamples(),
+                                               [](float x, float y) { return std::abs(x) < std::abs(y); });
+
+        peak = std::abs(*largest);
+        return static_cast<int>(std::distance(samples, largest));
+    }
+
+    // Runs noise through the processor, so there is history to clear
+    void runNoise(OloEQAudioProcessor& processor, int numBlocks)
+    {
+        juce::AudioBuffer<float> block(processor.getTotalNumOutputChannels(), testBlockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(0x1A7E);
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int channel = 0; channel < block.getNumChannels(); ++channel)
+                for (int n = 0; n < testBlockSize; ++n)
+                    block.setSample(channel, n, random.nextFloat() * 2.f - 1.f);
+
+            processor.processBlock(block, midi);
+        }
+    }
+}
+
+//==============================================================================
+class LatencyTests : public juce::UnitTest
+{
+public:
+    LatencyTests() : juce::UnitTest("Reported latency", "OloEQ") {}
+
+    void runTest() override
+    {
+        for (auto renderQuality : { false, true })
+        {
+            beginTest(juce::String("Offline render without preparing again, Render Quality ") + (renderQuality ? "on" : "off"));
+
+            OloEQAudioProcessor processor;
+            setParameter(processor, "Processing Mode", static_cast<float>(Mode_LinearPhase));
+            setParameter(processor, "Render Quality", renderQuality ? 1.f : 0.f);
+
+            processor.prepareToPlay(testSampleRate, testBlockSize);
+            processor.setNonRealtime(true);
+
+            auto peak = 0.f;
+            const auto position = findImpulse(processor, peak);
+
+            expectEquals(position, processor.getLatencySamples(), "The impulse is not at the reported latency");
+            expectGreaterThan(peak, 0.5f, "The impulse did not come through");
+
+            processor.releaseResources();
+        }
+
+        beginTest("FIR Length change restarts on the new latency");
+        {
+            OloEQAudioProcessor processor;
+            setParameter(processor, "Processing Mode", static_cast<float>(Mode_LinearPhase));
+            setParameter(processor, "FIR Length", 1.f);
+
+            processor.prepareToPlay(testSampleRate, testBlockSize);
+            processor.setNonRealtime(true);
+            runNoise(processor, 8);
+
+            // The message thread is not running here, so the latency is
+            // taken from the kernel rather than from the host report
+            setParameter(processor, "FIR Length", 0.f);
+
+            auto peak = 0.f;
+            const auto position = findImpulse(processor, peak);
+
+            expectEquals(position, FirEngine::getLatency(FirEngine::minLength, FirPhase::linear),
+                         "The impulse is not at the new kernel's latency");
+            expectGreaterThan(peak, 0.5f, "The impulse did not come through");
+
+            processor.releaseResources();
+        }
+    }
+};
+
+static LatencyTests latencyTests;
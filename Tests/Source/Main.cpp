@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Console runner for the OloEQ tests, built from the plugin's sources by
+    OloEQTests.jucer.
+
+        OloEQTests                          runs every test, exits with 1 if
+                                            any of them failed
+        OloEQTests --update-golden=<dir>    rewrites the golden files in dir
+        OloEQTests --benchmarks             runs the benchmarks and prints
+                                            their figures
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "GoldenData.h"
+#include "Benchmarks.h"
+
+namespace
+{
+    int updateGoldenFiles(const juce::String& path)
+    {
+        const auto folder = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+
+        if (! folder.isDirectory())
+        {
+            std::cerr << "No such folder: " << folder.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        juce::MemoryOutputStream stream;
+        KernelGoldenData::render().write(stream);
+
+        const auto file = folder.getChildFile("FilterKernels.golden");
+
+        if (! file.replaceWithData(stream.getData(), stream.getDataSize()))
+        {
+            std::cerr << "Could not write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << "Wrote " << file.getFullPathName() << std::endl;
+        return 0;
+    }
+
+    int runTests()
+    {
+        juce::UnitTestRunner runner;
+        runner.setAssertOnFailure(false);
+        runner.runTestsInCategory("OloEQ");
+
+        auto failures = 0;
+
+        for (int i = 0; i < runner.getNumResults(); ++i)
+            failures += runner.getResult(i)->failures;
+
+        return failures > 0 ? 1 : 0;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // The processor tests need a message manager, though nothing runs its loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--update-golden"))
+        return updateGoldenFiles(args.getValueForOption("--update-golden"));
+
+    if (args.containsOption("--benchmarks"))
+        return runBenchmarks();
+
+    return runTests();
+}
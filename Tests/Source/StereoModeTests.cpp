@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    StereoModeTests.cpp
+    Runs the linear and minimum phase modes in the stereo modes that use
+    both paths. With the same settings on both sets, Mid/Side has to match
+    Stereo, and Left Only has to delay the right channel by the reported
+    latency and nothing else.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    constexpr double testSampleRate = 48000.0;
+    constexpr int testBlockSize = 512;
+    constexpr int numTestBlocks = 16;
+
+    constexpr float toleranceDb = -80.f;
+
+    void setParameter(OloEQAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Renders the same fixed-seed noise as the input buffer through a
+    // processor in the mode, with both sets on the same settings
+    juce::AudioBuffer<float> renderProcessor(ProcessingMode mode, StereoMode stereoMode,
+                                             const juce::AudioBuffer<float>& input, int& latency)
+    {
+        OloEQAudioProcessor processor;
+
+        for (auto set : { ParameterSet_A, ParameterSet_B })
+        {
+            setParameter(processor, getParameterId("LowCut Freq", set), 120.f);
+            setParameter(processor, getParameterId("LowCut Slope", set), static_cast<float>(Slope_24));
+            setParameter(processor, getParameterId("Peak Freq", set), 2500.f);
+            setParameter(processor, getParameterId("Peak Gain", set), 12.f);
+            setParameter(processor, getParameterId("Peak Quality", set), 1.5f);
+        }
+
+        setParameter(processor, "Processing Mode", static_cast<float>(mode));
+        setParameter(processor, "Stereo Mode", static_cast<float>(stereoMode));
+
+        // Wait for the convolver's tail blocks rather than drop late ones
+        processor.setNonRealtime(true);
+        processor.prepareToPlay(testSampleRate, testBlockSize);
+
+        juce::AudioBuffer<float> output(input);
+        juce::MidiBuffer midi;
+
+        for (int b = 0; b < numTestBlocks; ++b)
+        {
+            juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), output.getNumChannels(),
+                                           b * testBlockSize, testBlockSize);
+            processor.processBlock(block, midi);
+        }
+
+        latency = processor.getLatencySamples();
+        processor.releaseResources();
+
+        return output;
+    }
+
+    juce::AudioBuffer<float> makeNoise(int numChannels)
+    {
+        juce::AudioBuffer<float> noise(numChannels, testBlockSize * numTestBlocks);
+        juce::Random random(0x5732);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < noise.getNumSamples(); ++n)
+                noise.setSample(channel, n, random.nextFloat() * 2.f - 1.f);
+
+        return noise;
+    }
+
+    // Largest difference of a channel from the reference channel shifted
+    // later by delay samples, relative to the reference's peak
+    float getMaxErrorDb(const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& reference,
+                        int channel, int delay)
+    {
+        auto error = 0.f;
+
+        for (int n = delay; n < output.getNumSamples(); ++n)
+            error = juce::jmax(error, std::abs(output.getSample(channel, n) - reference.getSample(channel, n - delay)));
+
+        const auto peak = reference.getMagnitude(channel, 0, reference.getNumSamples());
+
+        return juce::Decibels::gainToDecibels(error / juce::jmax(peak, 1.0e-6f), -200.f);
+    }
+}
+
+//==============================================================================
+class StereoModeTests : public juce::UnitTest
+{
+public:
+    StereoModeTests() : juce::UnitTest("FIR stereo modes", "OloEQ") {}
+
+    void runTest() override
+    {
+        const auto input = makeNoise(2);
+
+        for (auto mode : { Mode_LinearPhase, Mode_MinimumPhase })
+        {
+            const juce::String name(mode == Mode_LinearPhase ? "linear phase" : "minimum phase");
+            int latency = 0;
+
+            beginTest("Mid/Side with equal sets matches Stereo, " + name);
+
+            const auto stereo = renderProcessor(mode, StereoMode_Stereo, input, latency);
+            const auto midSide = renderProcessor(mode, StereoMode_MidSide, input, latency);
+
+            for (int channel = 0; channel < 2; ++channel)
+                expect(getMaxErrorDb(midSide, stereo, channel, 0) <= toleranceDb,
+                       "Mid/Side differs from Stereo on channel " + juce::String(channel));
+
+            beginTest("Left Only delays the right channel by the latency, " + name);
+
+            const auto leftOnly = renderProcessor(mode, StereoMode_LeftOnly, input, latency);
+
+            expect(latency > 0, "No latency reported");
+            expect(getMaxErrorDb(leftOnly, input, 1, latency) <= toleranceDb,
+                   "The right channel is not the delayed input");
+            expect(getMaxErrorDb(leftOnly, stereo, 0, 0) <= toleranceDb,
+                   "The left channel is not filtered as in Stereo");
+        }
+    }
+};
+
+static StereoModeTests stereoModeTests;